@@ -0,0 +1,190 @@
+// Parser microbenchmark: packets/sec of the previous string-building parser versus the
+// allocation-free layer map parser, both run over the same synthetic frames.
+#include "core/PacketParser.h"
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#endif
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace
+{
+	// Previous PacketInfo layout, with every field stored as a string
+	struct LegacyPacket
+	{
+		std::vector<uint8_t> data;
+		std::string etherSrc;
+		std::string etherDst;
+		std::string etherTypeStr;
+		std::string srcIP;
+		std::string dstIP;
+		uint8_t ttl = 0;
+		std::string transportProtocol;
+		uint16_t srcPort = 0;
+		uint16_t dstPort = 0;
+		bool incoming = false;
+	};
+
+	std::string LegacyMacToStr(const uint8_t* mac)
+	{
+		char buf[32];
+		snprintf(buf, sizeof(buf), "%02X:%02X:%02X:%02X:%02X:%02X", mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+		return buf;
+	}
+
+	bool LegacyIsLocalAddress(const std::string& ip)
+	{
+		if (ip.rfind("10.", 0) == 0) return true;
+		if (ip.rfind("192.168.", 0) == 0) return true;
+		if (ip.rfind("127.", 0) == 0) return true;
+		if (ip.rfind("172.", 0) == 0)
+		{
+			size_t dot = ip.find('.', 4);
+			if (dot != std::string::npos)
+			{
+				int second = std::stoi(ip.substr(4, dot - 4));
+				if (second >= 16 && second <= 31) return true;
+			}
+		}
+		return false;
+	}
+
+	// The parser as it was before the layer map, kept here as the baseline
+	void LegacyParsePacket(LegacyPacket& pkt)
+	{
+		const uint8_t* d = pkt.data.data();
+		if (pkt.data.size() < 14) return;
+
+		const uint16_t etherType = static_cast<uint16_t>((d[12] << 8) | d[13]);
+		pkt.etherSrc = LegacyMacToStr(d + 6);
+		pkt.etherDst = LegacyMacToStr(d);
+		pkt.etherTypeStr = (etherType == 0x0800) ? "IPv4" : "Other";
+		if (etherType != 0x0800) return;
+		if (pkt.data.size() < 34) return;
+
+		const uint8_t* ip = d + 14;
+		const size_t ipHeaderLen = (ip[0] & 0x0F) * 4;
+		char src[INET_ADDRSTRLEN];
+		char dst[INET_ADDRSTRLEN];
+		inet_ntop(AF_INET, ip + 12, src, sizeof(src));
+		inet_ntop(AF_INET, ip + 16, dst, sizeof(dst));
+		pkt.srcIP = src;
+		pkt.dstIP = dst;
+		pkt.ttl = ip[8];
+
+		const size_t transportOffset = 14 + ipHeaderLen;
+		if (pkt.data.size() < transportOffset + 4) return;
+
+		const uint8_t* l4 = d + transportOffset;
+		switch (ip[9])
+		{
+			case 6: pkt.transportProtocol = "TCP"; break;
+			case 17: pkt.transportProtocol = "UDP"; break;
+			default: pkt.transportProtocol = "Other"; break;
+		}
+		pkt.srcPort = static_cast<uint16_t>((l4[0] << 8) | l4[1]);
+		pkt.dstPort = static_cast<uint16_t>((l4[2] << 8) | l4[3]);
+
+		pkt.incoming = !LegacyIsLocalAddress(pkt.srcIP) && LegacyIsLocalAddress(pkt.dstIP);
+	}
+
+	// Ethernet + IPv4 + TCP/UDP frame truncated to the 64 bytes the capture engine keeps
+	std::vector<uint8_t> MakeFrame(uint32_t index)
+	{
+		std::vector<uint8_t> frame(64, 0);
+		const uint8_t mac[12] = { 0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xAA, 0xBB };
+		std::memcpy(frame.data(), mac, sizeof(mac));
+		frame[12] = 0x08;
+		frame[13] = 0x00;
+
+		uint8_t* ip = frame.data() + 14;
+		ip[0] = 0x45;
+		ip[8] = 64;
+		ip[9] = (index % 3 == 0) ? 17 : 6;
+		const uint32_t src = (index % 2 == 0) ? (0xC0A80000u | (index & 0xFFFF)) : (0x08080000u | (index & 0xFFFF));
+		const uint32_t dst = (index % 2 == 0) ? 0x5DB8D822u : 0xC0A80102u;
+		for (int i = 0; i < 4; ++i)
+		{
+			ip[12 + i] = static_cast<uint8_t>(src >> (24 - i * 8));
+			ip[16 + i] = static_cast<uint8_t>(dst >> (24 - i * 8));
+		}
+
+		uint8_t* l4 = ip + 20;
+		l4[0] = static_cast<uint8_t>(index >> 8);
+		l4[1] = static_cast<uint8_t>(index);
+		l4[2] = 0x01;
+		l4[3] = 0xBB;
+		l4[12] = 0x50; // TCP data offset, harmless for UDP
+		return frame;
+	}
+
+	template <typename Fn>
+	double Measure(const char* name, size_t iterations, Fn&& fn)
+	{
+		const auto start = std::chrono::steady_clock::now();
+		fn();
+		const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		const double rate = static_cast<double>(iterations) / seconds;
+		std::printf("%-24s %12.0f packets/sec (%.3f s)\n", name, rate, seconds);
+		return rate;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const size_t rounds = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000;
+	const size_t frameCount = 1024;
+
+	std::vector<std::vector<uint8_t>> frames;
+	for (uint32_t i = 0; i < frameCount; ++i)
+	{
+		frames.push_back(MakeFrame(i));
+	}
+
+	const size_t iterations = rounds * frameCount;
+	size_t checksum = 0; // Keeps the optimizer from dropping the parse results
+
+	std::vector<LegacyPacket> legacy(frameCount);
+	for (size_t i = 0; i < frameCount; ++i)
+	{
+		legacy[i].data = frames[i];
+	}
+	const double legacyRate = Measure("string parser", iterations, [&]()
+		{
+			for (size_t r = 0; r < rounds; ++r)
+			{
+				for (auto& pkt : legacy)
+				{
+					LegacyParsePacket(pkt);
+					checksum += pkt.srcPort + pkt.incoming + pkt.srcIP.size();
+				}
+			}
+		});
+
+	const LocalNetworks localNetworks = LocalNetworks::Defaults();
+	std::vector<PacketInfo> packets(frameCount);
+	for (size_t i = 0; i < frameCount; ++i)
+	{
+		packets[i].data = frames[i];
+	}
+	const double layerRate = Measure("layer map parser", iterations, [&]()
+		{
+			for (size_t r = 0; r < rounds; ++r)
+			{
+				for (auto& pkt : packets)
+				{
+					PacketParser::ParsePacket(pkt.data.data(), pkt.data.size(), pkt, localNetworks);
+					checksum += pkt.layers.srcPort + pkt.incoming + pkt.layers.srcAddr.low;
+				}
+			}
+		});
+
+	std::printf("speedup: %.2fx (checksum %zu)\n", layerRate / legacyRate, checksum);
+	return 0;
+}
@@ -0,0 +1,72 @@
+#include "ArpPacket.h"
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+	uint16_t ReadU16(const uint8_t* data)
+	{
+		return static_cast<uint16_t>((data[0] << 8) | data[1]);
+	}
+
+	uint32_t ReadU32(const uint8_t* data)
+	{
+		return (static_cast<uint32_t>(data[0]) << 24) | (static_cast<uint32_t>(data[1]) << 16) | (static_cast<uint32_t>(data[2]) << 8) | data[3];
+	}
+}
+
+bool ArpPacket::Parse(const uint8_t* data, size_t available, ArpInfo& info)
+{
+	// Hardware type 1, protocol 0x0800, address lengths 6 and 4
+	if (available < size || ReadU16(data) != 1 || ReadU16(data + 2) != 0x0800 || data[4] != 6 || data[5] != 4)
+	{
+		return false;
+	}
+
+	info.operation = ReadU16(data + 6);
+	std::memcpy(info.senderMac, data + 8, 6);
+	info.senderIp = IpAddress::FromIPv4(ReadU32(data + 14));
+	std::memcpy(info.targetMac, data + 18, 6);
+	info.targetIp = IpAddress::FromIPv4(ReadU32(data + 24));
+	return true;
+}
+
+const char* ArpPacket::OperationName(uint16_t operation)
+{
+	switch (operation)
+	{
+		case 1: return "Request";
+		case 2: return "Reply";
+		case 3: return "RARP Request";
+		case 4: return "RARP Reply";
+		default: return "Unknown";
+	}
+}
+
+std::string ArpPacket::FormatMac(const uint8_t* mac)
+{
+	char text[18];
+	std::snprintf(text, sizeof(text), "%02X:%02X:%02X:%02X:%02X:%02X", mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+	return text;
+}
+
+std::string ArpPacket::FormatSummary(const ArpInfo& info)
+{
+	if (info.IsProbe())
+	{
+		return "Probe for " + info.targetIp.ToString();
+	}
+	if (info.IsGratuitous())
+	{
+		return "Gratuitous: " + info.senderIp.ToString() + " is at " + FormatMac(info.senderMac);
+	}
+	if (info.IsRequest())
+	{
+		return "Who has " + info.targetIp.ToString() + "? Tell " + info.senderIp.ToString();
+	}
+	if (info.IsReply())
+	{
+		return info.senderIp.ToString() + " is at " + FormatMac(info.senderMac);
+	}
+	return OperationName(info.operation);
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include "IpAddress.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Ethernet/IPv4 ARP message
+struct ArpInfo
+{
+	uint16_t operation = 0; // 1 = request, 2 = reply
+	uint8_t senderMac[6] = {};
+	IpAddress senderIp;
+	uint8_t targetMac[6] = {};
+	IpAddress targetIp;
+
+	bool IsRequest() const { return operation == 1; }
+	bool IsReply() const { return operation == 2; }
+
+	// Announces the sender's own address: sender and target IP are the same
+	bool IsGratuitous() const { return senderIp == targetIp && senderIp.IPv4() != 0; }
+
+	// Address conflict probe (RFC 5227), sent from 0.0.0.0 before an address is used
+	bool IsProbe() const { return IsRequest() && senderIp.IPv4() == 0; }
+};
+
+class ArpPacket
+{
+public:
+	static constexpr uint16_t etherType = 0x0806;
+	static constexpr size_t size = 28;
+
+	// Only Ethernet hardware and IPv4 protocol addresses are accepted
+	static bool Parse(const uint8_t* data, size_t size, ArpInfo& info);
+
+	static const char* OperationName(uint16_t operation);
+	static std::string FormatMac(const uint8_t* mac);
+
+	// e.g. "Who has 10.0.0.1? Tell 10.0.0.2", "10.0.0.1 is at 00:11:22:33:44:55"
+	static std::string FormatSummary(const ArpInfo& info);
+};
@@ -0,0 +1,233 @@
+#include "AttackDetector.h"
+#include <bit>
+#include <chrono>
+#include <cmath>
+
+namespace
+{
+	constexpr size_t maxAlerts = 128;
+
+	uint64_t Mix(uint64_t h)
+	{
+		h ^= h >> 33;
+		h *= 0xFF51AFD7ED558CCDull;
+		h ^= h >> 33;
+		h *= 0xC4CEB9FE1A85EC53ull;
+		return h ^ (h >> 33);
+	}
+
+	// Finds the entry for hash in its set, or takes over the empty or least recently seen way.
+	// fresh is set when the caller must fill in the key, also after the window ran out.
+	// Without create an entry whose window ran out is left alone and not returned.
+	template <typename Entry, typename Match>
+	Entry* Probe(std::vector<Entry>& table, size_t ways, uint64_t hash, Match&& match, int64_t nowUs, int64_t windowUs, bool create, bool& fresh)
+	{
+		hash |= 1; // 0 marks an empty way
+		const size_t sets = table.size() / ways;
+		Entry* set = &table[static_cast<size_t>(hash >> 32) % sets * ways];
+
+		Entry* victim = set;
+		for (size_t way = 0; way < ways; ++way)
+		{
+			Entry& entry = set[way];
+			if (entry.hash == hash && match(entry))
+			{
+				fresh = nowUs - entry.startUs >= windowUs;
+				if (fresh && !create) return nullptr;
+				if (fresh)
+				{
+					entry = Entry{};
+					entry.hash = hash;
+					entry.startUs = nowUs;
+				}
+				entry.lastSeenUs = nowUs;
+				return &entry;
+			}
+			if (entry.lastSeenUs < victim->lastSeenUs) victim = &entry;
+		}
+
+		if (!create) return nullptr;
+		*victim = Entry{};
+		victim->hash = hash;
+		victim->startUs = nowUs;
+		victim->lastSeenUs = nowUs;
+		fresh = true;
+		return victim;
+	}
+}
+
+uint32_t AttackDetector::DistinctBitmap::Estimate() const
+{
+	int zeros = 0;
+	for (uint64_t word : bits)
+	{
+		zeros += 64 - std::popcount(word);
+	}
+	const double m = 512.0;
+	return static_cast<uint32_t>(zeros == 0 ? m * std::log(m) : -m * std::log(zeros / m) + 0.5);
+}
+
+const char* AttackDetector::KindName(AttackAlert::Kind kind)
+{
+	switch (kind)
+	{
+		case AttackAlert::Kind::HorizontalScan: return "Horizontal scan";
+		case AttackAlert::Kind::VerticalScan: return "Vertical scan";
+		case AttackAlert::Kind::SynFlood: return "SYN flood";
+		default: return "";
+	}
+}
+
+void AttackDetector::Process(const PacketInfo& pkt)
+{
+	const PacketLayers& layers = pkt.layers;
+	if (!layers.IsTcp()) return;
+
+	// Only connection attempts and their answers are looked at
+	const bool syn = (layers.tcpFlags & 0x02) != 0;
+	const bool ack = (layers.tcpFlags & 0x10) != 0;
+	if (!syn) return;
+
+	const int64_t nowUs = std::chrono::duration_cast<std::chrono::microseconds>(pkt.timestamp.time_since_epoch()).count();
+	const int64_t windowUs = static_cast<int64_t>(windowSeconds.load(std::memory_order_relaxed)) * 1000000;
+	if (ack)
+	{
+		OnSynAck(layers, nowUs, windowUs);
+	}
+	else
+	{
+		OnSyn(layers, nowUs, windowUs);
+	}
+}
+
+void AttackDetector::OnSyn(const PacketLayers& layers, int64_t nowUs, int64_t windowUs)
+{
+	const uint64_t source = layers.srcAddr.Hash();
+	const uint64_t destination = layers.dstAddr.Hash();
+	const uint16_t port = layers.dstPort;
+	bool fresh = false;
+
+	// Horizontal: distinct hosts per source and port
+	const uint64_t horizontalHash = Mix(source ^ (0x100000000ull | port));
+	ScanEntry* entry = Probe(horizontal, ways, horizontalHash, [&](const ScanEntry& e) { return e.port == port && e.source == layers.srcAddr; },
+		nowUs, windowUs, true, fresh);
+	if (fresh)
+	{
+		entry->source = layers.srcAddr;
+		entry->port = port;
+	}
+	entry->targets.Add(Mix(destination));
+	CheckScan(*entry, AttackAlert::Kind::HorizontalScan, nowUs);
+
+	// Vertical: distinct ports per source and host
+	const uint64_t verticalHash = Mix(source ^ std::rotl(destination, 31));
+	entry = Probe(vertical, ways, verticalHash, [&](const ScanEntry& e) { return e.target == layers.dstAddr && e.source == layers.srcAddr; },
+		nowUs, windowUs, true, fresh);
+	if (fresh)
+	{
+		entry->source = layers.srcAddr;
+		entry->target = layers.dstAddr;
+	}
+	entry->targets.Add(Mix(port));
+	CheckScan(*entry, AttackAlert::Kind::VerticalScan, nowUs);
+
+	// Flood: SYNs per service, answered or not
+	const uint64_t floodHash = Mix(destination ^ (0x200000000ull | port));
+	FloodEntry* flood = Probe(floods, ways, floodHash, [&](const FloodEntry& e) { return e.port == port && e.server == layers.dstAddr; },
+		nowUs, windowUs, true, fresh);
+	if (fresh)
+	{
+		flood->server = layers.dstAddr;
+		flood->port = port;
+	}
+	flood->syns++;
+	flood->sources.Add(Mix(source));
+
+	const uint32_t threshold = synFloodThreshold.load(std::memory_order_relaxed);
+	if (!flood->alerted && flood->syns >= threshold &&
+		static_cast<uint64_t>(flood->synAcks) * 100 < static_cast<uint64_t>(flood->syns) * synFloodAnsweredPercent.load(std::memory_order_relaxed))
+	{
+		flood->alerted = true;
+
+		AttackAlert alert;
+		alert.kind = AttackAlert::Kind::SynFlood;
+		alert.timestampUs = nowUs;
+		alert.destination = flood->server;
+		alert.port = flood->port;
+		alert.count = flood->syns;
+		alert.text = "SYN flood: " + flood->server.ToEndpointString(flood->port) + " got " + std::to_string(flood->syns) +
+			" SYNs from about " + std::to_string(flood->sources.Estimate()) + " sources, " +
+			std::to_string(static_cast<uint64_t>(flood->synAcks) * 100 / flood->syns) + "% answered";
+		Raise(std::move(alert));
+	}
+}
+
+void AttackDetector::OnSynAck(const PacketLayers& layers, int64_t nowUs, int64_t windowUs)
+{
+	// The answering server is the source, only services already seen getting SYNs are tracked
+	const uint16_t port = layers.srcPort;
+	const uint64_t floodHash = Mix(layers.srcAddr.Hash() ^ (0x200000000ull | port));
+	bool fresh = false;
+	FloodEntry* flood = Probe(floods, ways, floodHash, [&](const FloodEntry& e) { return e.port == port && e.server == layers.srcAddr; },
+		nowUs, windowUs, false, fresh);
+	if (flood)
+	{
+		flood->synAcks++;
+	}
+}
+
+void AttackDetector::CheckScan(ScanEntry& entry, AttackAlert::Kind kind, int64_t nowUs)
+{
+	if (entry.alerted) return;
+	const uint32_t targets = entry.targets.Estimate();
+	if (targets < scanThreshold.load(std::memory_order_relaxed)) return;
+
+	entry.alerted = true; // Once per window
+
+	AttackAlert alert;
+	alert.kind = kind;
+	alert.timestampUs = nowUs;
+	alert.source = entry.source;
+	alert.count = targets;
+	if (kind == AttackAlert::Kind::HorizontalScan)
+	{
+		alert.port = entry.port;
+		alert.text = "Horizontal scan: " + entry.source.ToString() + " tried about " + std::to_string(targets) + " hosts on port " + std::to_string(entry.port);
+	}
+	else
+	{
+		alert.destination = entry.target;
+		alert.text = "Vertical scan: " + entry.source.ToString() + " tried about " + std::to_string(targets) + " ports on " + entry.target.ToString();
+	}
+	Raise(std::move(alert));
+}
+
+void AttackDetector::Raise(AttackAlert alert)
+{
+	alertCounts[static_cast<size_t>(alert.kind)].fetch_add(1, std::memory_order_relaxed); // ClearAlerts may reset it concurrently
+	lastAlertUs.store(alert.timestampUs, std::memory_order_relaxed);
+
+	std::scoped_lock lock(alertMutex);
+	alerts.push_back(std::move(alert));
+	if (alerts.size() > maxAlerts)
+	{
+		alerts.pop_front();
+	}
+}
+
+std::vector<AttackAlert> AttackDetector::GetRecentAlerts() const
+{
+	std::scoped_lock lock(alertMutex);
+	return std::vector<AttackAlert>(alerts.rbegin(), alerts.rend());
+}
+
+void AttackDetector::ClearAlerts()
+{
+	std::scoped_lock lock(alertMutex);
+	alerts.clear();
+	for (auto& count : alertCounts)
+	{
+		count.store(0, std::memory_order_relaxed);
+	}
+	lastAlertUs.store(0, std::memory_order_relaxed);
+}
@@ -0,0 +1,117 @@
+#pragma once
+#include "IpAddress.h"
+#include "PacketInfo.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct AttackAlert
+{
+	enum class Kind : uint8_t
+	{
+		HorizontalScan, // One source, one port, many hosts
+		VerticalScan, // One source, one host, many ports
+		SynFlood, // Many SYNs to one service, few answered
+		Count
+	};
+
+	Kind kind = Kind::HorizontalScan;
+	int64_t timestampUs = 0;
+	IpAddress source; // Unset for SYN floods, whose sources are usually spoofed
+	IpAddress destination; // Unset for horizontal scans
+	uint16_t port = 0; // Unset for vertical scans
+	uint32_t count = 0; // Distinct targets for scans, SYNs for floods
+	std::string text;
+};
+
+// Streaming port-scan and SYN-flood detection on TCP connection attempts. Each detector keys
+// a fixed-size set-associative table that replaces its stalest entry when a set is full, and
+// each entry counts distinct targets in a small linear-counting bitmap over a tumbling window.
+// Every packet costs one hash and a four-way probe per table, whatever the traffic looks like.
+class AttackDetector
+{
+public:
+	static constexpr size_t kindCount = static_cast<size_t>(AttackAlert::Kind::Count);
+
+	static const char* KindName(AttackAlert::Kind kind);
+
+	// Capture thread only
+	void Process(const PacketInfo& pkt);
+
+	// Thresholds, read by the capture thread on every check
+	void SetWindowSeconds(uint32_t seconds) { windowSeconds = seconds; }
+	uint32_t GetWindowSeconds() const { return windowSeconds.load(); }
+	void SetScanThreshold(uint32_t targets) { scanThreshold = targets; }
+	uint32_t GetScanThreshold() const { return scanThreshold.load(); }
+	void SetSynFloodThreshold(uint32_t syns) { synFloodThreshold = syns; }
+	uint32_t GetSynFloodThreshold() const { return synFloodThreshold.load(); }
+	void SetSynFloodAnsweredPercent(uint32_t percent) { synFloodAnsweredPercent = percent; }
+	uint32_t GetSynFloodAnsweredPercent() const { return synFloodAnsweredPercent.load(); }
+
+	std::vector<AttackAlert> GetRecentAlerts() const; // Newest first
+	uint64_t GetAlertCount(AttackAlert::Kind kind) const { return alertCounts[static_cast<size_t>(kind)].load(); }
+	int64_t GetLastAlertUs() const { return lastAlertUs.load(); }
+	void ClearAlerts(); // Also resets the counts and the last alert time
+
+private:
+	// Linear counting over 512 bits, accurate to a few percent up to about a thousand keys
+	struct DistinctBitmap
+	{
+		std::array<uint64_t, 8> bits{};
+
+		void Add(uint64_t hash) { bits[(hash >> 6) & 7] |= uint64_t{ 1 } << (hash & 63); }
+		uint32_t Estimate() const;
+	};
+
+	struct Window
+	{
+		uint64_t hash = 0; // 0 = empty way
+		int64_t startUs = 0;
+		int64_t lastSeenUs = 0;
+		bool alerted = false;
+	};
+
+	struct ScanEntry : Window
+	{
+		IpAddress source;
+		IpAddress target; // Destination host for vertical scans
+		uint16_t port = 0; // Destination port for horizontal scans
+		DistinctBitmap targets;
+	};
+
+	struct FloodEntry : Window
+	{
+		IpAddress server;
+		uint16_t port = 0;
+		uint32_t syns = 0;
+		uint32_t synAcks = 0;
+		DistinctBitmap sources;
+	};
+
+	static constexpr size_t ways = 4;
+	static constexpr size_t setCount = 1024;
+
+	std::vector<ScanEntry> horizontal = std::vector<ScanEntry>(setCount * ways); // By source and port
+	std::vector<ScanEntry> vertical = std::vector<ScanEntry>(setCount * ways); // By source and host
+	std::vector<FloodEntry> floods = std::vector<FloodEntry>(setCount * ways); // By server and port
+
+	std::atomic<uint32_t> windowSeconds{ 10 };
+	std::atomic<uint32_t> scanThreshold{ 50 };
+	std::atomic<uint32_t> synFloodThreshold{ 1000 };
+	std::atomic<uint32_t> synFloodAnsweredPercent{ 20 };
+
+	std::array<std::atomic<uint64_t>, kindCount> alertCounts{};
+	std::atomic<int64_t> lastAlertUs{ 0 };
+	mutable std::mutex alertMutex; // Guards alerts, taken only when an alert is raised
+	std::deque<AttackAlert> alerts;
+
+	void OnSyn(const PacketLayers& layers, int64_t nowUs, int64_t windowUs);
+	void OnSynAck(const PacketLayers& layers, int64_t nowUs, int64_t windowUs);
+	void CheckScan(ScanEntry& entry, AttackAlert::Kind kind, int64_t nowUs);
+	void Raise(AttackAlert alert);
+};
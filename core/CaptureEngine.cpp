@@ -1,13 +1,27 @@
 #include "CaptureEngine.h"
 #include "PacketParser.h"
 #include <iostream>
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#endif
 #include <algorithm>
-#include <map>
-#include <tuple>
 
 CaptureEngine::CaptureEngine()
-	: allDevices(nullptr), handle(nullptr), capturing(false)
+	: allDevices(nullptr), handle(nullptr), capturing(false),
+	tlsTracker([this](uint64_t flowId, const TlsHelloInfo& info)
+	{
+		std::scoped_lock lock(packetMutex);
+		flowTable.SetTlsHello(flowId, info);
+	})
 {
+	// TLS hellos and HTTP messages are read from the reassembled streams, so messages split
+	// over segments are handled too
+	tcpReassembler.AddSink([this](const TcpStreamEvent& event) { tlsTracker.OnStreamEvent(event); });
+	tcpReassembler.AddSink([this](const TcpStreamEvent& event) { httpTracker.OnStreamEvent(event); });
 }
 
 CaptureEngine::~CaptureEngine()
@@ -77,9 +91,94 @@ bool CaptureEngine::OpenDevice(int index)
 	}
 
 	std::cout << "Opened device: " << (dev->description ? dev->description : dev->name) << std::endl;
+
+	// Classify direction against the interface's own networks
+	{
+		std::scoped_lock lock(localNetworksMutex);
+		deviceNetworks = NetworksFromDevice(dev);
+		localNetworks = deviceNetworks;
+	}
+	localNetworksVersion.fetch_add(1);
 	return true;
 }
 
+// Build the local networks from an interface's IPv4/IPv6 addresses and netmasks
+LocalNetworks CaptureEngine::NetworksFromDevice(const pcap_if_t* dev)
+{
+	// Netmasks are contiguous, so the prefix length is the number of leading ones
+	auto countPrefixBits = [](const uint8_t* mask, size_t bytes)
+	{
+		uint8_t length = 0;
+		for (size_t i = 0; i < bytes * 8 && (mask[i / 8] & (0x80 >> (i % 8))); ++i) ++length;
+		return length;
+	};
+
+	LocalNetworks networks;
+	for (const pcap_addr* a = dev->addresses; a; a = a->next)
+	{
+		if (!a->addr) continue;
+
+		if (a->addr->sa_family == AF_INET)
+		{
+			const auto* addr = reinterpret_cast<const sockaddr_in*>(a->addr);
+			uint8_t length = 32;
+			if (a->netmask && a->netmask->sa_family == AF_INET)
+			{
+				const auto* mask = reinterpret_cast<const sockaddr_in*>(a->netmask);
+				length = countPrefixBits(reinterpret_cast<const uint8_t*>(&mask->sin_addr), 4);
+			}
+			networks.AddPrefix(IpAddress::FromIPv4(ntohl(addr->sin_addr.s_addr)), length);
+		}
+		else if (a->addr->sa_family == AF_INET6)
+		{
+			const auto* addr = reinterpret_cast<const sockaddr_in6*>(a->addr);
+			uint8_t length = 128;
+			if (a->netmask && a->netmask->sa_family == AF_INET6)
+			{
+				const auto* mask = reinterpret_cast<const sockaddr_in6*>(a->netmask);
+				length = countPrefixBits(reinterpret_cast<const uint8_t*>(&mask->sin6_addr), 16);
+			}
+			networks.AddPrefix(IpAddress::FromIPv6(reinterpret_cast<const uint8_t*>(&addr->sin6_addr)), length);
+		}
+	}
+
+	// Without any address on the interface fall back to the private ranges
+	if (networks.Empty())
+	{
+		return LocalNetworks::Defaults();
+	}
+
+	// Loopback and link-local are always local
+	networks.AddPrefix("127.0.0.0/8");
+	networks.AddPrefix("::1/128");
+	networks.AddPrefix("fe80::/10");
+	return networks;
+}
+
+LocalNetworks CaptureEngine::GetLocalNetworks()
+{
+	std::scoped_lock lock(localNetworksMutex);
+	return localNetworks;
+}
+
+void CaptureEngine::SetLocalNetworks(const LocalNetworks& networks)
+{
+	{
+		std::scoped_lock lock(localNetworksMutex);
+		localNetworks = networks;
+	}
+	localNetworksVersion.fetch_add(1);
+}
+
+void CaptureEngine::ResetLocalNetworks()
+{
+	{
+		std::scoped_lock lock(localNetworksMutex);
+		localNetworks = deviceNetworks;
+	}
+	localNetworksVersion.fetch_add(1);
+}
+
 // Close the currently opened device
 void CaptureEngine::CloseDevice()
 {
@@ -102,6 +201,11 @@ bool CaptureEngine::StartCapture()
 	}
 
 	capturing.store(true);
+	ipDefragmenter.Clear();
+	tcpAnalyzer.Clear();
+	quicTracker.Clear();
+	networkDiagnostics.Clear();
+	tcpReassembler.Start();
 
 	// Run the pcap loop on a background thread so the GUI stays responsive
 	captureThread = std::thread([this]()
@@ -136,6 +240,9 @@ void CaptureEngine::StopCapture()
 
 	capturing.store(false);
 
+	// Flushes and closes the streams still open
+	tcpReassembler.Stop();
+
 	// Log message based on whether capturing was active
 	if (wasCapturing)
 	{
@@ -202,26 +309,94 @@ void CaptureEngine::PacketHandler(u_char* user, const pcap_pkthdr* header, const
 		pcap_dump(reinterpret_cast<u_char*>(self->dumper), header, bytes);
 	}
 
-	// Copy up to first 64 bytes of packet data for parsing
-	const size_t available = static_cast<size_t>(header->caplen);
-	const size_t toCopy = std::min<size_t>(available, 64u);
-	packet.data.assign(bytes, bytes + toCopy);
-	PacketParser::ParsePacket(packet);
+	// Pick up local network changes made from the GUI, a single atomic load in the common case
+	const uint64_t networksVersion = self->localNetworksVersion.load(std::memory_order_acquire);
+	if (networksVersion != self->captureLocalNetworksVersion)
+	{
+		std::scoped_lock lock(self->localNetworksMutex);
+		self->captureLocalNetworks = self->localNetworks;
+		self->captureLocalNetworksVersion = networksVersion;
+	}
+
+	// Parse the full captured frame, only a prefix of it is stored
+	ParserOptions parserOptions;
+	parserOptions.decodeTunnels = self->decodeTunnels.load(std::memory_order_relaxed);
+	const uint8_t* frame = bytes;
+	size_t frameSize = static_cast<size_t>(header->caplen);
+	PacketParser::ParsePacket(frame, frameSize, packet, self->captureLocalNetworks, parserOptions);
+
+	// The fragment completing a datagram is replaced by the rebuilt datagram, so its
+	// transport header and ports come from the first fragment
+	if (packet.layers.IsFragment() && self->reassembleIp.load(std::memory_order_relaxed))
+	{
+		const int64_t timestampUs = static_cast<int64_t>(header->ts.tv_sec) * 1000000 + header->ts.tv_usec;
+		const uint8_t fragmentCount = self->ipDefragmenter.AddFragment(frame, frameSize, packet.layers, timestampUs, self->reassembledFrame);
+		if (fragmentCount != 0)
+		{
+			frame = self->reassembledFrame.data();
+			frameSize = self->reassembledFrame.size();
+			PacketParser::ParsePacket(frame, frameSize, packet, self->captureLocalNetworks, parserOptions);
+			packet.layers.reassembledFragments = fragmentCount;
+		}
+	}
+
+	// Names are read from the whole frame, the stored copy may be cut short
+	if (packet.layers.IsDns())
+	{
+		self->dnsTracker.Process(packet, frame, frameSize);
+	}
+	else if (packet.layers.IsQuic())
+	{
+		self->quicTracker.Process(packet, frame, frameSize);
+	}
+	else if (packet.layers.IsArp() || packet.layers.IsIcmp())
+	{
+		self->networkDiagnostics.Process(packet, frame, frameSize);
+	}
+
+	// Keep the frame up to the configured limit for the hex dump and deep dissection
+	const size_t toCopy = std::min<size_t>(frameSize, self->storedBytesLimit.load(std::memory_order_relaxed));
+	packet.data.assign(frame, frame + toCopy);
+
+	self->trafficStats.AddPacket(static_cast<int64_t>(header->ts.tv_sec), header->len,
+		TrafficStats::ProtocolFromIpProtocol(packet.layers.ipProtocol));
+	self->heavyHitters.Process(packet);
+	self->distinctCounters.Process(packet);
+	self->attackDetector.Process(packet);
+	self->ruleEngine.Evaluate(packet, frame, frameSize, packet.ruleMatches);
 	
-	// Add to recent packets buffer (rolling window for UI)
+	packet.sequence = self->nextSequence++;
+	const TcpFlowStats* tcpTotals = self->tcpAnalyzer.Analyze(packet); // Stays valid until the next Analyze
+
+	// Add to recent packets buffer (rolling window for UI) and its flow
+	PacketRef stored;
 	{
 		std::scoped_lock lock(self->packetMutex);
-		self->packetBuffer.push_back(packet);
+		packet.flowId = self->flowTable.GetOrCreateFlow(packet);
+		stored = std::make_shared<const PacketInfo>(std::move(packet));
+
+		self->flowTable.AddPacket(stored);
+		if (tcpTotals)
+		{
+			self->flowTable.SetTcpStats(*stored, *tcpTotals);
+		}
+		self->packetBuffer.push_back(stored);
 		if (self->packetBuffer.size() > self->maxRecentPackets)
 		{
+			self->flowTable.RemoveOldestPacket(self->packetBuffer.front()->flowId);
 			self->packetBuffer.pop_front();
 		}
 	}
 	
+	if (self->reassembleTcp.load(std::memory_order_relaxed))
+	{
+		self->tcpReassembler.Submit(stored);
+	}
+
 	// Add to complete packet history (for history tab)
 	{
 		std::scoped_lock lock(self->historyMutex);
-		self->packetHistory.push_back(std::move(packet));
+		self->packetHistory.push_back(std::move(stored));
 		
 		// Limit history size to prevent unbounded memory growth
 		if (self->packetHistory.size() > self->maxHistoryPackets)
@@ -238,37 +413,86 @@ void CaptureEngine::PacketHandler(u_char* user, const pcap_pkthdr* header, const
 	}
 }
 
-// Retrieve a copy of recent captured packets
-std::vector<PacketInfo> CaptureEngine::GetRecentPackets()
+// Retrieve the recent captured packets
+std::vector<PacketRef> CaptureEngine::GetRecentPackets()
 {
 	std::scoped_lock lock(packetMutex);
-	return std::vector<PacketInfo>(packetBuffer.begin(), packetBuffer.end());
+	return std::vector<PacketRef>(packetBuffer.begin(), packetBuffer.end());
 }
 
-std::map<std::tuple<std::string, uint16_t>, std::vector<PacketInfo>> CaptureEngine::GetGroupedPackets(bool incomingOnly)
+// Get the flows of one direction, ordered by address and port
+std::vector<FlowSummary> CaptureEngine::GetFlows(bool incomingOnly)
 {
 	std::scoped_lock lock(packetMutex);
+	return flowTable.GetFlows(incomingOnly);
+}
 
-	std::map<std::tuple<std::string, uint16_t>, std::vector<PacketInfo>> groupedPackets;
+// Look up a single flow by its ID
+std::optional<FlowSummary> CaptureEngine::GetFlow(uint64_t flowId)
+{
+	std::scoped_lock lock(packetMutex);
+	return flowTable.GetFlow(flowId);
+}
 
-	for (const auto& packet : packetBuffer)
+// Get the packets belonging to a flow
+std::vector<PacketRef> CaptureEngine::GetFlowPackets(uint64_t flowId)
+{
+	std::scoped_lock lock(packetMutex);
+	return flowTable.GetFlowPackets(flowId);
+}
+
+// Get all captured packets from history
+std::vector<PacketRef> CaptureEngine::GetAllCapturedPackets()
+{
+	std::scoped_lock lock(historyMutex);
+	return std::vector<PacketRef>(packetHistory.begin(), packetHistory.end());
+}
+
+// The history is contiguous by sequence number, so a packet's index is its distance from the front
+std::optional<size_t> CaptureEngine::HistoryIndex(uint64_t sequence) const
+{
+	if (packetHistory.empty() || sequence < packetHistory.front()->sequence)
 	{
-		// Filter based on direction
-		if (incomingOnly && !packet.incoming) continue;
-		if (!incomingOnly && packet.incoming) continue;
+		return std::nullopt;
+	}
 
-		// Group by source address and port
-		auto key = std::make_tuple(packet.srcIP, packet.srcPort);
-		groupedPackets[key].push_back(packet);
+	const uint64_t index = sequence - packetHistory.front()->sequence;
+	if (index >= packetHistory.size())
+	{
+		return std::nullopt;
 	}
-	return groupedPackets;
+	return static_cast<size_t>(index);
 }
 
-// Get all captured packets from history
-std::vector<PacketInfo> CaptureEngine::GetAllCapturedPackets()
+// Look up a packet by its sequence number in O(1)
+PacketRef CaptureEngine::GetPacket(uint64_t sequence)
 {
 	std::scoped_lock lock(historyMutex);
-	return packetHistory;
+	const auto index = HistoryIndex(sequence);
+	return index ? packetHistory[*index] : nullptr;
+}
+
+PacketRef CaptureEngine::GetDissectedPacket(uint64_t sequence)
+{
+	PacketRef pkt = GetPacket(sequence);
+	if (!pkt || pkt->dissected)
+	{
+		return pkt;
+	}
+
+	// Dissect a copy outside the lock, packets already handed out stay untouched
+	auto dissected = std::make_shared<PacketInfo>(*pkt);
+	ParserOptions options;
+	options.decodeTunnels = decodeTunnels.load();
+	PacketParser::DissectFields(*dissected, options);
+
+	std::scoped_lock lock(historyMutex);
+	const auto index = HistoryIndex(sequence);
+	if (index && packetHistory[*index] == pkt)
+	{
+		packetHistory[*index] = dissected;
+	}
+	return dissected;
 }
 
 // Get total packet count since capture started
@@ -283,6 +507,7 @@ void CaptureEngine::ClearPacketHistory()
 	{
 		std::scoped_lock lock(packetMutex);
 		packetBuffer.clear();
+		flowTable.Clear();
 	}
 	{
 		std::scoped_lock lock(historyMutex);
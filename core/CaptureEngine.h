@@ -3,10 +3,25 @@
 #include <vector>
 #include <pcap.h>
 #include "PacketInfo.h"
+#include "FlowTable.h"
+#include "TrafficStats.h"
+#include "LocalNetworks.h"
+#include "TcpReassembler.h"
+#include "IpDefragmenter.h"
+#include "TcpAnalyzer.h"
+#include "DnsTracker.h"
+#include "TlsTracker.h"
+#include "HttpTracker.h"
+#include "QuicTracker.h"
+#include "NetworkDiagnostics.h"
+#include "HeavyHitters.h"
+#include "DistinctCounters.h"
+#include "AttackDetector.h"
+#include "RuleEngine.h"
 #include <mutex>
 #include <deque>
-#include <map>
-#include <tuple>
+#include <optional>
+#include <algorithm>
 #include <atomic>
 #include <thread>
 
@@ -22,6 +37,40 @@ public:
 	bool OpenDevice(int index);
 	void CloseDevice();
 
+	// Local networks used to classify packet direction
+	LocalNetworks GetLocalNetworks();
+	void SetLocalNetworks(const LocalNetworks& networks);
+	void ResetLocalNetworks(); // Back to the opened interface's networks
+
+	// Dissection options, read by the capture thread for each packet
+	void SetDecodeTunnels(bool enabled) { decodeTunnels = enabled; }
+	bool GetDecodeTunnels() const { return decodeTunnels.load(); }
+
+	// Bytes of each frame kept in PacketInfo::data for the hex dump and deep dissection
+	void SetStoredBytesLimit(uint32_t bytes) { storedBytesLimit = std::clamp<uint32_t>(bytes, 64u, 65535u); }
+	uint32_t GetStoredBytesLimit() const { return storedBytesLimit.load(); }
+
+	// IPv4 fragments are collected and the rebuilt datagram is stored with the last one
+	void SetReassembleIp(bool enabled) { reassembleIp = enabled; }
+	bool GetReassembleIp() const { return reassembleIp.load(); }
+	IpDefragmenterStats GetDefragmenterStats() const { return ipDefragmenter.GetStats(); }
+
+	// TCP stream reassembly, runs on its own worker threads while capturing.
+	// Stream sinks are added through GetTcpReassembler() before capture starts.
+	void SetReassembleTcp(bool enabled) { reassembleTcp = enabled; }
+	bool GetReassembleTcp() const { return reassembleTcp.load(); }
+	TcpReassembler& GetTcpReassembler() { return tcpReassembler; }
+	const TlsTracker& GetTlsTracker() const { return tlsTracker; }
+	HttpTracker& GetHttpTracker() { return httpTracker; }
+	const QuicTracker& GetQuicTracker() const { return quicTracker; }
+	size_t GetAnalyzedConnectionCount() const { return tcpAnalyzer.GetConnectionCount(); }
+
+	// DNS latency and error statistics, updated as packets are captured
+	DnsTracker& GetDnsTracker() { return dnsTracker; }
+
+	// ARP and ICMP counters, rates and events
+	NetworkDiagnostics& GetNetworkDiagnostics() { return networkDiagnostics; }
+
 	// Capture control
 	bool StartCapture();
 	void StopCapture();
@@ -32,12 +81,25 @@ public:
 	void StopDump();
 	bool IsDumping() const { return dumpingEnabled; }
 
-	std::vector<PacketInfo> GetRecentPackets();
-	std::map<std::tuple<std::string, uint16_t>, std::vector<PacketInfo>> GetGroupedPackets(bool incomingOnly);
+	std::vector<PacketRef> GetRecentPackets();
+
+	// Flow access by stable flow ID
+	std::vector<FlowSummary> GetFlows(bool incomingOnly);
+	std::optional<FlowSummary> GetFlow(uint64_t flowId);
+	std::vector<PacketRef> GetFlowPackets(uint64_t flowId);
 	
 	// Packet history management
-	std::vector<PacketInfo> GetAllCapturedPackets();
+	std::vector<PacketRef> GetAllCapturedPackets();
+	PacketRef GetPacket(uint64_t sequence); // nullptr once the packet left the history
+	// Same packet with its full field tree. Dissection runs once, the result replaces the
+	// history entry so later lookups return it directly.
+	PacketRef GetDissectedPacket(uint64_t sequence);
 	size_t GetTotalPacketCount() const;
+	const TrafficStats& GetTrafficStats() const { return trafficStats; }
+	HeavyHitters& GetHeavyHitters() { return heavyHitters; }
+	const DistinctCounters& GetDistinctCounters() const { return distinctCounters; }
+	AttackDetector& GetAttackDetector() { return attackDetector; }
+	RuleEngine& GetRuleEngine() { return ruleEngine; }
 	void ClearPacketHistory();
 
 private:
@@ -47,21 +109,55 @@ private:
 	std::thread	captureThread;
 
 	std::vector<std::string> deviceNames;
+
+	// Direction classification. The GUI edits localNetworks under its mutex and bumps the
+	// version, the capture thread refreshes its private copy only when the version changes.
+	LocalNetworks localNetworks = LocalNetworks::Defaults();
+	LocalNetworks deviceNetworks = LocalNetworks::Defaults();
+	std::mutex localNetworksMutex;
+	std::atomic<uint64_t> localNetworksVersion{ 1 };
+	LocalNetworks captureLocalNetworks;
+	uint64_t captureLocalNetworksVersion = 0;
+	std::atomic<bool> decodeTunnels{ true };
+	std::atomic<uint32_t> storedBytesLimit{ 1518 }; // A full Ethernet frame by default
+	std::atomic<bool> reassembleIp{ true };
+	IpDefragmenter ipDefragmenter; // Capture thread only, apart from its stats
+	std::vector<uint8_t> reassembledFrame; // Capture thread scratch buffer for rebuilt datagrams
+	std::atomic<bool> reassembleTcp{ true };
+	TlsTracker tlsTracker; // Declared before the reassembler that feeds it, so it outlives it
+	HttpTracker httpTracker; // Same
+	TcpAnalyzer tcpAnalyzer; // Capture thread only
+	DnsTracker dnsTracker;
+	QuicTracker quicTracker; // Capture thread only, apart from its counts
+	NetworkDiagnostics networkDiagnostics; // Written by the capture thread only
+	TcpReassembler tcpReassembler;
 	
 	// Recent packets buffer (for real-time display)
-	std::deque<PacketInfo> packetBuffer;
+	std::deque<PacketRef> packetBuffer;
 	std::recursive_mutex packetMutex;
 	const size_t maxRecentPackets = 2000;
+
+	// Flows built from the recent packets buffer (guarded by packetMutex)
+	FlowTable flowTable;
 	
 	// Complete packet history (for history tab)
-	std::vector<PacketInfo> packetHistory;
+	// Contiguous by sequence number, so lookups are an index from the front
+	std::deque<PacketRef> packetHistory;
 	std::recursive_mutex historyMutex;
 	const size_t maxHistoryPackets = 50000;
 	std::atomic<size_t> totalPacketCount{0};
+	TrafficStats trafficStats; // Lock-free, written by the capture thread only
+	HeavyHitters heavyHitters; // Top talkers over sliding windows, written by the capture thread
+	DistinctCounters distinctCounters; // Lock-free, written by the capture thread only
+	AttackDetector attackDetector; // Scan and SYN flood detection, capture thread only apart from settings and alerts
+	RuleEngine ruleEngine; // Rules are replaced from the GUI, evaluated on the capture thread
+	uint64_t nextSequence = 1; // Only touched by the capture thread, never reset so selections stay valid
 
 	pcap_dumper_t* dumper = nullptr;
 	bool dumpingEnabled = false;
 
 	void FreeDeviceList();
+	std::optional<size_t> HistoryIndex(uint64_t sequence) const; // Requires historyMutex
+	static LocalNetworks NetworksFromDevice(const pcap_if_t* dev);
 	static void PacketHandler(u_char* user, const pcap_pkthdr* header, const u_char* bytes);
 };
\ No newline at end of file
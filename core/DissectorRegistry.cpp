@@ -0,0 +1,69 @@
+#include "DissectorRegistry.h"
+#include <limits>
+
+DissectorRegistry::DissectorRegistry()
+{
+	dissectors.push_back({ "None", nullptr });
+}
+
+// Returns the slot of a dissector, reusing it when the same function is registered under several keys
+uint8_t DissectorRegistry::Add(const Dissector& dissector)
+{
+	for (size_t i = 1; i < dissectors.size(); ++i)
+	{
+		if (dissectors[i].function == dissector.function)
+		{
+			return static_cast<uint8_t>(i);
+		}
+	}
+
+	if (dissectors.size() > std::numeric_limits<uint8_t>::max())
+	{
+		return 0;
+	}
+
+	dissectors.push_back(dissector);
+	return static_cast<uint8_t>(dissectors.size() - 1);
+}
+
+bool DissectorRegistry::RegisterEtherType(uint16_t etherType, const Dissector& dissector)
+{
+	etherTypes[etherType] = Add(dissector);
+	return etherTypes[etherType] != 0;
+}
+
+bool DissectorRegistry::RegisterIpProtocol(uint8_t protocol, const Dissector& dissector)
+{
+	ipProtocols[protocol] = Add(dissector);
+	return ipProtocols[protocol] != 0;
+}
+
+bool DissectorRegistry::RegisterPort(Transport transport, uint16_t port, const Dissector& dissector)
+{
+	auto& table = transport == Transport::TCP ? tcpPorts : udpPorts;
+	table[port] = Add(dissector);
+	return table[port] != 0;
+}
+
+bool DissectorRegistry::Run(uint8_t index, DissectContext& ctx, size_t offset) const
+{
+	return index != 0 && dissectors[index].function(ctx, offset);
+}
+
+bool DissectorRegistry::DispatchEtherType(uint16_t etherType, DissectContext& ctx, size_t offset) const
+{
+	return Run(etherTypes[etherType], ctx, offset);
+}
+
+bool DissectorRegistry::DispatchIpProtocol(uint8_t protocol, DissectContext& ctx, size_t offset) const
+{
+	return Run(ipProtocols[protocol], ctx, offset);
+}
+
+bool DissectorRegistry::DispatchPort(Transport transport, uint16_t srcPort, uint16_t dstPort, DissectContext& ctx, size_t offset) const
+{
+	const auto& table = transport == Transport::TCP ? tcpPorts : udpPorts;
+	const uint8_t dst = table[dstPort];
+	const uint8_t src = table[srcPort];
+	return Run(dst, ctx, offset) || (src != dst && Run(src, ctx, offset));
+}
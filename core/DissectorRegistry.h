@@ -0,0 +1,86 @@
+#pragma once
+#include "PacketLayers.h"
+#include "PacketField.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct ParserOptions
+{
+	bool decodeTunnels = true; // Look inside GRE and VXLAN (UDP 4789) packets
+};
+
+class DissectorRegistry;
+
+// State shared by the dissectors while walking one packet
+struct DissectContext
+{
+	const DissectorRegistry& registry;
+	const uint8_t* data;
+	size_t size;
+	PacketLayers& layers;
+	ParserOptions options;
+	size_t networkEnd = 0; // End of the IP datagram per its length field, may lie past size
+	int tunnelDepth = 0;
+	int vlanTags = 0;
+	std::vector<PacketField>* fields = nullptr; // Field tree output, only set for deep dissection
+};
+
+// Dissects the header starting at offset and dispatches whatever it carries. Returns false
+// when the bytes are not this protocol, before touching ctx, so another dissector may try.
+using DissectFunction = bool (*)(DissectContext& ctx, size_t offset);
+
+// Every dissector runs on the capture path and must stay cheap and allocation-free there.
+// Field trees for the detail panel are only built when ctx.fields is set.
+struct Dissector
+{
+	const char* name;
+	DissectFunction function;
+};
+
+// Maps EtherTypes, IP protocols and ports to dissectors.
+// Every key is a direct index into a flat table of small dissector indices, so dispatch is
+// one load and one indirect call regardless of how many protocols are registered.
+// Registration is not thread-safe and must happen before capture starts.
+class DissectorRegistry
+{
+public:
+	enum class Transport : uint8_t
+	{
+		TCP,
+		UDP
+	};
+
+	DissectorRegistry();
+
+	// Return false once the 255 dissector slots are used up
+	bool RegisterEtherType(uint16_t etherType, const Dissector& dissector);
+	bool RegisterIpProtocol(uint8_t protocol, const Dissector& dissector);
+	bool RegisterPort(Transport transport, uint16_t port, const Dissector& dissector);
+
+	// Return false when no dissector is registered or it did not recognise the bytes
+	bool DispatchEtherType(uint16_t etherType, DissectContext& ctx, size_t offset) const;
+	bool DispatchIpProtocol(uint8_t protocol, DissectContext& ctx, size_t offset) const;
+	// The destination port is tried first since it is usually the server port, the source
+	// port's dissector gets a turn when the first one does not recognise the payload
+	bool DispatchPort(Transport transport, uint16_t srcPort, uint16_t dstPort, DissectContext& ctx, size_t offset) const;
+
+	// Registered dissector for a key, nullptr when there is none
+	const Dissector* FindEtherType(uint16_t etherType) const { return Find(etherTypes[etherType]); }
+	const Dissector* FindIpProtocol(uint8_t protocol) const { return Find(ipProtocols[protocol]); }
+
+	const std::vector<Dissector>& GetDissectors() const { return dissectors; }
+
+private:
+	// Index 0 of every table means "no dissector", so dissectors[0] is a placeholder
+	std::vector<Dissector> dissectors;
+	std::array<uint8_t, 65536> etherTypes{};
+	std::array<uint8_t, 256> ipProtocols{};
+	std::array<uint8_t, 65536> tcpPorts{};
+	std::array<uint8_t, 65536> udpPorts{};
+
+	uint8_t Add(const Dissector& dissector);
+	const Dissector* Find(uint8_t index) const { return index ? &dissectors[index] : nullptr; }
+	bool Run(uint8_t index, DissectContext& ctx, size_t offset) const;
+};
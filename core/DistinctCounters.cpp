@@ -0,0 +1,115 @@
+#include "DistinctCounters.h"
+#include <algorithm>
+#include <bit>
+#include <chrono>
+
+const char* DistinctCounters::KeyClassName(KeyClass keyClass)
+{
+	switch (keyClass)
+	{
+		case KeyClass::SourceAddresses: return "Source addresses";
+		case KeyClass::DestinationAddresses: return "Destination addresses";
+		case KeyClass::DestinationPorts: return "Destination ports";
+		case KeyClass::Services: return "Address and port pairs";
+		case KeyClass::Flows: return "Flows";
+		default: return "";
+	}
+}
+
+void DistinctCounters::Process(const PacketInfo& pkt)
+{
+	const PacketLayers& layers = pkt.layers;
+	if (!layers.srcAddr.IsSet()) return;
+
+	// Fold each key into 64 bits, the hashing below then mixes all of them in one pass
+	const uint64_t source = layers.srcAddr.high * 0x9E3779B97F4A7C15ull ^ layers.srcAddr.low;
+	const uint64_t destination = layers.dstAddr.high * 0x9E3779B97F4A7C15ull ^ layers.dstAddr.low;
+	const bool ports = layers.HasTransport() && (layers.ipProtocol == 6 || layers.ipProtocol == 17);
+	const uint64_t port = ports ? (static_cast<uint64_t>(layers.ipProtocol) << 16 | layers.dstPort) : 0;
+	const uint64_t sourcePort = ports ? layers.srcPort : 0;
+
+	std::array<uint64_t, keyClassCount> keys{};
+	keys[static_cast<size_t>(KeyClass::SourceAddresses)] = source;
+	keys[static_cast<size_t>(KeyClass::DestinationAddresses)] = destination;
+	keys[static_cast<size_t>(KeyClass::DestinationPorts)] = port;
+	keys[static_cast<size_t>(KeyClass::Services)] = destination ^ std::rotl(port + 1, 40);
+	keys[static_cast<size_t>(KeyClass::Flows)] = source ^ std::rotl(destination, 21) ^ std::rotl(port << 16 | sourcePort, 42);
+
+	std::array<uint64_t, keyClassCount> hashes;
+	HyperLogLog::HashKeys(keys.data(), hashes.data(), keyClassCount);
+
+	const int64_t slot = std::chrono::duration_cast<std::chrono::seconds>(pkt.timestamp.time_since_epoch()).count();
+	Bucket& bucket = buckets[static_cast<size_t>(slot) % seriesSeconds];
+
+	// Same recycling as TrafficStats: clear first, then publish the new slot
+	if (bucket.slot.load(std::memory_order_relaxed) != slot)
+	{
+		bucket.slot.store(-1, std::memory_order_relaxed);
+		for (auto& registers : bucket.registers)
+		{
+			for (auto& reg : registers)
+			{
+				reg.store(0, std::memory_order_relaxed);
+			}
+		}
+		bucket.slot.store(slot, std::memory_order_release);
+	}
+
+	for (size_t i = 0; i < keyClassCount; ++i)
+	{
+		// Packets without ports do not count towards the port classes
+		if (!ports && i == static_cast<size_t>(KeyClass::DestinationPorts)) continue;
+		if (!ports && i == static_cast<size_t>(KeyClass::Services)) continue;
+
+		auto& reg = bucket.registers[i][HyperLogLog::RegisterIndex(hashes[i])];
+		const uint8_t rank = HyperLogLog::Rank(hashes[i]);
+		if (rank > reg.load(std::memory_order_relaxed))
+		{
+			reg.store(rank, std::memory_order_relaxed);
+		}
+	}
+}
+
+bool DistinctCounters::Read(int64_t slot, KeyClass keyClass, HyperLogLog& sketch) const
+{
+	if (slot < 0) return false;
+
+	const Bucket& bucket = buckets[static_cast<size_t>(slot) % seriesSeconds];
+	if (bucket.slot.load(std::memory_order_acquire) != slot) return false;
+
+	HyperLogLog copy;
+	const auto& registers = bucket.registers[static_cast<size_t>(keyClass)];
+	for (size_t i = 0; i < HyperLogLog::registerCount; ++i)
+	{
+		copy.SetRegister(i, registers[i].load(std::memory_order_relaxed));
+	}
+
+	// The writer may have recycled the bucket while we were copying
+	if (bucket.slot.load(std::memory_order_acquire) != slot) return false;
+	sketch.Merge(copy);
+	return true;
+}
+
+void DistinctCounters::GetSeries(KeyClass keyClass, int64_t nowSeconds, std::vector<float>& out) const
+{
+	out.assign(seriesSeconds, 0.0f);
+	for (size_t i = 0; i < seriesSeconds; ++i)
+	{
+		HyperLogLog sketch;
+		if (Read(nowSeconds - static_cast<int64_t>(seriesSeconds - 1 - i), keyClass, sketch))
+		{
+			out[i] = static_cast<float>(sketch.Estimate());
+		}
+	}
+}
+
+double DistinctCounters::GetDistinct(KeyClass keyClass, int64_t nowSeconds, size_t seconds) const
+{
+	HyperLogLog merged;
+	const size_t count = std::min(seconds, seriesSeconds - 1);
+	for (size_t i = 1; i <= count; ++i)
+	{
+		Read(nowSeconds - static_cast<int64_t>(i), keyClass, merged);
+	}
+	return merged.Estimate();
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include "HyperLogLog.h"
+#include "PacketInfo.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Distinct counts per second for a few key classes, one HyperLogLog sketch per second and
+// class, kept in a one-minute ring. Counts over longer spans merge the per-second sketches,
+// so memory stays fixed however many keys an attack sprays. Written by the capture thread
+// only and read by the GUI without locks, like TrafficStats.
+class DistinctCounters
+{
+public:
+	enum class KeyClass
+	{
+		SourceAddresses,
+		DestinationAddresses,
+		DestinationPorts,
+		Services, // Destination address and port pairs, wide during scans
+		Flows,
+		Count
+	};
+
+	static constexpr size_t keyClassCount = static_cast<size_t>(KeyClass::Count);
+	static constexpr size_t seriesSeconds = 60;
+
+	static const char* KeyClassName(KeyClass keyClass);
+
+	// Capture thread only
+	void Process(const PacketInfo& pkt);
+
+	// Distinct keys in each second, oldest first, for the seconds ending at nowSeconds
+	void GetSeries(KeyClass keyClass, int64_t nowSeconds, std::vector<float>& out) const;
+
+	// Distinct keys over the last completed seconds, up to seriesSeconds of them
+	double GetDistinct(KeyClass keyClass, int64_t nowSeconds, size_t seconds) const;
+
+private:
+	// Registers are atomics so the GUI can copy them while the capture thread raises them
+	struct Bucket
+	{
+		std::atomic<int64_t> slot{ -1 };
+		std::array<std::array<std::atomic<uint8_t>, HyperLogLog::registerCount>, keyClassCount> registers{};
+	};
+
+	std::array<Bucket, seriesSeconds> buckets;
+
+	// Merges the registers of a second into sketch, false once the bucket holds another second
+	bool Read(int64_t slot, KeyClass keyClass, HyperLogLog& sketch) const;
+};
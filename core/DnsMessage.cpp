@@ -0,0 +1,123 @@
+#include "DnsMessage.h"
+
+namespace
+{
+	uint16_t ReadU16(const uint8_t* p)
+	{
+		return static_cast<uint16_t>((p[0] << 8) | p[1]);
+	}
+}
+
+bool DnsMessage::ReadHeader(const uint8_t* message, size_t size, DnsHeader& header)
+{
+	if (size < headerSize) return false;
+
+	header.id = ReadU16(message);
+	header.flags = ReadU16(message + 2);
+	header.questions = ReadU16(message + 4);
+	header.answers = ReadU16(message + 6);
+	header.authorities = ReadU16(message + 8);
+	header.additionals = ReadU16(message + 10);
+	return true;
+}
+
+bool DnsMessage::ReadName(const uint8_t* message, size_t size, size_t offset, DnsName& name, size_t& end)
+{
+	name.length = 0;
+	size_t position = offset;
+	size_t lowestVisited = offset;
+	bool jumped = false;
+
+	while (true)
+	{
+		if (position >= size) return false;
+		const uint8_t length = message[position];
+
+		if ((length & 0xC0) == 0xC0)
+		{
+			if (position + 1 >= size) return false;
+			const size_t target = (static_cast<size_t>(length & 0x3F) << 8) | message[position + 1];
+			if (target >= lowestVisited) return false;
+
+			if (!jumped)
+			{
+				end = position + 2;
+				jumped = true;
+			}
+			position = target;
+			lowestVisited = target;
+			continue;
+		}
+
+		// 0x40 and 0x80 are the obsolete extended label types
+		if (length & 0xC0) return false;
+
+		if (length == 0)
+		{
+			if (!jumped) end = position + 1;
+			break;
+		}
+
+		if (position + 1 + length > size) return false;
+		if (name.length + (name.length != 0) + length > DnsName::maxLength) return false;
+
+		if (name.length != 0) name.text[name.length++] = '.';
+		for (size_t i = 0; i < length; ++i)
+		{
+			char c = static_cast<char>(message[position + 1 + i]);
+			if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+			else if (c <= ' ' || c > '~') c = '?'; // Keep names printable
+			name.text[name.length++] = c;
+		}
+		position += 1 + length;
+	}
+
+	if (name.length == 0) name.text[name.length++] = '.';
+	name.text[name.length] = '\0';
+	return true;
+}
+
+bool DnsMessage::ReadQuestion(const uint8_t* message, size_t size, size_t offset, DnsName& name, uint16_t& type, size_t& end)
+{
+	size_t nameEnd = 0;
+	if (!ReadName(message, size, offset, name, nameEnd) || nameEnd + 4 > size) return false;
+
+	type = ReadU16(message + nameEnd);
+	end = nameEnd + 4;
+	return true;
+}
+
+const char* DnsMessage::TypeName(uint16_t type)
+{
+	switch (type)
+	{
+		case 1: return "A";
+		case 2: return "NS";
+		case 5: return "CNAME";
+		case 6: return "SOA";
+		case 12: return "PTR";
+		case 15: return "MX";
+		case 16: return "TXT";
+		case 28: return "AAAA";
+		case 33: return "SRV";
+		case 41: return "OPT";
+		case 64: return "SVCB";
+		case 65: return "HTTPS";
+		case 255: return "ANY";
+		default: return nullptr;
+	}
+}
+
+const char* DnsMessage::RcodeName(uint8_t rcode)
+{
+	switch (rcode)
+	{
+		case 0: return "NOERROR";
+		case 1: return "FORMERR";
+		case 2: return "SERVFAIL";
+		case 3: return "NXDOMAIN";
+		case 4: return "NOTIMP";
+		case 5: return "REFUSED";
+		default: return "RCODE?";
+	}
+}
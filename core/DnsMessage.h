@@ -0,0 +1,54 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+struct DnsHeader
+{
+	uint16_t id = 0;
+	uint16_t flags = 0;
+	uint16_t questions = 0;
+	uint16_t answers = 0;
+	uint16_t authorities = 0;
+	uint16_t additionals = 0;
+
+	bool IsResponse() const { return (flags & 0x8000) != 0; }
+	uint8_t Opcode() const { return (flags >> 11) & 0x0F; }
+	uint8_t Rcode() const { return flags & 0x0F; }
+};
+
+// Lower-cased dotted name, "." for the root
+struct DnsName
+{
+	static constexpr size_t maxLength = 253; // Presentation form, without the trailing dot
+
+	char text[maxLength + 3] = {};
+	size_t length = 0;
+
+	std::string_view View() const { return { text, length }; }
+};
+
+// DNS wire format helpers shared by the dissector and the latency tracker.
+// Everything reads from a caller-owned buffer and nothing allocates.
+class DnsMessage
+{
+public:
+	static constexpr uint16_t port = 53;
+	static constexpr size_t headerSize = 12;
+	static constexpr uint8_t rcodeServFail = 2;
+	static constexpr uint8_t rcodeNxDomain = 3;
+
+	static bool ReadHeader(const uint8_t* message, size_t size, DnsHeader& header);
+
+	// Decodes the name at offset, following compression pointers. end receives the offset
+	// just past the name where it appears, not where the pointers led. Returns false for
+	// truncated or malformed names. Each pointer must point before every position visited
+	// so far, which rules out loops without counting jumps.
+	static bool ReadName(const uint8_t* message, size_t size, size_t offset, DnsName& name, size_t& end);
+
+	// Name and type of the question at offset, end is the offset after the question
+	static bool ReadQuestion(const uint8_t* message, size_t size, size_t offset, DnsName& name, uint16_t& type, size_t& end);
+
+	static const char* TypeName(uint16_t type); // nullptr for types without a mnemonic here
+	static const char* RcodeName(uint8_t rcode);
+};
@@ -0,0 +1,167 @@
+#include "DnsTracker.h"
+#include "DnsMessage.h"
+#include "TableTrim.h"
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+namespace
+{
+	constexpr size_t maxPending = 8192;
+	constexpr size_t maxServers = 256;
+	constexpr size_t maxNames = 2048;
+	constexpr int64_t queryTimeoutUs = 5ll * 1000 * 1000;
+	constexpr int64_t expiryIntervalUs = 1000ll * 1000;
+
+	int64_t ToMicroseconds(std::chrono::system_clock::time_point timestamp)
+	{
+		return std::chrono::duration_cast<std::chrono::microseconds>(timestamp.time_since_epoch()).count();
+	}
+
+	void AddResponse(DnsCounters& counters, uint8_t rcode, uint32_t latencyUs)
+	{
+		++counters.responses;
+		counters.latency.Add(latencyUs);
+		if (rcode == DnsMessage::rcodeNxDomain) ++counters.nxdomain;
+		if (rcode == DnsMessage::rcodeServFail) ++counters.servfail;
+	}
+}
+
+size_t DnsTracker::PendingKeyHash::operator()(const PendingKey& key) const
+{
+	const uint64_t rest = (static_cast<uint64_t>(key.clientPort) << 32) | (static_cast<uint64_t>(key.serverPort) << 16) | key.id;
+	return static_cast<size_t>(key.client.Hash() ^ (key.server.Hash() * 31) ^ (rest * 0x9E3779B97F4A7C15ull));
+}
+
+void DnsTracker::Process(const PacketInfo& pkt, const uint8_t* frame, size_t size)
+{
+	const PacketLayers& layers = pkt.layers;
+	if (!layers.IsDns() || layers.ipProtocol != 17) return;
+
+	const size_t offset = layers.payloadOffset;
+	const size_t end = std::min<size_t>(size, offset + layers.payloadLength);
+	DnsHeader header;
+	if (end <= offset || !DnsMessage::ReadHeader(frame + offset, end - offset, header) || header.Opcode() != 0) return;
+
+	// Responses repeat the question, so both sides of the exchange name the same entry
+	DnsName name;
+	uint16_t type = 0;
+	size_t questionEnd = 0;
+	const bool hasName = header.questions != 0 &&
+		DnsMessage::ReadQuestion(frame + offset, end - offset, DnsMessage::headerSize, name, type, questionEnd);
+
+	const int64_t nowUs = ToMicroseconds(pkt.timestamp);
+
+	std::scoped_lock lock(mutex);
+	if (nowUs - lastExpiryUs >= expiryIntervalUs)
+	{
+		Expire(nowUs);
+		lastExpiryUs = nowUs;
+	}
+
+	if (!header.IsResponse())
+	{
+		// A repeated query restarts the clock, the response answers the latest copy
+		if (pending.size() < maxPending)
+		{
+			pending[{ layers.srcAddr, layers.dstAddr, layers.srcPort, layers.dstPort, header.id }] = nowUs;
+		}
+
+		++totals.queries;
+		++ServerCounters(layers.dstAddr).queries;
+		if (hasName) ++NameCounters(name.View()).queries;
+		return;
+	}
+
+	// Unsolicited responses, or ones that arrive after the timeout, are not counted
+	auto it = pending.find({ layers.dstAddr, layers.srcAddr, layers.dstPort, layers.srcPort, header.id });
+	if (it == pending.end()) return;
+
+	const uint32_t latencyUs = static_cast<uint32_t>(std::clamp<int64_t>(nowUs - it->second, 0, std::numeric_limits<uint32_t>::max()));
+	pending.erase(it);
+
+	AddResponse(totals, header.Rcode(), latencyUs);
+	AddResponse(ServerCounters(layers.srcAddr), header.Rcode(), latencyUs);
+	if (hasName) AddResponse(NameCounters(name.View()), header.Rcode(), latencyUs);
+}
+
+void DnsTracker::Expire(int64_t nowUs)
+{
+	for (auto it = pending.begin(); it != pending.end();)
+	{
+		if (nowUs - it->second >= queryTimeoutUs)
+		{
+			++totals.timeouts;
+			++ServerCounters(it->first.server).timeouts;
+			it = pending.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
+}
+
+DnsCounters& DnsTracker::ServerCounters(const IpAddress& server)
+{
+	auto it = servers.find(server);
+	if (it != servers.end()) return it->second;
+
+	TrimLeastCounted(servers, maxServers, [](const DnsCounters& counters) { return counters.queries; });
+	return servers[server];
+}
+
+DnsCounters& DnsTracker::NameCounters(std::string_view name)
+{
+	auto it = names.find(name);
+	if (it != names.end()) return it->second;
+
+	TrimLeastCounted(names, maxNames, [](const DnsCounters& counters) { return counters.queries; });
+	return names.emplace(std::string(name), DnsCounters{}).first->second;
+}
+
+std::vector<DnsServerStats> DnsTracker::GetServerStats() const
+{
+	std::scoped_lock lock(mutex);
+	std::vector<DnsServerStats> result;
+	result.reserve(servers.size());
+	for (const auto& [server, counters] : servers)
+	{
+		result.push_back({ server, counters });
+	}
+	return result;
+}
+
+std::vector<DnsNameStats> DnsTracker::GetNameStats() const
+{
+	std::scoped_lock lock(mutex);
+	std::vector<DnsNameStats> result;
+	result.reserve(names.size());
+	for (const auto& [name, counters] : names)
+	{
+		result.push_back({ name, counters });
+	}
+	return result;
+}
+
+DnsCounters DnsTracker::GetTotals() const
+{
+	std::scoped_lock lock(mutex);
+	return totals;
+}
+
+size_t DnsTracker::GetPendingCount() const
+{
+	std::scoped_lock lock(mutex);
+	return pending.size();
+}
+
+void DnsTracker::Clear()
+{
+	std::scoped_lock lock(mutex);
+	pending.clear();
+	servers.clear();
+	names.clear();
+	totals = {};
+	lastExpiryUs = 0;
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include "LatencyHistogram.h"
+#include "PacketInfo.h"
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+struct DnsCounters
+{
+	uint64_t queries = 0;
+	uint64_t responses = 0; // Matched to a query
+	uint64_t nxdomain = 0;
+	uint64_t servfail = 0;
+	uint64_t timeouts = 0; // Queries without a response in time, tracked per server only
+	LatencyHistogram latency; // Query to response
+};
+
+struct DnsServerStats
+{
+	IpAddress server;
+	DnsCounters counters;
+};
+
+struct DnsNameStats
+{
+	std::string name;
+	DnsCounters counters;
+};
+
+// Matches DNS queries to responses by transaction ID and 5-tuple as packets are captured
+// and keeps per-server and per-name statistics up to date. All tables are bounded: pending
+// queries expire, and the server and name tables replace their least queried entry when full.
+class DnsTracker
+{
+public:
+	// Capture thread only. frame is the full captured frame pkt was parsed from.
+	void Process(const PacketInfo& pkt, const uint8_t* frame, size_t size);
+
+	std::vector<DnsServerStats> GetServerStats() const;
+	std::vector<DnsNameStats> GetNameStats() const;
+	DnsCounters GetTotals() const;
+	size_t GetPendingCount() const;
+	void Clear();
+
+private:
+	struct PendingKey
+	{
+		IpAddress client;
+		IpAddress server;
+		uint16_t clientPort = 0;
+		uint16_t serverPort = 0;
+		uint16_t id = 0;
+
+		bool operator==(const PendingKey&) const = default;
+	};
+
+	struct PendingKeyHash
+	{
+		size_t operator()(const PendingKey& key) const;
+	};
+
+	struct IpAddressHash
+	{
+		size_t operator()(const IpAddress& address) const { return static_cast<size_t>(address.Hash()); }
+	};
+
+	// Lets the name table be searched with a string_view without building a string
+	struct NameHash
+	{
+		using is_transparent = void;
+		size_t operator()(std::string_view name) const { return std::hash<std::string_view>{}(name); }
+	};
+
+	mutable std::mutex mutex; // Guards everything below, held briefly per DNS packet
+	std::unordered_map<PendingKey, int64_t, PendingKeyHash> pending; // Query time in microseconds
+	std::unordered_map<IpAddress, DnsCounters, IpAddressHash> servers;
+	std::unordered_map<std::string, DnsCounters, NameHash, std::equal_to<>> names;
+	DnsCounters totals;
+	int64_t lastExpiryUs = 0;
+
+	void Expire(int64_t nowUs);
+	DnsCounters& ServerCounters(const IpAddress& server);
+	DnsCounters& NameCounters(std::string_view name);
+};
@@ -0,0 +1,197 @@
+#include "FlowTable.h"
+
+namespace
+{
+	constexpr size_t maxConnectionsPerFlow = 256;
+}
+
+uint64_t FlowTable::GetOrCreateFlow(const PacketInfo& pkt)
+{
+	// Incoming flows are keyed by their source, outgoing flows by their destination
+	const PacketLayers& layers = pkt.layers;
+	const IpAddress& address = pkt.incoming ? layers.srcAddr : layers.dstAddr;
+	const uint16_t port = pkt.incoming ? layers.srcPort : layers.dstPort;
+	const FlowKey key = pkt.quicConnection != 0
+		? FlowKey{ pkt.incoming, pkt.layers.OuterVlan(), IpAddress{}, 0, pkt.quicConnection }
+		: FlowKey{ pkt.incoming, pkt.layers.OuterVlan(), address, port, 0 };
+
+	auto [it, inserted] = flowIndex.try_emplace(key, nextFlowId);
+	if (inserted)
+	{
+		// Strings are only formatted once per flow, not per packet
+		FlowRecord& record = flows[nextFlowId];
+		record.key = key;
+		record.address = address;
+		record.port = port;
+		record.summary.id = nextFlowId;
+		record.summary.incoming = pkt.incoming;
+		record.summary.address = address.ToString();
+		record.summary.port = port;
+		record.summary.endpoint = address.ToEndpointString(port);
+		record.summary.protocol = pkt.quicConnection != 0 ? "QUIC" : pkt.GetTransportName();
+		record.summary.vlanId = pkt.layers.OuterVlan();
+		record.summary.quicConnection = pkt.quicConnection;
+		++nextFlowId;
+	}
+	return it->second;
+}
+
+void FlowTable::AddPacket(const PacketRef& pkt)
+{
+	auto it = flows.find(pkt->flowId);
+	if (it == flows.end())
+	{
+		return;
+	}
+
+	FlowRecord& record = it->second;
+	record.packets.push_back(pkt);
+	record.summary.packetCount = record.packets.size();
+
+	// A QUIC connection that migrated or was rebound shows its current endpoint
+	if (record.summary.quicConnection != 0)
+	{
+		const IpAddress& address = pkt->incoming ? pkt->layers.srcAddr : pkt->layers.dstAddr;
+		const uint16_t port = pkt->incoming ? pkt->layers.srcPort : pkt->layers.dstPort;
+		if (address != record.address || port != record.port)
+		{
+			record.address = address;
+			record.port = port;
+			record.summary.address = address.ToString();
+			record.summary.port = port;
+			record.summary.endpoint = address.ToEndpointString(port);
+		}
+	}
+}
+
+void FlowTable::SetTcpStats(const PacketInfo& pkt, const TcpFlowStats& totals)
+{
+	auto it = flows.find(pkt.flowId);
+	if (it == flows.end())
+	{
+		return;
+	}
+
+	FlowRecord& record = it->second;
+	const TcpConnectionKey key = TcpConnectionKey::FromPacket(pkt.layers);
+	auto [conn, inserted] = record.tcpConnections.try_emplace(key);
+	if (inserted)
+	{
+		const IpAddress& local = pkt.incoming ? pkt.layers.dstAddr : pkt.layers.srcAddr;
+		conn->second.summary.localEndpoint = local.ToEndpointString(pkt.incoming ? pkt.layers.dstPort : pkt.layers.srcPort);
+		conn->second.lruPosition = record.tcpLru.insert(record.tcpLru.end(), key);
+	}
+	else
+	{
+		record.tcpLru.splice(record.tcpLru.end(), record.tcpLru, conn->second.lruPosition);
+	}
+	conn->second.summary.stats = totals;
+
+	if (record.tcpConnections.size() > maxConnectionsPerFlow)
+	{
+		auto oldest = record.tcpConnections.find(record.tcpLru.front());
+		record.retiredTcp.Add(oldest->second.summary.stats);
+		record.tcpConnections.erase(oldest);
+		record.tcpLru.pop_front();
+	}
+}
+
+void FlowTable::SetTlsHello(uint64_t flowId, const TlsHelloInfo& info)
+{
+	auto it = flows.find(flowId);
+	if (it == flows.end())
+	{
+		return;
+	}
+
+	FlowSummary& summary = it->second.summary;
+	if (!info.serverName.empty())
+	{
+		summary.serverName = info.serverName;
+	}
+	const char* version = TlsHello::VersionName(info.version);
+	summary.tls = version ? version : "TLS";
+	if (!info.alpn.empty())
+	{
+		summary.tls += ", " + info.alpn;
+	}
+}
+
+void FlowTable::RemoveOldestPacket(uint64_t flowId)
+{
+	auto it = flows.find(flowId);
+	if (it == flows.end())
+	{
+		return;
+	}
+
+	FlowRecord& record = it->second;
+	if (!record.packets.empty())
+	{
+		record.packets.pop_front();
+	}
+	record.summary.packetCount = record.packets.size();
+
+	if (record.packets.empty())
+	{
+		flowIndex.erase(record.key);
+		flows.erase(it);
+	}
+}
+
+std::vector<FlowSummary> FlowTable::GetFlows(bool incoming) const
+{
+	std::vector<FlowSummary> result;
+
+	for (const auto& [key, id] : flowIndex)
+	{
+		if (std::get<0>(key) != incoming) continue;
+
+		auto it = flows.find(id);
+		if (it != flows.end())
+		{
+			result.push_back(Summarize(it->second));
+		}
+	}
+	return result;
+}
+
+std::optional<FlowSummary> FlowTable::GetFlow(uint64_t flowId) const
+{
+	auto it = flows.find(flowId);
+	if (it == flows.end())
+	{
+		return std::nullopt;
+	}
+	return Summarize(it->second);
+}
+
+std::vector<PacketRef> FlowTable::GetFlowPackets(uint64_t flowId) const
+{
+	auto it = flows.find(flowId);
+	if (it == flows.end())
+	{
+		return {};
+	}
+	return std::vector<PacketRef>(it->second.packets.begin(), it->second.packets.end());
+}
+
+void FlowTable::Clear()
+{
+	flowIndex.clear();
+	flows.clear();
+}
+
+FlowSummary FlowTable::Summarize(const FlowRecord& record)
+{
+	FlowSummary summary = record.summary;
+	summary.tcp = record.retiredTcp;
+	summary.connections.reserve(record.tcpConnections.size());
+	for (auto it = record.tcpLru.rbegin(); it != record.tcpLru.rend(); ++it)
+	{
+		const TcpConnectionSummary& conn = record.tcpConnections.at(*it).summary;
+		summary.tcp.Add(conn.stats);
+		summary.connections.push_back(conn);
+	}
+	return summary;
+}
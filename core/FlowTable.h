@@ -0,0 +1,100 @@
+#pragma once
+#include "PacketInfo.h"
+#include "TcpAnalyzer.h"
+#include "TcpConnectionKey.h"
+#include "TlsHello.h"
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <map>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+// TCP analysis totals of one connection in a flow, as kept by TcpAnalyzer
+struct TcpConnectionSummary
+{
+	std::string localEndpoint; // The connection's end on this side, e.g. "10.0.0.2:51234"
+	TcpFlowStats stats;
+};
+
+// Summary of a flow as shown in the flow tables
+struct FlowSummary
+{
+	uint64_t id = 0;
+	bool incoming = false;
+	std::string address; // Remote endpoint: source for incoming, destination for outgoing
+	uint16_t port = 0;
+	std::string endpoint; // Address and port, bracketed for IPv6
+	std::string protocol;
+	uint16_t vlanId = 0; // Outer VLAN tag, 0 when untagged
+	size_t packetCount = 0;
+	TcpFlowStats tcp; // Only filled for TCP flows: totals over all its connections
+	std::vector<TcpConnectionSummary> connections; // Most recently active first
+	std::string serverName; // TLS SNI of the latest hello seen on the flow
+	std::string tls; // e.g. "TLS 1.3, h2"
+	uint64_t quicConnection = 0; // QUIC flows are grouped by connection ID rather than endpoint
+};
+
+// Groups recent packets by direction, outer VLAN and remote endpoint, or by QUIC connection
+// so a connection stays one flow when its address or port changes.
+// Each flow gets a stable 64-bit ID the GUI can hold on to instead of a string key.
+class FlowTable
+{
+public:
+	// Finds the flow a packet belongs to, creating it if needed, and returns its ID
+	uint64_t GetOrCreateFlow(const PacketInfo& pkt);
+
+	// Appends a packet to the flow recorded in its flowId
+	void AddPacket(const PacketRef& pkt);
+
+	// Records the running TCP analysis totals of the packet's connection, replacing the
+	// connection's previous totals. The totals outlive the packets in the flow.
+	void SetTcpStats(const PacketInfo& pkt, const TcpFlowStats& totals);
+
+	// Records a TLS hello seen on the flow, a later hello replaces an earlier one
+	void SetTlsHello(uint64_t flowId, const TlsHelloInfo& info);
+
+	// Drops the oldest packet of a flow, removing the flow once it is empty
+	void RemoveOldestPacket(uint64_t flowId);
+
+	std::vector<FlowSummary> GetFlows(bool incoming) const;
+	std::optional<FlowSummary> GetFlow(uint64_t flowId) const;
+	std::vector<PacketRef> GetFlowPackets(uint64_t flowId) const;
+
+	size_t GetFlowCount() const { return flows.size(); }
+	void Clear();
+
+private:
+	// Binary key, ordered so the flow tables keep a stable address/port ordering.
+	// QUIC flows leave the address and port empty and use the connection instead.
+	using FlowKey = std::tuple<bool, uint16_t, IpAddress, uint16_t, uint64_t>;
+
+	struct ConnectionRecord
+	{
+		TcpConnectionSummary summary;
+		std::list<TcpConnectionKey>::iterator lruPosition;
+	};
+
+	struct FlowRecord
+	{
+		FlowKey key;
+		FlowSummary summary;
+		IpAddress address; // Latest remote endpoint, QUIC flows follow it
+		uint16_t port = 0;
+		std::deque<PacketRef> packets;
+
+		// Connections beyond the limit fold their totals into retiredTcp, least recently active first
+		std::unordered_map<TcpConnectionKey, ConnectionRecord, TcpConnectionKeyHash> tcpConnections;
+		std::list<TcpConnectionKey> tcpLru;
+		TcpFlowStats retiredTcp;
+	};
+
+	std::map<FlowKey, uint64_t> flowIndex;
+	std::unordered_map<uint64_t, FlowRecord> flows;
+	uint64_t nextFlowId = 1; // 0 is reserved for "no flow"
+
+	static FlowSummary Summarize(const FlowRecord& record);
+};
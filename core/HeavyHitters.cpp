@@ -0,0 +1,266 @@
+#include "HeavyHitters.h"
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+namespace
+{
+	uint64_t Mix(uint64_t h)
+	{
+		h ^= h >> 33;
+		h *= 0xFF51AFD7ED558CCDull;
+		h ^= h >> 33;
+		h *= 0xC4CEB9FE1A85EC53ull;
+		return h ^ (h >> 33);
+	}
+}
+
+uint64_t TalkerKey::Hash() const
+{
+	const uint64_t ports = (static_cast<uint64_t>(srcPort) << 24) | (static_cast<uint64_t>(dstPort) << 8) | protocol;
+	return Mix(srcAddr.Hash() ^ Mix(dstAddr.Hash() + ports));
+}
+
+void CountMinSketch::Add(uint64_t hash, uint64_t weight)
+{
+	for (size_t row = 0; row < depth; ++row)
+	{
+		counters[Index(hash, row)] += weight;
+	}
+}
+
+uint64_t CountMinSketch::Estimate(uint64_t hash) const
+{
+	uint64_t estimate = std::numeric_limits<uint64_t>::max();
+	for (size_t row = 0; row < depth; ++row)
+	{
+		estimate = std::min(estimate, counters[Index(hash, row)]);
+	}
+	return estimate;
+}
+
+void HeavyHitters::Summary::Offer(const TalkerKey& key, uint64_t hash, uint32_t bytes)
+{
+	sketch.Add(hash, bytes);
+
+	for (size_t i = 0; i < used; ++i)
+	{
+		if (hashes[i] == hash && entries[i].key == key)
+		{
+			entries[i].bytes += bytes;
+			entries[i].packets++;
+			return;
+		}
+	}
+
+	// A key seen before it was tracked starts from its sketch estimate, everything above this
+	// packet is counted as possible error
+	const uint64_t estimate = sketch.Estimate(hash);
+	size_t index = used;
+	if (used < capacity)
+	{
+		++used;
+	}
+	else
+	{
+		index = 0;
+		for (size_t i = 1; i < capacity; ++i)
+		{
+			if (entries[i].bytes < entries[index].bytes) index = i;
+		}
+		if (estimate <= entries[index].bytes) return;
+	}
+
+	hashes[index] = hash;
+	entries[index] = { key, hash, estimate, estimate - bytes, 1 };
+}
+
+const HeavyHitters::Entry* HeavyHitters::Summary::Find(const TalkerKey& key, uint64_t hash) const
+{
+	for (size_t i = 0; i < used; ++i)
+	{
+		if (hashes[i] == hash && entries[i].key == key) return &entries[i];
+	}
+	return nullptr;
+}
+
+void HeavyHitters::Summary::Clear()
+{
+	sketch.Clear();
+	used = 0;
+}
+
+HeavyHitters::HeavyHitters()
+	: panes(paneCount)
+{
+}
+
+void HeavyHitters::Process(const PacketInfo& pkt)
+{
+	const PacketLayers& layers = pkt.layers;
+	if (!layers.srcAddr.IsSet()) return;
+
+	const int64_t seconds = std::chrono::duration_cast<std::chrono::seconds>(pkt.timestamp.time_since_epoch()).count();
+	const int64_t slot = seconds / paneSeconds;
+	const bool ports = layers.HasTransport() && (layers.ipProtocol == 6 || layers.ipProtocol == 17);
+
+	TalkerKey source;
+	source.srcAddr = layers.srcAddr;
+
+	TalkerKey flow;
+	flow.srcAddr = layers.srcAddr;
+	flow.dstAddr = layers.dstAddr;
+	flow.protocol = layers.ipProtocol;
+	if (ports)
+	{
+		flow.srcPort = layers.srcPort;
+		flow.dstPort = layers.dstPort;
+	}
+
+	TalkerKey port;
+	port.dstPort = layers.dstPort;
+	port.protocol = layers.ipProtocol;
+
+	// Hashing happens before the lock is taken
+	const uint64_t sourceHash = source.Hash();
+	const uint64_t flowHash = flow.Hash();
+	const uint64_t portHash = port.Hash();
+
+	std::scoped_lock lock(mutex);
+	Pane& pane = panes[static_cast<size_t>(slot) % paneCount];
+	if (pane.slot != slot)
+	{
+		for (Summary& summary : pane.summaries)
+		{
+			summary.Clear();
+		}
+		pane.bytes = 0;
+		pane.slot = slot;
+	}
+
+	pane.bytes += pkt.length;
+	pane.summaries[static_cast<size_t>(KeyClass::SourceAddress)].Offer(source, sourceHash, pkt.length);
+	pane.summaries[static_cast<size_t>(KeyClass::Flow)].Offer(flow, flowHash, pkt.length);
+	if (ports)
+	{
+		pane.summaries[static_cast<size_t>(KeyClass::DestinationPort)].Offer(port, portHash, pkt.length);
+	}
+}
+
+size_t HeavyHitters::PaneCount(Window window) const
+{
+	// The current pane is still filling, so ten seconds covers between five and ten
+	return window == Window::TenSeconds ? 2 : paneCount;
+}
+
+std::vector<HeavyHitter> HeavyHitters::GetTop(KeyClass keyClass, Window window, int64_t nowSeconds, size_t count) const
+{
+	const size_t classIndex = static_cast<size_t>(keyClass);
+	const int64_t lastSlot = nowSeconds / paneSeconds;
+	const size_t windowPanes = PaneCount(window);
+
+	std::scoped_lock lock(mutex);
+	std::vector<const Pane*> covered;
+	for (size_t i = 0; i < windowPanes; ++i)
+	{
+		const int64_t slot = lastSlot - static_cast<int64_t>(i);
+		const Pane& pane = panes[static_cast<size_t>(slot) % paneCount];
+		if (slot >= 0 && pane.slot == slot) covered.push_back(&pane);
+	}
+
+	// Any key tracked in one pane is a candidate. Panes that did not track it contribute their
+	// sketch estimate, all of which counts as error.
+	std::vector<HeavyHitter> result;
+	std::vector<uint64_t> seen;
+	for (const Pane* source : covered)
+	{
+		const Summary& sourceSummary = source->summaries[classIndex];
+		for (size_t i = 0; i < sourceSummary.used; ++i)
+		{
+			const Entry& candidate = sourceSummary.entries[i];
+			if (std::find(seen.begin(), seen.end(), candidate.hash) != seen.end()) continue;
+			seen.push_back(candidate.hash);
+
+			HeavyHitter hitter;
+			hitter.key = candidate.key;
+			for (const Pane* pane : covered)
+			{
+				const Summary& summary = pane->summaries[classIndex];
+				const uint64_t estimate = summary.sketch.Estimate(candidate.hash);
+				if (const Entry* entry = summary.Find(candidate.key, candidate.hash))
+				{
+					const uint64_t bytes = std::min(entry->bytes, estimate);
+					hitter.bytes += bytes;
+					hitter.error += bytes - std::min(bytes, entry->bytes - entry->error);
+					hitter.packets += entry->packets;
+				}
+				else
+				{
+					hitter.bytes += estimate;
+					hitter.error += estimate;
+				}
+			}
+			result.push_back(hitter);
+		}
+	}
+
+	std::sort(result.begin(), result.end(), [](const HeavyHitter& a, const HeavyHitter& b) { return a.bytes > b.bytes; });
+	if (result.size() > count) result.resize(count);
+	return result;
+}
+
+uint64_t HeavyHitters::GetWindowBytes(Window window, int64_t nowSeconds) const
+{
+	const int64_t lastSlot = nowSeconds / paneSeconds;
+	const size_t windowPanes = PaneCount(window);
+
+	std::scoped_lock lock(mutex);
+	uint64_t bytes = 0;
+	for (size_t i = 0; i < windowPanes; ++i)
+	{
+		const int64_t slot = lastSlot - static_cast<int64_t>(i);
+		const Pane& pane = panes[static_cast<size_t>(slot) % paneCount];
+		if (slot >= 0 && pane.slot == slot) bytes += pane.bytes;
+	}
+	return bytes;
+}
+
+void HeavyHitters::Clear()
+{
+	std::scoped_lock lock(mutex);
+	for (Pane& pane : panes)
+	{
+		pane.slot = -1;
+	}
+}
+
+std::string HeavyHitters::FormatKey(KeyClass keyClass, const TalkerKey& key)
+{
+	const char* protocol = key.protocol == 6 ? "TCP" : key.protocol == 17 ? "UDP" : nullptr;
+	switch (keyClass)
+	{
+		case KeyClass::SourceAddress:
+			return key.srcAddr.ToString();
+		case KeyClass::DestinationPort:
+			return std::to_string(key.dstPort) + "/" + (protocol ? protocol : std::to_string(key.protocol));
+		case KeyClass::Flow:
+			if (!protocol)
+			{
+				return key.srcAddr.ToString() + " -> " + key.dstAddr.ToString() + " (" + std::to_string(key.protocol) + ")";
+			}
+			return std::string(protocol) + " " + key.srcAddr.ToEndpointString(key.srcPort) + " -> " + key.dstAddr.ToEndpointString(key.dstPort);
+		default:
+			return {};
+	}
+}
+
+const char* HeavyHitters::KeyClassName(KeyClass keyClass)
+{
+	switch (keyClass)
+	{
+		case KeyClass::SourceAddress: return "Source address";
+		case KeyClass::DestinationPort: return "Destination port";
+		case KeyClass::Flow: return "Flow";
+		default: return "";
+	}
+}
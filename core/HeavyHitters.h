@@ -0,0 +1,128 @@
+#pragma once
+#include "IpAddress.h"
+#include "PacketInfo.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// What a heavy hitter is counted by. Fields that do not belong to the key class stay zero.
+struct TalkerKey
+{
+	IpAddress srcAddr;
+	IpAddress dstAddr;
+	uint16_t srcPort = 0;
+	uint16_t dstPort = 0;
+	uint8_t protocol = 0;
+
+	uint64_t Hash() const;
+	bool operator==(const TalkerKey&) const = default;
+};
+
+struct HeavyHitter
+{
+	TalkerKey key;
+	uint64_t bytes = 0; // Estimate, never below the true count
+	uint64_t error = 0; // The true count is at least bytes - error
+	uint64_t packets = 0; // Counted while the key was tracked, so a lower bound
+};
+
+// Count-Min sketch over 64-bit key hashes. Estimates never fall below the true count and
+// exceed it by at most e/width of the total with probability 1 - e^-depth.
+class CountMinSketch
+{
+public:
+	static constexpr size_t depth = 4;
+	static constexpr size_t width = 1024;
+
+	void Add(uint64_t hash, uint64_t weight);
+	uint64_t Estimate(uint64_t hash) const;
+	void Clear() { counters.fill(0); }
+
+private:
+	std::array<uint64_t, depth * width> counters{};
+
+	// Each row takes its own 16 bits of the key hash, so rows collide independently
+	static_assert(depth * 16 <= 64 && width <= (1u << 16) && (width & (width - 1)) == 0);
+	static size_t Index(uint64_t hash, size_t row)
+	{
+		return row * width + ((hash >> (row * 16)) & (width - 1));
+	}
+};
+
+// Top talkers by bytes over sliding windows, kept in constant memory on the capture thread.
+// Time is cut into panes of a few seconds, each holding a Space-Saving summary per key class
+// backed by a Count-Min sketch: a key that is not tracked replaces the smallest tracked one
+// only once the sketch says it has outgrown it, so one-off keys do not churn the summary.
+// A window is answered by merging the panes it covers.
+class HeavyHitters
+{
+public:
+	enum class KeyClass
+	{
+		SourceAddress,
+		DestinationPort,
+		Flow, // Directional 5-tuple
+		Count
+	};
+
+	enum class Window
+	{
+		TenSeconds,
+		OneMinute
+	};
+
+	static constexpr size_t keyClassCount = static_cast<size_t>(KeyClass::Count);
+	static constexpr size_t capacity = 64; // Keys tracked per pane and key class
+	static constexpr int64_t paneSeconds = 5;
+	static constexpr size_t paneCount = 12;
+
+	HeavyHitters();
+
+	// Capture thread only
+	void Process(const PacketInfo& pkt);
+
+	// Heaviest keys first, estimates summed over the panes the window covers
+	std::vector<HeavyHitter> GetTop(KeyClass keyClass, Window window, int64_t nowSeconds, size_t count) const;
+	uint64_t GetWindowBytes(Window window, int64_t nowSeconds) const;
+	void Clear();
+
+	static std::string FormatKey(KeyClass keyClass, const TalkerKey& key);
+	static const char* KeyClassName(KeyClass keyClass);
+
+private:
+	struct Entry
+	{
+		TalkerKey key;
+		uint64_t hash = 0;
+		uint64_t bytes = 0;
+		uint64_t error = 0;
+		uint64_t packets = 0;
+	};
+
+	struct Summary
+	{
+		CountMinSketch sketch;
+		std::array<uint64_t, capacity> hashes{}; // Scanned first, kept apart from the entries for locality
+		std::array<Entry, capacity> entries;
+		size_t used = 0;
+
+		void Offer(const TalkerKey& key, uint64_t hash, uint32_t bytes);
+		const Entry* Find(const TalkerKey& key, uint64_t hash) const;
+		void Clear();
+	};
+
+	struct Pane
+	{
+		int64_t slot = -1;
+		uint64_t bytes = 0;
+		std::array<Summary, keyClassCount> summaries;
+	};
+
+	mutable std::mutex mutex; // Taken once per packet by the capture thread and briefly by readers
+	std::vector<Pane> panes; // About a megabyte, so kept off the engine object
+
+	size_t PaneCount(Window window) const;
+};
@@ -0,0 +1,216 @@
+#include "HttpMessage.h"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+// SSE2 is part of every x86-64 target, MSVC does not define __SSE2__ so its macros are checked too
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define HTTP_MESSAGE_SSE2 1
+#endif
+
+namespace
+{
+	bool EqualsIgnoreCase(std::string_view a, std::string_view b)
+	{
+		if (a.size() != b.size()) return false;
+		for (size_t i = 0; i < a.size(); ++i)
+		{
+			if (HttpMessage::ToLower(a[i]) != HttpMessage::ToLower(b[i])) return false;
+		}
+		return true;
+	}
+
+	bool ContainsIgnoreCase(std::string_view text, std::string_view word)
+	{
+		for (size_t i = 0; i + word.size() <= text.size(); ++i)
+		{
+			if (EqualsIgnoreCase(text.substr(i, word.size()), word)) return true;
+		}
+		return false;
+	}
+
+	std::string_view Trim(std::string_view text)
+	{
+		while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) text.remove_prefix(1);
+		while (!text.empty() && (text.back() == ' ' || text.back() == '\t' || text.back() == '\r')) text.remove_suffix(1);
+		return text;
+	}
+
+	std::string_view View(const uint8_t* data, size_t size)
+	{
+		return std::string_view(reinterpret_cast<const char*>(data), size);
+	}
+
+	int64_t ParseLength(std::string_view text)
+	{
+		if (text.empty() || text.size() > 18) return -1;
+		int64_t value = 0;
+		for (char c : text)
+		{
+			if (c < '0' || c > '9') return -1;
+			value = value * 10 + (c - '0');
+		}
+		return value;
+	}
+
+	// Calls onHeader(name, value) for each header line after the first line of the head
+	template <typename Callback>
+	void ForEachHeader(const uint8_t* data, size_t size, Callback&& onHeader)
+	{
+		size_t position = HttpMessage::Find(data, size, '\n') + 1;
+		while (position < size)
+		{
+			// One scan finds the colon of a header line or the end of a line without one
+			const size_t delimiter = position + HttpMessage::FindEither(data + position, size - position, ':', '\n');
+			if (delimiter >= size) return;
+			if (data[delimiter] == '\n')
+			{
+				position = delimiter + 1;
+				continue;
+			}
+
+			const size_t lineEnd = delimiter + 1 + HttpMessage::Find(data + delimiter + 1, size - delimiter - 1, '\n');
+			onHeader(Trim(View(data + position, delimiter - position)), Trim(View(data + delimiter + 1, std::min(lineEnd, size) - delimiter - 1)));
+			position = lineEnd + 1;
+		}
+	}
+
+	// Splits "a b c" at the first two spaces of the first line
+	bool SplitFirstLine(std::string_view line, std::string_view& first, std::string_view& second, std::string_view& rest)
+	{
+		const size_t space1 = line.find(' ');
+		if (space1 == std::string_view::npos) return false;
+		const size_t space2 = line.find(' ', space1 + 1);
+		first = line.substr(0, space1);
+		second = line.substr(space1 + 1, space2 == std::string_view::npos ? std::string_view::npos : space2 - space1 - 1);
+		rest = space2 == std::string_view::npos ? std::string_view() : line.substr(space2 + 1);
+		return !first.empty() && !second.empty();
+	}
+}
+
+size_t HttpMessage::FindEither(const uint8_t* data, size_t size, uint8_t a, uint8_t b)
+{
+	size_t i = 0;
+#ifdef HTTP_MESSAGE_SSE2
+	const __m128i matchA = _mm_set1_epi8(static_cast<char>(a));
+	const __m128i matchB = _mm_set1_epi8(static_cast<char>(b));
+	for (; i + 16 <= size; i += 16)
+	{
+		const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+		const __m128i hits = _mm_or_si128(_mm_cmpeq_epi8(block, matchA), _mm_cmpeq_epi8(block, matchB));
+		const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(hits));
+		if (mask != 0)
+		{
+			return i + std::countr_zero(mask);
+		}
+	}
+#endif
+	for (; i < size; ++i)
+	{
+		if (data[i] == a || data[i] == b) return i;
+	}
+	return size;
+}
+
+size_t HttpMessage::FindHeadEnd(const uint8_t* data, size_t size)
+{
+	// The blank line is "\r\n\r\n", bare "\n\n" is accepted as well
+	size_t position = 0;
+	while (position < size)
+	{
+		const size_t lineFeed = position + Find(data + position, size - position, '\n');
+		if (lineFeed >= size) return 0;
+		if (lineFeed + 1 < size && data[lineFeed + 1] == '\n') return lineFeed + 2;
+		if (lineFeed + 2 < size && data[lineFeed + 1] == '\r' && data[lineFeed + 2] == '\n') return lineFeed + 3;
+		position = lineFeed + 1;
+	}
+	return 0;
+}
+
+bool HttpMessage::IsRequestStart(const uint8_t* data, size_t size)
+{
+	static constexpr std::string_view methods[] = { "GET ", "POST ", "PUT ", "HEAD ", "DELETE ", "OPTIONS ", "PATCH ", "CONNECT ", "TRACE " };
+	if (size == 0) return false;
+	const std::string_view text = View(data, size);
+	for (std::string_view method : methods)
+	{
+		if (method.substr(0, text.size()) == text.substr(0, method.size())) return true;
+	}
+	return false;
+}
+
+bool HttpMessage::IsResponseStart(const uint8_t* data, size_t size)
+{
+	return size >= 8 && std::memcmp(data, "HTTP/1.", 7) == 0;
+}
+
+bool HttpMessage::ParseRequest(const uint8_t* data, size_t size, HttpRequestHead& head)
+{
+	std::string_view version;
+	if (!SplitFirstLine(FirstLine(data, size), head.method, head.path, version) || version.substr(0, 7) != "HTTP/1.")
+	{
+		return false;
+	}
+
+	// Requests through a proxy carry the host in the target
+	if (head.path.substr(0, 7) == "http://")
+	{
+		const std::string_view authority = head.path.substr(7);
+		const size_t slash = authority.find('/');
+		head.host = authority.substr(0, slash);
+		head.path = slash == std::string_view::npos ? std::string_view("/") : authority.substr(slash);
+	}
+
+	ForEachHeader(data, size, [&head](std::string_view name, std::string_view value)
+	{
+		if (head.host.empty() && EqualsIgnoreCase(name, "Host")) head.host = value;
+		else if (EqualsIgnoreCase(name, "Content-Length")) head.contentLength = ParseLength(value);
+		else if (EqualsIgnoreCase(name, "Transfer-Encoding")) head.chunked = ContainsIgnoreCase(value, "chunked");
+	});
+	return true;
+}
+
+bool HttpMessage::ParseResponse(const uint8_t* data, size_t size, HttpResponseHead& head)
+{
+	std::string_view version;
+	std::string_view status;
+	if (!SplitFirstLine(FirstLine(data, size), version, status, head.reason) || version.substr(0, 7) != "HTTP/1." || status.size() != 3)
+	{
+		return false;
+	}
+	for (char c : status)
+	{
+		if (c < '0' || c > '9') return false;
+		head.status = static_cast<uint16_t>(head.status * 10 + (c - '0'));
+	}
+
+	ForEachHeader(data, size, [&head](std::string_view name, std::string_view value)
+	{
+		if (EqualsIgnoreCase(name, "Content-Length")) head.contentLength = ParseLength(value);
+		else if (EqualsIgnoreCase(name, "Transfer-Encoding")) head.chunked = ContainsIgnoreCase(value, "chunked");
+	});
+
+	// Chunked coding wins over a length, a message with neither ends with the connection
+	if (head.chunked) head.contentLength = -1;
+	head.closeDelimited = !head.chunked && head.contentLength < 0;
+	return true;
+}
+
+std::string_view HttpMessage::FirstLine(const uint8_t* data, size_t size)
+{
+	return Trim(View(data, Find(data, size, '\n')));
+}
+
+const char* HttpMessage::StatusClassName(uint16_t status)
+{
+	switch (status / 100)
+	{
+		case 1: return "1xx";
+		case 2: return "2xx";
+		case 3: return "3xx";
+		case 4: return "4xx";
+		case 5: return "5xx";
+		default: return "Other";
+	}
+}
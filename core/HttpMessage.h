@@ -0,0 +1,55 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Request line and the headers the trackers need. Views point into the parsed buffer.
+struct HttpRequestHead
+{
+	std::string_view method;
+	std::string_view path;
+	std::string_view host;
+	int64_t contentLength = -1; // -1 when absent
+	bool chunked = false;
+};
+
+struct HttpResponseHead
+{
+	uint16_t status = 0;
+	std::string_view reason;
+	int64_t contentLength = -1; // -1 when absent
+	bool chunked = false;
+	bool closeDelimited = false; // Body runs until the connection closes
+};
+
+// HTTP/1.x message head parsing. Heads are scanned with a vectorised search for the
+// delimiters, LF and ':', with a scalar fallback on targets without SSE2.
+class HttpMessage
+{
+public:
+	static constexpr size_t maxHeadSize = 16 * 1024;
+
+	// Position of the first byte equal to a or b, or size when there is none
+	static size_t FindEither(const uint8_t* data, size_t size, uint8_t a, uint8_t b);
+	static size_t Find(const uint8_t* data, size_t size, uint8_t byte) { return FindEither(data, size, byte, byte); }
+
+	// Length of the head including the blank line, or 0 when the blank line has not arrived
+	static size_t FindHeadEnd(const uint8_t* data, size_t size);
+
+	// Cheap checks on the first bytes of a stream, used to skip everything that is not HTTP.
+	// Fewer bytes than a method token pass when they are a prefix of one.
+	static bool IsRequestStart(const uint8_t* data, size_t size);
+	static bool IsResponseStart(const uint8_t* data, size_t size);
+
+	// Parse a complete head as returned by FindHeadEnd
+	static bool ParseRequest(const uint8_t* data, size_t size, HttpRequestHead& head);
+	static bool ParseResponse(const uint8_t* data, size_t size, HttpResponseHead& head);
+
+	// First line of a head for display, without the line ending
+	static std::string_view FirstLine(const uint8_t* data, size_t size);
+
+	static const char* StatusClassName(uint16_t status); // "2xx" and so on
+
+	// ASCII only, header names and host names are compared case-insensitively
+	static char ToLower(char c) { return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c; }
+};
@@ -0,0 +1,382 @@
+#include "HttpTracker.h"
+#include "TableTrim.h"
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+	constexpr size_t maxConnections = 4096;
+	constexpr size_t maxPipelined = 32; // Outstanding requests per connection
+	constexpr size_t maxEndpoints = 1024;
+	constexpr size_t maxHostLength = 255;
+	constexpr size_t maxPathLength = 256;
+
+	int HexValue(uint8_t c)
+	{
+		if (c >= '0' && c <= '9') return c - '0';
+		if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+		if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+		return -1;
+	}
+
+	uint32_t ElapsedUs(int64_t fromUs, int64_t toUs)
+	{
+		return static_cast<uint32_t>(std::clamp<int64_t>(toUs - fromUs, 0, std::numeric_limits<uint32_t>::max()));
+	}
+}
+
+void HttpTracker::BodyReader::Start(Mode bodyMode, uint64_t length)
+{
+	mode = (bodyMode == Mode::Length && length == 0) ? Mode::None : bodyMode;
+	remaining = bodyMode == Mode::Length ? length : 0;
+	chunkState = ChunkState::Size;
+	lineLength = 0;
+	sizeDigits = false;
+}
+
+size_t HttpTracker::BodyReader::Consume(const uint8_t* data, size_t size)
+{
+	switch (mode)
+	{
+		case Mode::None:
+			return 0;
+		case Mode::UntilClose:
+			return size;
+		case Mode::Length:
+		{
+			const size_t used = static_cast<size_t>(std::min<uint64_t>(remaining, size));
+			remaining -= used;
+			if (remaining == 0) mode = Mode::None;
+			return used;
+		}
+		case Mode::Chunked:
+			break;
+	}
+
+	size_t i = 0;
+	while (i < size && mode == Mode::Chunked)
+	{
+		const uint8_t c = data[i];
+		switch (chunkState)
+		{
+			case ChunkState::Size:
+			{
+				const int digit = HexValue(c);
+				if (digit >= 0 && remaining < (uint64_t{ 1 } << 56))
+				{
+					remaining = remaining * 16 + digit;
+					sizeDigits = true;
+					++i;
+				}
+				else if (c == ';' || c == ' ' || c == '\t')
+				{
+					chunkState = ChunkState::Extension;
+				}
+				else if (c == '\r')
+				{
+					++i;
+				}
+				else if (c == '\n' && sizeDigits)
+				{
+					++i;
+					sizeDigits = false;
+					chunkState = remaining == 0 ? ChunkState::Trailer : ChunkState::Data;
+				}
+				else
+				{
+					// Not chunked framing after all, give the bytes back to the caller
+					mode = Mode::None;
+				}
+				break;
+			}
+			case ChunkState::Extension:
+				// Chunk extensions are skipped up to the line feed, which Size then handles
+				i += HttpMessage::Find(data + i, size - i, '\n');
+				if (i < size) chunkState = ChunkState::Size;
+				break;
+			case ChunkState::Data:
+			{
+				const size_t used = static_cast<size_t>(std::min<uint64_t>(remaining, size - i));
+				i += used;
+				remaining -= used;
+				if (remaining == 0) chunkState = ChunkState::DataEnd;
+				break;
+			}
+			case ChunkState::DataEnd:
+				if (c == '\n') chunkState = ChunkState::Size;
+				++i;
+				break;
+			case ChunkState::Trailer:
+				++i;
+				if (c == '\n')
+				{
+					if (lineLength == 0) mode = Mode::None;
+					lineLength = 0;
+				}
+				else if (c != '\r')
+				{
+					++lineLength;
+				}
+				break;
+		}
+	}
+	return i;
+}
+
+size_t HttpTracker::EndpointKeyHash::operator()(const EndpointKey& key) const
+{
+	return std::hash<std::string>{}(key.host) ^ (std::hash<std::string>{}(key.path) * 31);
+}
+
+void HttpTracker::OnStreamEvent(const TcpStreamEvent& event)
+{
+	// Only a client stream that opens with a request method starts tracking a connection
+	const bool streamStart = event.type == TcpStreamEventType::Data && event.fromClient && event.streamOffset == 0;
+	if (streamStart && !HttpMessage::IsRequestStart(event.data, event.size)) return;
+	if (!streamStart && trackedConnections.load(std::memory_order_relaxed) == 0) return;
+
+	Stripe& stripe = stripes[event.connectionId % stripeCount];
+	std::scoped_lock lock(stripe.mutex);
+
+	auto it = stripe.connections.find(event.connectionId);
+	if (streamStart && it == stripe.connections.end())
+	{
+		if (trackedConnections.load(std::memory_order_relaxed) >= maxConnections) return;
+		it = stripe.connections.emplace(event.connectionId, Connection{}).first;
+		trackedConnections.fetch_add(1, std::memory_order_relaxed);
+	}
+	if (it == stripe.connections.end()) return;
+
+	Connection& conn = it->second;
+	bool keep = false;
+	switch (event.type)
+	{
+		case TcpStreamEventType::Data:
+			keep = ProcessData(conn, event);
+			break;
+		case TcpStreamEventType::Gap:
+			// Message boundaries are lost, requests and responses can no longer be paired
+			break;
+		case TcpStreamEventType::Closed:
+		{
+			const Direction& server = conn.directions[1];
+			if (server.body.UntilClose())
+			{
+				Complete(conn, server.lastDataUs);
+			}
+			break;
+		}
+	}
+
+	if (!keep)
+	{
+		stripe.connections.erase(it);
+		trackedConnections.fetch_sub(1, std::memory_order_relaxed);
+	}
+}
+
+bool HttpTracker::ProcessData(Connection& conn, const TcpStreamEvent& event)
+{
+	const bool fromClient = event.fromClient;
+	Direction& dir = conn.directions[fromClient ? 0 : 1];
+	dir.lastDataUs = event.timestampUs;
+
+	auto isStart = [fromClient](const uint8_t* data, size_t size)
+	{
+		return fromClient ? HttpMessage::IsRequestStart(data, size) : HttpMessage::IsResponseStart(data, size);
+	};
+	constexpr size_t startCheckSize = 8; // Enough for the longest method and "HTTP/1.x"
+
+	size_t position = 0;
+	while (position < event.size)
+	{
+		const uint8_t* data = event.data + position;
+		const size_t size = event.size - position;
+
+		if (dir.body.Active())
+		{
+			position += dir.body.Consume(data, size);
+			if (!dir.body.Active() && !fromClient)
+			{
+				Complete(conn, event.timestampUs);
+			}
+			continue;
+		}
+
+		if (dir.head.empty())
+		{
+			// Heads nearly always arrive whole and are parsed in place
+			if (size >= startCheckSize && !isStart(data, size)) return false;
+
+			const size_t headEnd = HttpMessage::FindHeadEnd(data, size);
+			if (headEnd == 0)
+			{
+				if (size >= HttpMessage::maxHeadSize) return false;
+				dir.head.assign(data, data + size);
+				dir.headStartUs = event.timestampUs;
+				return true;
+			}
+			if (!OnHead(conn, event, data, headEnd, event.timestampUs)) return false;
+			position += headEnd;
+			continue;
+		}
+
+		// Continue a head split over segments
+		const size_t previous = dir.head.size();
+		const size_t toCopy = std::min(size, HttpMessage::maxHeadSize - previous);
+		dir.head.insert(dir.head.end(), data, data + toCopy);
+		if (dir.head.size() >= startCheckSize && !isStart(dir.head.data(), dir.head.size())) return false;
+
+		const size_t headEnd = HttpMessage::FindHeadEnd(dir.head.data(), dir.head.size());
+		if (headEnd == 0)
+		{
+			return dir.head.size() < HttpMessage::maxHeadSize;
+		}
+		const bool ok = OnHead(conn, event, dir.head.data(), headEnd, dir.headStartUs);
+		dir.head.clear();
+		if (!ok) return false;
+		position += headEnd - previous;
+	}
+	return true;
+}
+
+bool HttpTracker::OnHead(Connection& conn, const TcpStreamEvent& event, const uint8_t* data, size_t size, int64_t startUs)
+{
+	using Mode = BodyReader::Mode;
+
+	if (event.fromClient)
+	{
+		HttpRequestHead head;
+		if (!HttpMessage::ParseRequest(data, size, head) || head.method == "CONNECT" || conn.pending.size() >= maxPipelined)
+		{
+			return false;
+		}
+
+		PendingRequest request;
+		if (head.host.empty())
+		{
+			request.host = event.serverAddr.ToString() + ":" + std::to_string(event.serverPort);
+		}
+		else
+		{
+			request.host.assign(head.host.substr(0, maxHostLength));
+			std::transform(request.host.begin(), request.host.end(), request.host.begin(), HttpMessage::ToLower);
+		}
+		// Query strings would give every request its own entry
+		request.path.assign(head.path.substr(0, std::min(head.path.find('?'), maxPathLength)));
+		request.sentUs = startUs;
+		request.head = head.method == "HEAD";
+
+		conn.directions[0].body.Start(head.chunked ? Mode::Chunked : Mode::Length, head.contentLength > 0 ? head.contentLength : 0);
+		CountRequest(request);
+		conn.pending.push_back(std::move(request));
+		return true;
+	}
+
+	HttpResponseHead head;
+	if (!HttpMessage::ParseResponse(data, size, head) || head.status == 101)
+	{
+		return false; // Not HTTP, or switching to another protocol
+	}
+	if (head.status < 200)
+	{
+		return true; // Interim response, the final one follows
+	}
+
+	Direction& dir = conn.directions[1];
+	if (conn.pending.empty())
+	{
+		unmatchedResponses.fetch_add(1, std::memory_order_relaxed);
+		conn.readingResponse = false;
+	}
+	else
+	{
+		conn.current = std::move(conn.pending.front());
+		conn.pending.pop_front();
+		conn.readingResponse = true;
+		conn.status = head.status;
+		conn.firstByteUs = startUs;
+	}
+
+	// Bodies are skipped by their framing so the next response on the connection is found
+	const bool noBody = (conn.readingResponse && conn.current.head) || head.status == 204 || head.status == 304;
+	if (noBody) dir.body.Start(Mode::None, 0);
+	else if (head.chunked) dir.body.Start(Mode::Chunked, 0);
+	else if (head.closeDelimited) dir.body.Start(Mode::UntilClose, 0);
+	else dir.body.Start(Mode::Length, static_cast<uint64_t>(head.contentLength));
+
+	if (!dir.body.Active())
+	{
+		Complete(conn, event.timestampUs);
+	}
+	return true;
+}
+
+void HttpTracker::Complete(Connection& conn, int64_t endUs)
+{
+	if (!conn.readingResponse) return;
+	conn.readingResponse = false;
+
+	const uint32_t firstByteUs = ElapsedUs(conn.current.sentUs, conn.firstByteUs);
+	const uint32_t totalUs = ElapsedUs(conn.current.sentUs, endUs);
+	const size_t statusClass = conn.status / 100 - 1;
+
+	std::scoped_lock lock(statsMutex);
+	for (HttpCounters* counters : { &EndpointCounters(conn.current.host, conn.current.path), &totals })
+	{
+		++counters->responses;
+		if (statusClass < counters->statusClasses.size()) ++counters->statusClasses[statusClass];
+		counters->firstByte.Add(firstByteUs);
+		counters->total.Add(totalUs);
+	}
+}
+
+void HttpTracker::CountRequest(const PendingRequest& request)
+{
+	std::scoped_lock lock(statsMutex);
+	++EndpointCounters(request.host, request.path).requests;
+	++totals.requests;
+}
+
+HttpCounters& HttpTracker::EndpointCounters(const std::string& host, const std::string& path)
+{
+	EndpointKey key{ host, path };
+	auto it = endpoints.find(key);
+	if (it != endpoints.end()) return it->second;
+
+	TrimLeastCounted(endpoints, maxEndpoints, [](const HttpCounters& counters) { return counters.requests; });
+	return endpoints.emplace(std::move(key), HttpCounters{}).first->second;
+}
+
+std::vector<HttpEndpointStats> HttpTracker::GetEndpointStats() const
+{
+	std::scoped_lock lock(statsMutex);
+	std::vector<HttpEndpointStats> result;
+	result.reserve(endpoints.size());
+	for (const auto& [key, counters] : endpoints)
+	{
+		result.push_back({ key.host, key.path, counters });
+	}
+	return result;
+}
+
+HttpCounters HttpTracker::GetTotals() const
+{
+	std::scoped_lock lock(statsMutex);
+	return totals;
+}
+
+void HttpTracker::Clear()
+{
+	for (Stripe& stripe : stripes)
+	{
+		std::scoped_lock lock(stripe.mutex);
+		trackedConnections.fetch_sub(stripe.connections.size(), std::memory_order_relaxed);
+		stripe.connections.clear();
+	}
+
+	std::scoped_lock lock(statsMutex);
+	endpoints.clear();
+	totals = {};
+	unmatchedResponses.store(0);
+}
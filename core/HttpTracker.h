@@ -0,0 +1,145 @@
+#pragma once
+#include "HttpMessage.h"
+#include "LatencyHistogram.h"
+#include "TcpReassembler.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct HttpCounters
+{
+	uint64_t requests = 0;
+	uint64_t responses = 0; // Matched to a request
+	std::array<uint64_t, 5> statusClasses{}; // 1xx to 5xx
+	LatencyHistogram firstByte; // Request sent to first response byte
+	LatencyHistogram total; // Request sent to last response byte
+
+	uint64_t Errors() const { return statusClasses[3] + statusClasses[4]; }
+};
+
+struct HttpEndpointStats
+{
+	std::string host;
+	std::string path; // Without the query string
+	HttpCounters counters;
+};
+
+// Stream sink that decodes HTTP/1.x requests and responses from the reassembled TCP streams,
+// matches each response to the oldest outstanding request on its connection and keeps
+// time-to-first-byte and total-time statistics per host and path. Streams that do not open
+// with a request method are dropped on their first segment. The endpoint table is bounded
+// and keeps the most requested entries.
+class HttpTracker
+{
+public:
+	// Reassembly worker threads
+	void OnStreamEvent(const TcpStreamEvent& event);
+
+	std::vector<HttpEndpointStats> GetEndpointStats() const;
+	HttpCounters GetTotals() const;
+	size_t GetConnectionCount() const { return trackedConnections.load(); }
+	uint64_t GetUnmatchedResponses() const { return unmatchedResponses.load(); }
+	void Clear();
+
+private:
+	// Skips a message body of either framing, chunked bodies are followed across events
+	class BodyReader
+	{
+	public:
+		enum class Mode : uint8_t
+		{
+			None,
+			Length,
+			Chunked,
+			UntilClose
+		};
+
+		void Start(Mode bodyMode, uint64_t length);
+		bool Active() const { return mode != Mode::None; }
+		bool UntilClose() const { return mode == Mode::UntilClose; }
+		size_t Consume(const uint8_t* data, size_t size); // Bytes used, the body is done once inactive
+
+	private:
+		enum class ChunkState : uint8_t
+		{
+			Size,
+			Extension,
+			Data,
+			DataEnd,
+			Trailer
+		};
+
+		Mode mode = Mode::None;
+		ChunkState chunkState = ChunkState::Size;
+		uint64_t remaining = 0;
+		size_t lineLength = 0; // Trailer lines, an empty one ends the body
+		bool sizeDigits = false;
+	};
+
+	struct PendingRequest
+	{
+		std::string host;
+		std::string path;
+		int64_t sentUs = 0;
+		bool head = false; // HEAD responses have no body
+	};
+
+	struct Direction
+	{
+		std::vector<uint8_t> head; // Partial message head
+		int64_t headStartUs = 0;
+		BodyReader body;
+		int64_t lastDataUs = 0;
+	};
+
+	struct Connection
+	{
+		Direction directions[2]; // Client, server
+		std::deque<PendingRequest> pending;
+		PendingRequest current; // Request whose response body is being read
+		bool readingResponse = false;
+		uint16_t status = 0;
+		int64_t firstByteUs = 0;
+	};
+
+	struct Stripe
+	{
+		std::mutex mutex;
+		std::unordered_map<uint64_t, Connection> connections; // By reassembler connection ID
+	};
+
+	struct EndpointKey
+	{
+		std::string host;
+		std::string path;
+
+		bool operator==(const EndpointKey&) const = default;
+	};
+
+	struct EndpointKeyHash
+	{
+		size_t operator()(const EndpointKey& key) const;
+	};
+
+	// Connections are spread over stripes so the reassembly workers rarely share a lock
+	static constexpr size_t stripeCount = 16;
+	std::array<Stripe, stripeCount> stripes;
+	std::atomic<size_t> trackedConnections{ 0 };
+	std::atomic<uint64_t> unmatchedResponses{ 0 };
+
+	mutable std::mutex statsMutex; // Guards the tables below, taken once per request and response
+	std::unordered_map<EndpointKey, HttpCounters, EndpointKeyHash> endpoints;
+	HttpCounters totals;
+
+	// Both return false when the connection can no longer be followed
+	bool ProcessData(Connection& conn, const TcpStreamEvent& event);
+	bool OnHead(Connection& conn, const TcpStreamEvent& event, const uint8_t* data, size_t size, int64_t startUs);
+	void Complete(Connection& conn, int64_t endUs);
+	void CountRequest(const PendingRequest& request);
+	HttpCounters& EndpointCounters(const std::string& host, const std::string& path); // Requires statsMutex
+};
@@ -0,0 +1,59 @@
+#include "HyperLogLog.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+uint8_t HyperLogLog::Rank(uint64_t hash)
+{
+	// The guard bit caps the rank when the remaining bits are all zero
+	const uint64_t rest = (hash << precision) | (uint64_t{ 1 } << (precision - 1));
+	return static_cast<uint8_t>(std::countl_zero(rest) + 1);
+}
+
+void HyperLogLog::HashKeys(const uint64_t* keys, uint64_t* hashes, size_t n)
+{
+	for (size_t i = 0; i < n; ++i)
+	{
+		uint64_t h = keys[i];
+		h ^= h >> 33;
+		h *= 0xFF51AFD7ED558CCDull;
+		h ^= h >> 33;
+		h *= 0xC4CEB9FE1A85EC53ull;
+		hashes[i] = h ^ (h >> 33);
+	}
+}
+
+void HyperLogLog::Add(uint64_t hash)
+{
+	SetRegister(RegisterIndex(hash), Rank(hash));
+}
+
+void HyperLogLog::Merge(const HyperLogLog& other)
+{
+	for (size_t i = 0; i < registerCount; ++i)
+	{
+		registers[i] = std::max(registers[i], other.registers[i]);
+	}
+}
+
+double HyperLogLog::Estimate() const
+{
+	double sum = 0.0;
+	size_t zeros = 0;
+	for (uint8_t rank : registers)
+	{
+		sum += std::ldexp(1.0, -static_cast<int>(rank));
+		zeros += rank == 0;
+	}
+
+	const double m = static_cast<double>(registerCount);
+	const double alpha = 0.7213 / (1.0 + 1.079 / m);
+	const double estimate = alpha * m * m / sum;
+
+	// Linear counting is more accurate while many registers are still empty
+	if (estimate <= 2.5 * m && zeros != 0)
+	{
+		return m * std::log(m / static_cast<double>(zeros));
+	}
+	return estimate;
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// HyperLogLog distinct counter with 2^precision one-byte registers. Sketches of the same
+// precision merge by taking the larger register, so counts over several intervals come from
+// merging the per-interval sketches. The standard error is about 1.04 / sqrt(registers).
+class HyperLogLog
+{
+public:
+	static constexpr unsigned precision = 10;
+	static constexpr size_t registerCount = size_t{ 1 } << precision;
+
+	// Register index from the top bits of a 64-bit hash, rank from the leading zeros of the rest
+	static size_t RegisterIndex(uint64_t hash) { return static_cast<size_t>(hash >> (64 - precision)); }
+	static uint8_t Rank(uint64_t hash);
+
+	// Mixes n 64-bit keys into hashes. A plain loop over independent lanes, so the compiler
+	// can vectorise it where the target has 64-bit multiplies.
+	static void HashKeys(const uint64_t* keys, uint64_t* hashes, size_t n);
+
+	void Add(uint64_t hash);
+	void SetRegister(size_t index, uint8_t rank) { if (rank > registers[index]) registers[index] = rank; }
+	void Merge(const HyperLogLog& other);
+	double Estimate() const;
+	void Clear() { registers.fill(0); }
+
+private:
+	std::array<uint8_t, registerCount> registers{};
+};
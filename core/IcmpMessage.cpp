@@ -0,0 +1,175 @@
+#include "IcmpMessage.h"
+#include <iterator>
+
+namespace
+{
+	uint32_t ReadU32(const uint8_t* data)
+	{
+		return (static_cast<uint32_t>(data[0]) << 24) | (static_cast<uint32_t>(data[1]) << 16) | (static_cast<uint32_t>(data[2]) << 8) | data[3];
+	}
+
+	uint16_t ReadU16(const uint8_t* data)
+	{
+		return static_cast<uint16_t>((data[0] << 8) | data[1]);
+	}
+}
+
+IcmpMessage::Kind IcmpMessage::Classify(bool v6, uint8_t type)
+{
+	if (v6)
+	{
+		switch (type)
+		{
+			case 128: return Kind::EchoRequest;
+			case 129: return Kind::EchoReply;
+			case 1:
+			case 2: return Kind::Unreachable;
+			case 3: return Kind::TimeExceeded;
+			default: return Kind::Other;
+		}
+	}
+
+	switch (type)
+	{
+		case 8: return Kind::EchoRequest;
+		case 0: return Kind::EchoReply;
+		case 3: return Kind::Unreachable;
+		case 11: return Kind::TimeExceeded;
+		default: return Kind::Other;
+	}
+}
+
+bool IcmpMessage::CarriesDatagram(bool v6, uint8_t type)
+{
+	if (v6)
+	{
+		return type >= 1 && type <= 4;
+	}
+	return type == 3 || type == 4 || type == 5 || type == 11 || type == 12;
+}
+
+const char* IcmpMessage::TypeName(bool v6, uint8_t type)
+{
+	if (v6)
+	{
+		switch (type)
+		{
+			case 1: return "Destination Unreachable";
+			case 2: return "Packet Too Big";
+			case 3: return "Time Exceeded";
+			case 4: return "Parameter Problem";
+			case 128: return "Echo Request";
+			case 129: return "Echo Reply";
+			case 133: return "Router Solicitation";
+			case 134: return "Router Advertisement";
+			case 135: return "Neighbor Solicitation";
+			case 136: return "Neighbor Advertisement";
+			case 137: return "Redirect";
+			case 143: return "Multicast Listener Report";
+			default: return "Unknown";
+		}
+	}
+
+	switch (type)
+	{
+		case 0: return "Echo Reply";
+		case 3: return "Destination Unreachable";
+		case 4: return "Source Quench";
+		case 5: return "Redirect";
+		case 8: return "Echo Request";
+		case 9: return "Router Advertisement";
+		case 10: return "Router Solicitation";
+		case 11: return "Time Exceeded";
+		case 12: return "Parameter Problem";
+		case 13: return "Timestamp";
+		case 14: return "Timestamp Reply";
+		default: return "Unknown";
+	}
+}
+
+const char* IcmpMessage::CodeName(bool v6, uint8_t type, uint8_t code)
+{
+	if (v6)
+	{
+		if (type == 1)
+		{
+			static const char* const names[] = { "No route", "Administratively prohibited", "Beyond scope of source address",
+				"Address unreachable", "Port unreachable", "Source address failed policy", "Reject route" };
+			return code < std::size(names) ? names[code] : nullptr;
+		}
+		if (type == 3)
+		{
+			return code == 0 ? "Hop limit exceeded" : code == 1 ? "Fragment reassembly time exceeded" : nullptr;
+		}
+		return nullptr;
+	}
+
+	if (type == 3)
+	{
+		static const char* const names[] = { "Network unreachable", "Host unreachable", "Protocol unreachable", "Port unreachable",
+			"Fragmentation needed", "Source route failed", "Network unknown", "Host unknown", "Source host isolated",
+			"Network prohibited", "Host prohibited", "Network unreachable for TOS", "Host unreachable for TOS",
+			"Administratively prohibited", "Host precedence violation", "Precedence cutoff" };
+		return code < std::size(names) ? names[code] : nullptr;
+	}
+	if (type == 11)
+	{
+		return code == 0 ? "TTL exceeded in transit" : code == 1 ? "Fragment reassembly time exceeded" : nullptr;
+	}
+	if (type == 5)
+	{
+		static const char* const names[] = { "For network", "For host", "For TOS and network", "For TOS and host" };
+		return code < std::size(names) ? names[code] : nullptr;
+	}
+	return nullptr;
+}
+
+bool IcmpMessage::ReadEmbedded(const uint8_t* data, size_t size, bool v6, IcmpEmbeddedDatagram& datagram)
+{
+	size_t transport = 0;
+	if (v6)
+	{
+		if (size < 40 || (data[0] >> 4) != 6) return false;
+		datagram.protocol = data[6];
+		datagram.srcAddr = IpAddress::FromIPv6(data + 8);
+		datagram.dstAddr = IpAddress::FromIPv6(data + 24);
+		transport = 40;
+	}
+	else
+	{
+		const size_t headerLength = (data[0] & 0x0F) * 4u;
+		if (size < 20 || (data[0] >> 4) != 4 || headerLength < 20 || size < headerLength) return false;
+		datagram.protocol = data[9];
+		datagram.srcAddr = IpAddress::FromIPv4(ReadU32(data + 12));
+		datagram.dstAddr = IpAddress::FromIPv4(ReadU32(data + 16));
+		transport = headerLength;
+	}
+
+	// Errors quote at least 8 bytes of the transport header, enough for the ports
+	datagram.hasPorts = (datagram.protocol == 6 || datagram.protocol == 17) && size >= transport + 4;
+	if (datagram.hasPorts)
+	{
+		datagram.srcPort = ReadU16(data + transport);
+		datagram.dstPort = ReadU16(data + transport + 2);
+	}
+	return true;
+}
+
+std::string IcmpMessage::FormatEmbedded(const IcmpEmbeddedDatagram& datagram)
+{
+	std::string protocol;
+	switch (datagram.protocol)
+	{
+		case 6: protocol = "TCP"; break;
+		case 17: protocol = "UDP"; break;
+		case protocolV4: protocol = "ICMP"; break;
+		case protocolV6: protocol = "ICMPv6"; break;
+		default: protocol = "Protocol " + std::to_string(datagram.protocol); break;
+	}
+
+	if (datagram.hasPorts)
+	{
+		return protocol + " " + datagram.srcAddr.ToEndpointString(datagram.srcPort) + " -> " + datagram.dstAddr.ToEndpointString(datagram.dstPort);
+	}
+	return protocol + " " + datagram.srcAddr.ToString() + " -> " + datagram.dstAddr.ToString();
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include "IpAddress.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Header of the datagram quoted by an ICMP error: the IP header plus the first transport bytes
+struct IcmpEmbeddedDatagram
+{
+	IpAddress srcAddr;
+	IpAddress dstAddr;
+	uint8_t protocol = 0;
+	uint16_t srcPort = 0;
+	uint16_t dstPort = 0;
+	bool hasPorts = false;
+};
+
+// ICMP and ICMPv6 type and code tables. Both share the 8-byte header layout, the
+// family only changes the numbering.
+class IcmpMessage
+{
+public:
+	static constexpr uint8_t protocolV4 = 1;
+	static constexpr uint8_t protocolV6 = 58;
+	static constexpr size_t headerSize = 8;
+
+	// Classification shared by both families, for counters
+	enum class Kind : uint8_t
+	{
+		EchoRequest,
+		EchoReply,
+		Unreachable, // Including ICMPv6 Packet Too Big
+		TimeExceeded,
+		Other
+	};
+
+	static Kind Classify(bool v6, uint8_t type);
+	static bool IsEcho(bool v6, uint8_t type) { const Kind kind = Classify(v6, type); return kind == Kind::EchoRequest || kind == Kind::EchoReply; }
+	static bool CarriesDatagram(bool v6, uint8_t type); // Error messages quote the offending datagram
+
+	static const char* TypeName(bool v6, uint8_t type);
+	static const char* CodeName(bool v6, uint8_t type, uint8_t code); // nullptr when the code has no name
+
+	// data points at the quoted datagram, right after the ICMP header
+	static bool ReadEmbedded(const uint8_t* data, size_t size, bool v6, IcmpEmbeddedDatagram& datagram);
+	static std::string FormatEmbedded(const IcmpEmbeddedDatagram& datagram); // e.g. "UDP 10.0.0.2:5353 -> 10.0.0.1:53"
+};
@@ -0,0 +1,65 @@
+#include "IpAddress.h"
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#endif
+#include <cstdio>
+
+IpAddress IpAddress::FromIPv4(uint32_t address)
+{
+	IpAddress ip;
+	ip.version = 4;
+	ip.low = address;
+	return ip;
+}
+
+IpAddress IpAddress::FromIPv6(const uint8_t* bytes)
+{
+	IpAddress ip;
+	ip.version = 6;
+	for (int i = 0; i < 8; ++i)
+	{
+		ip.high = (ip.high << 8) | bytes[i];
+		ip.low = (ip.low << 8) | bytes[i + 8];
+	}
+	return ip;
+}
+
+std::string IpAddress::ToString() const
+{
+	if (version == 4)
+	{
+		const uint32_t addr = IPv4();
+		char buf[16];
+		std::snprintf(buf, sizeof(buf), "%u.%u.%u.%u", (addr >> 24) & 0xFF, (addr >> 16) & 0xFF, (addr >> 8) & 0xFF, addr & 0xFF);
+		return buf;
+	}
+
+	if (version == 6)
+	{
+		uint8_t bytes[16];
+		for (int i = 0; i < 8; ++i)
+		{
+			bytes[i] = static_cast<uint8_t>(high >> (56 - i * 8));
+			bytes[i + 8] = static_cast<uint8_t>(low >> (56 - i * 8));
+		}
+
+		char buf[INET6_ADDRSTRLEN];
+		if (inet_ntop(AF_INET6, bytes, buf, sizeof(buf)))
+		{
+			return buf;
+		}
+	}
+	return {};
+}
+
+std::string IpAddress::ToEndpointString(uint16_t port) const
+{
+	if (version == 6)
+	{
+		return "[" + ToString() + "]:" + std::to_string(port);
+	}
+	return ToString() + ":" + std::to_string(port);
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <compare>
+#include <cstdint>
+#include <string>
+
+// IPv4 or IPv6 address held as two 64-bit halves in host byte order.
+// IPv4 addresses live in the low 32 bits of low, so both families compare and hash the same way.
+struct IpAddress
+{
+	uint8_t version = 0; // 4, 6, or 0 when not set
+	uint64_t high = 0;
+	uint64_t low = 0;
+
+	static IpAddress FromIPv4(uint32_t address);
+	static IpAddress FromIPv6(const uint8_t* bytes); // 16 bytes in network order
+
+	bool IsSet() const { return version != 0; }
+	bool IsIPv4() const { return version == 4; }
+	bool IsIPv6() const { return version == 6; }
+	uint32_t IPv4() const { return static_cast<uint32_t>(low); }
+
+	std::string ToString() const;
+	std::string ToEndpointString(uint16_t port) const; // "1.2.3.4:80" or "[2001:db8::1]:80"
+
+	// Cheap mix of both halves, for hash tables and sharding
+	uint64_t Hash() const
+	{
+		uint64_t h = (high * 0x9E3779B97F4A7C15ull) ^ (low + version);
+		h ^= h >> 29;
+		h *= 0xBF58476D1CE4E5B9ull;
+		return h ^ (h >> 32);
+	}
+
+	auto operator<=>(const IpAddress&) const = default;
+};
@@ -0,0 +1,294 @@
+#include "IpDefragmenter.h"
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+	constexpr size_t maxDatagrams = 1024;
+	constexpr size_t maxHeldBytes = 4u << 20;
+	constexpr uint8_t maxFragmentsPerDatagram = 128; // Stops tiny-fragment floods from growing the range list
+	constexpr uint32_t maxPayloadLength = 65535 - 20; // Largest IPv4 payload with a minimal header
+	constexpr int64_t fragmentTimeoutUs = 30ll * 1000 * 1000;
+	constexpr int64_t expiryIntervalUs = 1000ll * 1000;
+
+	uint16_t ReadU16(const uint8_t* p)
+	{
+		return static_cast<uint16_t>((p[0] << 8) | p[1]);
+	}
+
+	void WriteU16(uint8_t* p, uint16_t value)
+	{
+		p[0] = static_cast<uint8_t>(value >> 8);
+		p[1] = static_cast<uint8_t>(value);
+	}
+
+	uint16_t HeaderChecksum(const uint8_t* header, size_t length)
+	{
+		uint32_t sum = 0;
+		for (size_t i = 0; i + 1 < length; i += 2)
+		{
+			sum += ReadU16(header + i);
+		}
+		while (sum >> 16)
+		{
+			sum = (sum & 0xFFFF) + (sum >> 16);
+		}
+		return static_cast<uint16_t>(~sum);
+	}
+}
+
+size_t IpDefragmenter::DatagramKeyHash::operator()(const DatagramKey& key) const
+{
+	const uint64_t rest = (static_cast<uint64_t>(key.id) << 24) | (static_cast<uint64_t>(key.vlan) << 8) | key.protocol;
+	return static_cast<size_t>(key.srcAddr.Hash() ^ (key.dstAddr.Hash() * 31) ^ (rest * 0x9E3779B97F4A7C15ull));
+}
+
+uint8_t IpDefragmenter::AddFragment(const uint8_t* data, size_t size, const PacketLayers& layers, int64_t timestampUs, std::vector<uint8_t>& frame)
+{
+	if (timestampUs - lastExpiryUs >= expiryIntervalUs)
+	{
+		Expire(timestampUs);
+		lastExpiryUs = timestampUs;
+	}
+
+	// Tunnelled fragments would need the outer headers rewritten as well, they are left alone
+	const size_t ipOffset = layers.networkOffset;
+	if (!layers.IsFragment() || layers.tunnel != PacketLayers::Tunnel::None || size < ipOffset + 20) return 0;
+
+	const uint8_t* ip = data + ipOffset;
+	const size_t ipHeaderLen = (ip[0] & 0x0F) * 4u;
+	if ((ip[0] >> 4) != 4 || ipHeaderLen < 20 || size < ipOffset + ipHeaderLen) return 0;
+
+	fragments.fetch_add(1, std::memory_order_relaxed);
+
+	DatagramKey key;
+	key.srcAddr = layers.srcAddr;
+	key.dstAddr = layers.dstAddr;
+	key.id = ReadU16(ip + 4);
+	key.vlan = layers.OuterVlan();
+	key.protocol = ip[9];
+
+	const uint16_t fragmentField = ReadU16(ip + 6);
+	const uint32_t start = (fragmentField & 0x1FFFu) * 8;
+	const bool moreFragments = (fragmentField & 0x2000) != 0;
+	const size_t totalLength = ReadU16(ip + 2);
+	const uint32_t length = totalLength > ipHeaderLen ? static_cast<uint32_t>(totalLength - ipHeaderLen) : 0;
+	const uint32_t end = start + length;
+
+	auto it = datagrams.find(key);
+
+	// A fragment cut by the snap length, a misaligned middle fragment or one reaching past
+	// the largest datagram can never produce a valid datagram
+	if (length == 0 || ipOffset + totalLength > size || (moreFragments && length % 8 != 0) || end > maxPayloadLength)
+	{
+		dropped.fetch_add(1, std::memory_order_relaxed);
+		if (it != datagrams.end()) Erase(it);
+		PublishSizes();
+		return 0;
+	}
+
+	if (it == datagrams.end())
+	{
+		while (datagrams.size() >= maxDatagrams)
+		{
+			if (!EvictOldest(nullptr)) break;
+		}
+		it = datagrams.emplace(key, Datagram{}).first;
+		it->second.firstSeenUs = timestampUs;
+	}
+
+	Datagram& datagram = it->second;
+	const size_t bytesBefore = datagram.headers.size() + datagram.payload.size();
+
+	// The last fragment fixes the length, nothing may end after it
+	if ((!moreFragments && (datagram.payload.size() > end || (datagram.haveLast && datagram.totalLength != end))) ||
+		(datagram.haveLast && end > datagram.totalLength) ||
+		datagram.fragmentCount >= maxFragmentsPerDatagram)
+	{
+		dropped.fetch_add(1, std::memory_order_relaxed);
+		Erase(it);
+		PublishSizes();
+		return 0;
+	}
+
+	// Every fragment may grow the datagram, later ones by up to 64 KB, so the byte limit is
+	// checked before each growth. Older datagrams make room first, then this one is dropped.
+	const size_t growth = (end > datagram.payload.size() ? end - datagram.payload.size() : 0) +
+		(start == 0 && datagram.headers.empty() ? ipOffset + ipHeaderLen : 0);
+	while (heldBytes + growth > maxHeldBytes)
+	{
+		if (!EvictOldest(&datagram))
+		{
+			dropped.fetch_add(1, std::memory_order_relaxed);
+			Erase(it);
+			PublishSizes();
+			return 0;
+		}
+	}
+
+	if (!Insert(datagram, start, ip + ipHeaderLen, length))
+	{
+		overlaps.fetch_add(1, std::memory_order_relaxed);
+		Erase(it);
+		PublishSizes();
+		return 0;
+	}
+
+	++datagram.fragmentCount;
+	if (!moreFragments)
+	{
+		datagram.haveLast = true;
+		datagram.totalLength = end;
+	}
+	if (start == 0 && datagram.headers.empty())
+	{
+		datagram.headers.assign(data, data + ipOffset + ipHeaderLen);
+	}
+	heldBytes += datagram.headers.size() + datagram.payload.size() - bytesBefore;
+
+	const bool complete = datagram.haveLast && !datagram.headers.empty() && datagram.ranges.size() == 1 &&
+		datagram.ranges.front().first == 0 && datagram.ranges.front().second == datagram.totalLength;
+	if (!complete)
+	{
+		PublishSizes();
+		return 0;
+	}
+
+	// Options in the first fragment's header can push the rebuilt total length past 16 bits
+	const size_t headerSize = datagram.headers.size();
+	const size_t rebuiltHeaderLen = headerSize - ipOffset;
+	if (rebuiltHeaderLen + datagram.totalLength > 0xFFFF)
+	{
+		dropped.fetch_add(1, std::memory_order_relaxed);
+		Erase(it);
+		PublishSizes();
+		return 0;
+	}
+
+	// Rebuild the frame with an unfragmented IP header so it parses like any other packet
+	frame.resize(headerSize + datagram.totalLength);
+	std::memcpy(frame.data(), datagram.headers.data(), headerSize);
+	std::memcpy(frame.data() + headerSize, datagram.payload.data(), datagram.totalLength);
+
+	uint8_t* rebuilt = frame.data() + ipOffset;
+	WriteU16(rebuilt + 2, static_cast<uint16_t>(rebuiltHeaderLen + datagram.totalLength));
+	WriteU16(rebuilt + 6, ReadU16(rebuilt + 6) & 0x4000); // Keep only DF
+	WriteU16(rebuilt + 10, 0);
+	WriteU16(rebuilt + 10, HeaderChecksum(rebuilt, rebuiltHeaderLen));
+
+	const uint8_t fragmentCount = datagram.fragmentCount;
+	reassembled.fetch_add(1, std::memory_order_relaxed);
+	Erase(it);
+	PublishSizes();
+	return fragmentCount;
+}
+
+bool IpDefragmenter::Insert(Datagram& datagram, uint32_t start, const uint8_t* bytes, uint32_t length)
+{
+	const uint32_t end = start + length;
+
+	// Bytes seen before must match, a retransmitted fragment is fine, a rewrite is not
+	for (const auto& [rangeStart, rangeEnd] : datagram.ranges)
+	{
+		const uint32_t overlapStart = std::max(start, rangeStart);
+		const uint32_t overlapEnd = std::min(end, rangeEnd);
+		if (overlapStart < overlapEnd &&
+			std::memcmp(datagram.payload.data() + overlapStart, bytes + (overlapStart - start), overlapEnd - overlapStart) != 0)
+		{
+			return false;
+		}
+	}
+
+	if (datagram.payload.size() < end)
+	{
+		datagram.payload.reserve(end); // Exactly what is counted against the byte limit
+		datagram.payload.resize(end);
+	}
+	std::memcpy(datagram.payload.data() + start, bytes, length);
+
+	// Insert the range and merge it with its neighbours
+	auto& ranges = datagram.ranges;
+	auto pos = std::lower_bound(ranges.begin(), ranges.end(), std::make_pair(start, end));
+	pos = ranges.insert(pos, { start, end });
+	if (pos != ranges.begin() && std::prev(pos)->second >= pos->first)
+	{
+		--pos;
+		pos->second = std::max(pos->second, std::next(pos)->second);
+		ranges.erase(std::next(pos));
+	}
+	while (std::next(pos) != ranges.end() && std::next(pos)->first <= pos->second)
+	{
+		pos->second = std::max(pos->second, std::next(pos)->second);
+		ranges.erase(std::next(pos));
+	}
+	return true;
+}
+
+void IpDefragmenter::Expire(int64_t nowUs)
+{
+	for (auto it = datagrams.begin(); it != datagrams.end();)
+	{
+		if (nowUs - it->second.firstSeenUs >= fragmentTimeoutUs)
+		{
+			timeouts.fetch_add(1, std::memory_order_relaxed);
+			heldBytes -= it->second.headers.size() + it->second.payload.size();
+			it = datagrams.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
+	PublishSizes();
+}
+
+bool IpDefragmenter::EvictOldest(const Datagram* keep)
+{
+	// Only reached when the table or its byte budget is full, a linear scan over at most maxDatagrams entries
+	auto oldest = datagrams.end();
+	for (auto it = datagrams.begin(); it != datagrams.end(); ++it)
+	{
+		if (&it->second != keep && (oldest == datagrams.end() || it->second.firstSeenUs < oldest->second.firstSeenUs))
+		{
+			oldest = it;
+		}
+	}
+	if (oldest == datagrams.end()) return false;
+
+	timeouts.fetch_add(1, std::memory_order_relaxed);
+	Erase(oldest);
+	return true;
+}
+
+void IpDefragmenter::Erase(std::unordered_map<DatagramKey, Datagram, DatagramKeyHash>::iterator it)
+{
+	heldBytes -= it->second.headers.size() + it->second.payload.size();
+	datagrams.erase(it);
+}
+
+void IpDefragmenter::PublishSizes()
+{
+	pendingDatagrams.store(datagrams.size(), std::memory_order_relaxed);
+	bufferedBytes.store(heldBytes, std::memory_order_relaxed);
+}
+
+void IpDefragmenter::Clear()
+{
+	datagrams.clear();
+	heldBytes = 0;
+	lastExpiryUs = 0;
+	PublishSizes();
+}
+
+IpDefragmenterStats IpDefragmenter::GetStats() const
+{
+	IpDefragmenterStats stats;
+	stats.pendingDatagrams = pendingDatagrams.load(std::memory_order_relaxed);
+	stats.bufferedBytes = bufferedBytes.load(std::memory_order_relaxed);
+	stats.fragments = fragments.load(std::memory_order_relaxed);
+	stats.reassembled = reassembled.load(std::memory_order_relaxed);
+	stats.timeouts = timeouts.load(std::memory_order_relaxed);
+	stats.overlaps = overlaps.load(std::memory_order_relaxed);
+	stats.dropped = dropped.load(std::memory_order_relaxed);
+	return stats;
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include "PacketLayers.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+struct IpDefragmenterStats
+{
+	size_t pendingDatagrams = 0;
+	size_t bufferedBytes = 0;
+	uint64_t fragments = 0;
+	uint64_t reassembled = 0;
+	uint64_t timeouts = 0; // Datagrams expired or evicted before all fragments arrived
+	uint64_t overlaps = 0; // Datagrams discarded because fragments disagreed on overlapping bytes
+	uint64_t dropped = 0; // Malformed, truncated or oversized datagrams
+};
+
+// Rebuilds IPv4 datagrams from their fragments so the transport dissectors see whole
+// datagrams with ports. Pending datagrams are bounded in count and bytes and expire after
+// a timeout. Overlapping fragments must carry identical bytes, otherwise the datagram is
+// discarded rather than letting either copy win.
+class IpDefragmenter
+{
+public:
+	// Capture thread only. layers must come from parsing the fragment in data. Returns the
+	// number of fragments once a datagram is complete and writes the rebuilt frame (the
+	// first fragment's link and IP headers followed by the whole payload) to frame,
+	// returns 0 otherwise.
+	uint8_t AddFragment(const uint8_t* data, size_t size, const PacketLayers& layers, int64_t timestampUs, std::vector<uint8_t>& frame);
+
+	void Clear(); // Capture thread only, or while capture is stopped
+	IpDefragmenterStats GetStats() const;
+
+private:
+	struct DatagramKey
+	{
+		IpAddress srcAddr;
+		IpAddress dstAddr;
+		uint16_t id = 0;
+		uint16_t vlan = 0;
+		uint8_t protocol = 0;
+
+		bool operator==(const DatagramKey&) const = default;
+	};
+
+	struct DatagramKeyHash
+	{
+		size_t operator()(const DatagramKey& key) const;
+	};
+
+	struct Datagram
+	{
+		std::vector<uint8_t> headers; // Link and IP headers of the offset 0 fragment
+		std::vector<uint8_t> payload;
+		std::vector<std::pair<uint32_t, uint32_t>> ranges; // Received [start, end), sorted and merged
+		uint32_t totalLength = 0; // Payload length, known once the last fragment arrived
+		bool haveLast = false;
+		uint8_t fragmentCount = 0;
+		int64_t firstSeenUs = 0;
+	};
+
+	std::unordered_map<DatagramKey, Datagram, DatagramKeyHash> datagrams;
+	size_t heldBytes = 0;
+	int64_t lastExpiryUs = 0;
+
+	// Written by the capture thread, read by the GUI
+	std::atomic<size_t> pendingDatagrams{ 0 };
+	std::atomic<size_t> bufferedBytes{ 0 };
+	std::atomic<uint64_t> fragments{ 0 };
+	std::atomic<uint64_t> reassembled{ 0 };
+	std::atomic<uint64_t> timeouts{ 0 };
+	std::atomic<uint64_t> overlaps{ 0 };
+	std::atomic<uint64_t> dropped{ 0 };
+
+	void Expire(int64_t nowUs);
+	bool EvictOldest(const Datagram* keep); // Never evicts keep
+	void Erase(std::unordered_map<DatagramKey, Datagram, DatagramKeyHash>::iterator it);
+	void PublishSizes();
+	static bool Insert(Datagram& datagram, uint32_t start, const uint8_t* bytes, uint32_t length);
+};
@@ -0,0 +1,36 @@
+#include "LatencyHistogram.h"
+#include <algorithm>
+#include <cmath>
+
+void LatencyHistogram::Add(uint32_t us)
+{
+	minUs = samples == 0 ? us : std::min(minUs, us);
+	maxUs = std::max(maxUs, us);
+	++samples;
+	totalUs += us;
+
+	size_t bucket = 0;
+	while (bucket + 1 < bucketCount && (us >> (bucket + 1)) != 0)
+	{
+		++bucket;
+	}
+	++buckets[bucket];
+}
+
+double LatencyHistogram::PercentileMs(double fraction) const
+{
+	if (samples == 0) return 0.0;
+
+	const uint64_t target = std::max<uint64_t>(static_cast<uint64_t>(std::ceil(fraction * static_cast<double>(samples))), 1);
+	uint64_t seen = 0;
+	for (size_t i = 0; i < bucketCount; ++i)
+	{
+		seen += buckets[i];
+		if (seen >= target)
+		{
+			// The slowest sample bounds the estimate for the top bucket in use
+			return std::min<double>(static_cast<double>(uint64_t{ 1 } << (i + 1)), maxUs) / 1000.0;
+		}
+	}
+	return maxUs / 1000.0;
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Latency samples with a power-of-two histogram for percentiles, fixed size so it can be
+// kept per table entry
+struct LatencyHistogram
+{
+	static constexpr size_t bucketCount = 24; // Bucket i counts samples below 2^(i+1) microseconds
+
+	uint64_t samples = 0;
+	uint64_t totalUs = 0;
+	uint32_t minUs = 0;
+	uint32_t maxUs = 0;
+	std::array<uint32_t, bucketCount> buckets{};
+
+	void Add(uint32_t us);
+	double AverageMs() const { return samples != 0 ? totalUs / 1000.0 / samples : 0.0; }
+	double PercentileMs(double fraction) const; // Upper edge of the bucket holding the percentile
+};
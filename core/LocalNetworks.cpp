@@ -0,0 +1,208 @@
+#include "LocalNetworks.h"
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#endif
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+uint32_t LocalNetworks::ApplyMask(uint32_t address, uint8_t length)
+{
+	return length == 0 ? 0 : address & (~uint32_t{ 0 } << (32 - length));
+}
+
+LocalNetworks::V6Key LocalNetworks::ApplyMask(V6Key address, uint8_t length)
+{
+	if (length <= 64)
+	{
+		address.high = length == 0 ? 0 : address.high & (~uint64_t{ 0 } << (64 - length));
+		address.low = 0;
+	}
+	else
+	{
+		address.low = length == 128 ? address.low : address.low & (~uint64_t{ 0 } << (128 - length));
+	}
+	return address;
+}
+
+template <typename Key, size_t MaxLength>
+bool LocalNetworks::PrefixTable<Key, MaxLength>::Add(Key network, uint8_t length)
+{
+	auto& networks = networksByLength[length];
+	auto it = std::lower_bound(networks.begin(), networks.end(), network);
+	if (it != networks.end() && *it == network)
+	{
+		return true; // Already present
+	}
+
+	networks.insert(it, network);
+	UpdatePopulatedLengths();
+	return true;
+}
+
+template <typename Key, size_t MaxLength>
+bool LocalNetworks::PrefixTable<Key, MaxLength>::Remove(Key network, uint8_t length)
+{
+	auto& networks = networksByLength[length];
+	auto it = std::lower_bound(networks.begin(), networks.end(), network);
+	if (it == networks.end() || *it != network)
+	{
+		return false;
+	}
+
+	networks.erase(it);
+	UpdatePopulatedLengths();
+	return true;
+}
+
+template <typename Key, size_t MaxLength>
+int LocalNetworks::PrefixTable<Key, MaxLength>::Match(Key address) const
+{
+	// Search only the populated prefix lengths, longest first
+	for (const uint8_t length : populatedLengths)
+	{
+		const auto& networks = networksByLength[length];
+		if (std::binary_search(networks.begin(), networks.end(), ApplyMask(address, length)))
+		{
+			return length;
+		}
+	}
+	return -1;
+}
+
+template <typename Key, size_t MaxLength>
+void LocalNetworks::PrefixTable<Key, MaxLength>::UpdatePopulatedLengths()
+{
+	populatedLengths.clear();
+	for (int length = static_cast<int>(MaxLength); length >= 0; --length)
+	{
+		if (!networksByLength[length].empty())
+		{
+			populatedLengths.push_back(static_cast<uint8_t>(length));
+		}
+	}
+}
+
+LocalNetworks LocalNetworks::Defaults()
+{
+	LocalNetworks networks;
+	networks.AddPrefix("10.0.0.0/8");
+	networks.AddPrefix("172.16.0.0/12");
+	networks.AddPrefix("192.168.0.0/16");
+	networks.AddPrefix("127.0.0.0/8");
+	networks.AddPrefix("fe80::/10");
+	networks.AddPrefix("fc00::/7");
+	networks.AddPrefix("::1/128");
+	return networks;
+}
+
+bool LocalNetworks::AddPrefix(const IpAddress& address, uint8_t length)
+{
+	if (address.IsIPv4() && length <= 32)
+	{
+		return ipv4.Add(ApplyMask(address.IPv4(), length), length);
+	}
+	if (address.IsIPv6() && length <= 128)
+	{
+		return ipv6.Add(ApplyMask(V6Key{ address.high, address.low }, length), length);
+	}
+	return false;
+}
+
+bool LocalNetworks::AddPrefix(const std::string& cidr)
+{
+	const size_t slash = cidr.find('/');
+	const std::string addressText = cidr.substr(0, slash);
+
+	IpAddress address;
+	in_addr addr4{};
+	in6_addr addr6{};
+	if (inet_pton(AF_INET, addressText.c_str(), &addr4) == 1)
+	{
+		address = IpAddress::FromIPv4(ntohl(addr4.s_addr));
+	}
+	else if (inet_pton(AF_INET6, addressText.c_str(), &addr6) == 1)
+	{
+		address = IpAddress::FromIPv6(reinterpret_cast<const uint8_t*>(&addr6));
+	}
+	else
+	{
+		return false;
+	}
+
+	const long maxLength = address.IsIPv4() ? 32 : 128;
+	long length = maxLength;
+	if (slash != std::string::npos)
+	{
+		char* end = nullptr;
+		length = std::strtol(cidr.c_str() + slash + 1, &end, 10);
+		if (end == cidr.c_str() + slash + 1 || *end != '\0' || length < 0 || length > maxLength)
+		{
+			return false;
+		}
+	}
+	return AddPrefix(address, static_cast<uint8_t>(length));
+}
+
+bool LocalNetworks::RemovePrefix(const Prefix& prefix)
+{
+	if (prefix.network.IsIPv4() && prefix.length <= 32)
+	{
+		return ipv4.Remove(prefix.network.IPv4(), prefix.length);
+	}
+	if (prefix.network.IsIPv6() && prefix.length <= 128)
+	{
+		return ipv6.Remove(V6Key{ prefix.network.high, prefix.network.low }, prefix.length);
+	}
+	return false;
+}
+
+void LocalNetworks::Clear()
+{
+	*this = LocalNetworks{};
+}
+
+int LocalNetworks::Match(const IpAddress& address) const
+{
+	if (address.IsIPv4())
+	{
+		return ipv4.Match(address.IPv4());
+	}
+	if (address.IsIPv6())
+	{
+		return ipv6.Match(V6Key{ address.high, address.low });
+	}
+	return -1;
+}
+
+std::vector<LocalNetworks::Prefix> LocalNetworks::GetPrefixes() const
+{
+	std::vector<Prefix> prefixes;
+	for (const uint8_t length : ipv4.populatedLengths)
+	{
+		for (uint32_t network : ipv4.networksByLength[length])
+		{
+			prefixes.push_back(Prefix{ IpAddress::FromIPv4(network), length });
+		}
+	}
+	for (const uint8_t length : ipv6.populatedLengths)
+	{
+		for (const V6Key& network : ipv6.networksByLength[length])
+		{
+			IpAddress address;
+			address.version = 6;
+			address.high = network.high;
+			address.low = network.low;
+			prefixes.push_back(Prefix{ address, length });
+		}
+	}
+	return prefixes;
+}
+
+std::string LocalNetworks::FormatPrefix(const Prefix& prefix)
+{
+	return prefix.network.ToString() + "/" + std::to_string(prefix.length);
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <array>
+#include <compare>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "IpAddress.h"
+
+// Set of address prefixes considered local, used to decide packet direction.
+// Networks are bucketed by prefix length into sorted arrays, a lookup binary-searches
+// only the populated lengths from longest to shortest.
+class LocalNetworks
+{
+public:
+	struct Prefix
+	{
+		IpAddress network; // Already masked
+		uint8_t length = 0;
+	};
+
+	// RFC1918 private ranges, IPv6 link-local and unique-local, plus loopback
+	static LocalNetworks Defaults();
+
+	bool AddPrefix(const IpAddress& address, uint8_t length);
+	bool AddPrefix(const std::string& cidr); // e.g. "10.0.0.0/8" or "fd00::/8", a bare address is a host prefix
+	bool RemovePrefix(const Prefix& prefix);
+	void Clear();
+
+	// Longest matching prefix length, or -1 if the address is not local
+	int Match(const IpAddress& address) const;
+	bool IsLocal(const IpAddress& address) const { return Match(address) >= 0; }
+
+	bool Empty() const { return ipv4.Empty() && ipv6.Empty(); }
+	std::vector<Prefix> GetPrefixes() const;
+	static std::string FormatPrefix(const Prefix& prefix);
+
+private:
+	struct V6Key
+	{
+		uint64_t high = 0;
+		uint64_t low = 0;
+		auto operator<=>(const V6Key&) const = default;
+	};
+
+	static uint32_t ApplyMask(uint32_t address, uint8_t length);
+	static V6Key ApplyMask(V6Key address, uint8_t length);
+
+	// One sorted array of networks per prefix length
+	template <typename Key, size_t MaxLength>
+	struct PrefixTable
+	{
+		std::array<std::vector<Key>, MaxLength + 1> networksByLength;
+		std::vector<uint8_t> populatedLengths; // Lengths with at least one network, longest first
+
+		bool Add(Key network, uint8_t length);
+		bool Remove(Key network, uint8_t length);
+		int Match(Key address) const;
+		bool Empty() const { return populatedLengths.empty(); }
+		void UpdatePopulatedLengths();
+	};
+
+	PrefixTable<uint32_t, 32> ipv4;
+	PrefixTable<V6Key, 128> ipv6;
+};
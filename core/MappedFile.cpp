@@ -0,0 +1,109 @@
+#include "MappedFile.h"
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::Open(const std::string& path, std::string& error)
+{
+	Close();
+
+	HANDLE fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (fileHandle == INVALID_HANDLE_VALUE)
+	{
+		error = "Cannot open " + path + " (error " + std::to_string(GetLastError()) + ")";
+		return false;
+	}
+	file = fileHandle;
+
+	LARGE_INTEGER fileSize{};
+	if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0)
+	{
+		error = path + " is empty";
+		Close();
+		return false;
+	}
+
+	mapping = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	const void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+	if (!view)
+	{
+		error = "Cannot map " + path + " (error " + std::to_string(GetLastError()) + ")";
+		Close();
+		return false;
+	}
+
+	data = static_cast<const uint8_t*>(view);
+	size = static_cast<size_t>(fileSize.QuadPart);
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (data) UnmapViewOfFile(data);
+	if (mapping) CloseHandle(mapping);
+	if (file) CloseHandle(file);
+	data = nullptr;
+	size = 0;
+	mapping = nullptr;
+	file = nullptr;
+}
+
+#else
+
+bool MappedFile::Open(const std::string& path, std::string& error)
+{
+	Close();
+
+	const int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+	{
+		error = "Cannot open " + path + ": " + std::strerror(errno);
+		return false;
+	}
+
+	struct stat info{};
+	if (fstat(fd, &info) != 0 || info.st_size == 0)
+	{
+		error = path + " is empty";
+		close(fd);
+		return false;
+	}
+
+	// The mapping keeps its own reference to the file
+	void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (view == MAP_FAILED)
+	{
+		error = "Cannot map " + path + ": " + std::strerror(errno);
+		return false;
+	}
+	madvise(view, static_cast<size_t>(info.st_size), MADV_WILLNEED);
+
+	data = static_cast<const uint8_t*>(view);
+	size = static_cast<size_t>(info.st_size);
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (data) munmap(const_cast<uint8_t*>(data), size);
+	data = nullptr;
+	size = 0;
+}
+
+#endif
@@ -0,0 +1,30 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Read-only memory mapping of a whole file, so large dumps are scanned in place without
+// being read into memory first. The pages are shared by every thread reading the mapping.
+class MappedFile
+{
+public:
+	MappedFile() = default;
+	~MappedFile();
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	// Returns false with a message when the file cannot be opened or mapped
+	bool Open(const std::string& path, std::string& error);
+	void Close();
+
+	const uint8_t* Data() const { return data; }
+	size_t Size() const { return size; }
+
+private:
+	const uint8_t* data = nullptr;
+	size_t size = 0;
+#ifdef _WIN32
+	void* file = nullptr;
+	void* mapping = nullptr;
+#endif
+};
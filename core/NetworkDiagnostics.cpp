@@ -0,0 +1,252 @@
+#include "NetworkDiagnostics.h"
+#include "ArpPacket.h"
+#include "IcmpMessage.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+	constexpr size_t maxArpEntries = 4096;
+	constexpr int64_t arpExpiryUs = 600'000'000; // Addresses are commonly reassigned after leases end
+	constexpr int64_t arpSweepIntervalUs = 10'000'000;
+	constexpr size_t maxEvents = 64;
+
+	int64_t ToMicroseconds(std::chrono::system_clock::time_point timestamp)
+	{
+		return std::chrono::duration_cast<std::chrono::microseconds>(timestamp.time_since_epoch()).count();
+	}
+}
+
+const char* NetworkDiagnostics::CounterName(Counter counter)
+{
+	switch (counter)
+	{
+		case Counter::ArpRequests: return "ARP requests";
+		case Counter::ArpReplies: return "ARP replies";
+		case Counter::GratuitousArp: return "Gratuitous ARP";
+		case Counter::ArpConflicts: return "ARP conflicts";
+		case Counter::EchoRequests: return "Echo requests";
+		case Counter::EchoReplies: return "Echo replies";
+		case Counter::Unreachables: return "Unreachables";
+		case Counter::TimeExceeded: return "Time exceeded";
+		case Counter::OtherIcmp: return "Other ICMP";
+		default: return "";
+	}
+}
+
+void NetworkDiagnostics::Process(const PacketInfo& pkt, const uint8_t* frame, size_t size)
+{
+	const int64_t nowUs = ToMicroseconds(pkt.timestamp);
+	if (pkt.layers.IsArp())
+	{
+		ProcessArp(pkt, frame, size, nowUs);
+	}
+	else if (pkt.layers.IsIcmp())
+	{
+		ProcessIcmp(pkt, frame, size, nowUs);
+	}
+}
+
+void NetworkDiagnostics::ProcessArp(const PacketInfo& pkt, const uint8_t* frame, size_t size, int64_t nowUs)
+{
+	ArpInfo info;
+	const size_t offset = pkt.layers.networkOffset;
+	if (offset >= size || !ArpPacket::Parse(frame + offset, size - offset, info)) return;
+
+	if (info.IsRequest()) Count(Counter::ArpRequests, nowUs);
+	else if (info.IsReply()) Count(Counter::ArpReplies, nowUs);
+	if (info.IsGratuitous()) Count(Counter::GratuitousArp, nowUs);
+
+	// Probes come from 0.0.0.0 and say nothing about who owns an address
+	const uint32_t address = info.senderIp.IPv4();
+	if (address == 0) return;
+
+	if (nowUs - lastArpSweepUs >= arpSweepIntervalUs)
+	{
+		std::erase_if(arpTable, [nowUs](const auto& entry) { return nowUs - entry.second.lastSeenUs > arpExpiryUs; });
+		arpTableSize.store(arpTable.size(), std::memory_order_relaxed);
+		lastArpSweepUs = nowUs;
+	}
+
+	auto it = arpTable.find(address);
+	if (it == arpTable.end())
+	{
+		if (arpTable.size() < maxArpEntries)
+		{
+			ArpEntry& entry = arpTable[address];
+			std::memcpy(entry.mac, info.senderMac, sizeof(entry.mac));
+			entry.lastSeenUs = nowUs;
+			arpTableSize.store(arpTable.size(), std::memory_order_relaxed);
+		}
+	}
+	else
+	{
+		ArpEntry& entry = it->second;
+		if (std::memcmp(entry.mac, info.senderMac, sizeof(entry.mac)) != 0 && nowUs - entry.lastSeenUs <= arpExpiryUs)
+		{
+			Count(Counter::ArpConflicts, nowUs);
+			AddEvent(nowUs, "ARP conflict: " + info.senderIp.ToString() + " moved from " + ArpPacket::FormatMac(entry.mac) +
+				" to " + ArpPacket::FormatMac(info.senderMac));
+		}
+		std::memcpy(entry.mac, info.senderMac, sizeof(entry.mac));
+		entry.lastSeenUs = nowUs;
+	}
+}
+
+void NetworkDiagnostics::ProcessIcmp(const PacketInfo& pkt, const uint8_t* frame, size_t size, int64_t nowUs)
+{
+	const PacketLayers& layers = pkt.layers;
+	const bool v6 = layers.ipProtocol == IcmpMessage::protocolV6;
+	switch (IcmpMessage::Classify(v6, layers.icmpType))
+	{
+		case IcmpMessage::Kind::EchoRequest: Count(Counter::EchoRequests, nowUs); break;
+		case IcmpMessage::Kind::EchoReply: Count(Counter::EchoReplies, nowUs); break;
+		case IcmpMessage::Kind::TimeExceeded: Count(Counter::TimeExceeded, nowUs); break;
+		case IcmpMessage::Kind::Other: Count(Counter::OtherIcmp, nowUs); break;
+		case IcmpMessage::Kind::Unreachable:
+		{
+			Count(Counter::Unreachables, nowUs);
+
+			// Only the latest one is kept, and only described when a flood event quotes it
+			IcmpEmbeddedDatagram datagram;
+			const size_t offset = layers.payloadOffset;
+			if (offset < size && IcmpMessage::ReadEmbedded(frame + offset, size - offset, v6, datagram))
+			{
+				lastUnreachable.valid = true;
+				lastUnreachable.datagram = datagram;
+				lastUnreachable.v6 = v6;
+				lastUnreachable.type = layers.icmpType;
+				lastUnreachable.code = layers.icmpCode;
+				lastUnreachable.source = layers.srcAddr;
+			}
+			break;
+		}
+	}
+}
+
+void NetworkDiagnostics::Count(Counter counter, int64_t nowUs)
+{
+	const size_t index = static_cast<size_t>(counter);
+	auto& total = totals[index];
+	total.store(total.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+	// A second is checked once the first diagnostic packet of a later second arrives
+	const int64_t slot = nowUs / 1000000;
+	if (slot != currentSlot)
+	{
+		if (currentSlot >= 0) CloseSecond(currentSlot, nowUs);
+		currentSlot = slot;
+	}
+
+	Bucket& bucket = buckets[static_cast<size_t>(slot) % seriesSeconds];
+	if (bucket.slot.load(std::memory_order_relaxed) != slot)
+	{
+		bucket.slot.store(-1, std::memory_order_relaxed);
+		for (auto& count : bucket.counts)
+		{
+			count.store(0, std::memory_order_relaxed);
+		}
+		bucket.slot.store(slot, std::memory_order_release);
+	}
+	auto& count = bucket.counts[index];
+	count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+void NetworkDiagnostics::CloseSecond(int64_t slot, int64_t nowUs)
+{
+	const Bucket& bucket = buckets[static_cast<size_t>(slot) % seriesSeconds];
+	if (bucket.slot.load(std::memory_order_relaxed) != slot) return;
+
+	std::array<uint32_t, counterCount> counts{};
+	for (size_t i = 0; i < counterCount; ++i)
+	{
+		counts[i] = bucket.counts[i].load(std::memory_order_relaxed);
+		if (counts[i] > peaks[i].load(std::memory_order_relaxed))
+		{
+			peaks[i].store(counts[i], std::memory_order_relaxed);
+		}
+	}
+
+	const uint32_t arp = counts[static_cast<size_t>(Counter::ArpRequests)] + counts[static_cast<size_t>(Counter::ArpReplies)];
+	if (arp >= arpStormThreshold.load(std::memory_order_relaxed))
+	{
+		AddEvent(nowUs, "ARP storm: " + std::to_string(arp) + " ARP packets in one second");
+	}
+
+	const uint32_t unreachables = counts[static_cast<size_t>(Counter::Unreachables)];
+	if (unreachables >= unreachableFloodThreshold.load(std::memory_order_relaxed))
+	{
+		std::string text = "Unreachable flood: " + std::to_string(unreachables) + " in one second";
+		if (lastUnreachable.valid)
+		{
+			const UnreachableInfo& last = lastUnreachable;
+			const char* codeName = IcmpMessage::CodeName(last.v6, last.type, last.code);
+			text += ", latest " + std::string(codeName ? codeName : IcmpMessage::TypeName(last.v6, last.type)) +
+				" from " + last.source.ToString() + " for " + IcmpMessage::FormatEmbedded(last.datagram);
+		}
+		AddEvent(nowUs, std::move(text));
+	}
+}
+
+float NetworkDiagnostics::GetRate(Counter counter, int64_t nowSeconds) const
+{
+	const int64_t slot = nowSeconds - 1;
+	if (slot < 0) return 0.0f;
+
+	const Bucket& bucket = buckets[static_cast<size_t>(slot) % seriesSeconds];
+	if (bucket.slot.load(std::memory_order_acquire) != slot) return 0.0f;
+	const uint32_t count = bucket.counts[static_cast<size_t>(counter)].load(std::memory_order_relaxed);
+
+	// The writer may have recycled the bucket while we were reading
+	if (bucket.slot.load(std::memory_order_acquire) != slot) return 0.0f;
+	return static_cast<float>(count);
+}
+
+void NetworkDiagnostics::GetSeries(Counter counter, int64_t nowSeconds, std::vector<float>& out) const
+{
+	out.assign(seriesSeconds, 0.0f);
+	for (size_t i = 0; i < seriesSeconds; ++i)
+	{
+		const int64_t slot = nowSeconds - static_cast<int64_t>(seriesSeconds - 1 - i);
+		if (slot >= 0) out[i] = GetRate(counter, slot + 1);
+	}
+}
+
+std::vector<NetworkDiagnostics::Event> NetworkDiagnostics::GetRecentEvents() const
+{
+	std::scoped_lock lock(eventMutex);
+	return std::vector<Event>(events.rbegin(), events.rend());
+}
+
+void NetworkDiagnostics::AddEvent(int64_t timestampUs, std::string text)
+{
+	std::scoped_lock lock(eventMutex);
+	events.push_back({ timestampUs, std::move(text) });
+	if (events.size() > maxEvents)
+	{
+		events.pop_front();
+	}
+}
+
+void NetworkDiagnostics::Clear()
+{
+	for (Bucket& bucket : buckets)
+	{
+		bucket.slot.store(-1, std::memory_order_relaxed);
+	}
+	for (size_t i = 0; i < counterCount; ++i)
+	{
+		totals[i].store(0, std::memory_order_relaxed);
+		peaks[i].store(0, std::memory_order_relaxed);
+	}
+	currentSlot = -1;
+	arpTable.clear();
+	arpTableSize.store(0, std::memory_order_relaxed);
+	lastArpSweepUs = 0;
+	lastUnreachable = {};
+
+	std::scoped_lock lock(eventMutex);
+	events.clear();
+}
@@ -0,0 +1,110 @@
+#pragma once
+#include "IcmpMessage.h"
+#include "PacketInfo.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// ARP and ICMP counters kept up to date on the capture thread. Besides running totals each
+// counter has a per-second ring for the last minute, so bursts such as ARP storms or floods
+// of unreachables show up as they happen. The ARP table maps IPv4 addresses to the last MAC
+// seen for them, a different MAC for a known address counts as a conflict.
+class NetworkDiagnostics
+{
+public:
+	enum class Counter
+	{
+		ArpRequests,
+		ArpReplies,
+		GratuitousArp,
+		ArpConflicts,
+		EchoRequests,
+		EchoReplies,
+		Unreachables,
+		TimeExceeded,
+		OtherIcmp,
+		Count
+	};
+
+	struct Event
+	{
+		int64_t timestampUs = 0;
+		std::string text;
+	};
+
+	static constexpr size_t counterCount = static_cast<size_t>(Counter::Count);
+	static constexpr size_t seriesSeconds = 60;
+
+	static const char* CounterName(Counter counter);
+
+	// Capture thread only. frame is the full captured frame pkt was parsed from.
+	void Process(const PacketInfo& pkt, const uint8_t* frame, size_t size);
+
+	uint64_t GetTotal(Counter counter) const { return totals[static_cast<size_t>(counter)].load(std::memory_order_relaxed); }
+	float GetRate(Counter counter, int64_t nowSeconds) const; // Over the last completed second
+	float GetPeakRate(Counter counter) const { return static_cast<float>(peaks[static_cast<size_t>(counter)].load(std::memory_order_relaxed)); }
+	void GetSeries(Counter counter, int64_t nowSeconds, std::vector<float>& out) const; // Oldest first
+
+	// Per-second rates that raise an event, checked when a second completes
+	void SetArpStormThreshold(uint32_t perSecond) { arpStormThreshold = perSecond; }
+	uint32_t GetArpStormThreshold() const { return arpStormThreshold.load(); }
+	void SetUnreachableFloodThreshold(uint32_t perSecond) { unreachableFloodThreshold = perSecond; }
+	uint32_t GetUnreachableFloodThreshold() const { return unreachableFloodThreshold.load(); }
+
+	std::vector<Event> GetRecentEvents() const; // Newest first
+	size_t GetArpTableSize() const { return arpTableSize.load(); }
+	void Clear(); // Capture thread only, or while capture is stopped
+
+private:
+	// Single-writer ring like TrafficStats, the slot says which second the counters belong to
+	struct Bucket
+	{
+		std::atomic<int64_t> slot{ -1 };
+		std::array<std::atomic<uint32_t>, counterCount> counts{};
+	};
+
+	// Raw fields of an unreachable, only formatted when a flood event quotes it
+	struct UnreachableInfo
+	{
+		bool valid = false;
+		bool v6 = false;
+		uint8_t type = 0;
+		uint8_t code = 0;
+		IpAddress source;
+		IcmpEmbeddedDatagram datagram;
+	};
+
+	struct ArpEntry
+	{
+		uint8_t mac[6] = {};
+		int64_t lastSeenUs = 0;
+	};
+
+	std::array<Bucket, seriesSeconds> buckets;
+	std::array<std::atomic<uint64_t>, counterCount> totals{};
+	std::array<std::atomic<uint32_t>, counterCount> peaks{};
+	int64_t currentSlot = -1; // Capture thread only
+
+	std::atomic<uint32_t> arpStormThreshold{ 100 };
+	std::atomic<uint32_t> unreachableFloodThreshold{ 100 };
+
+	std::unordered_map<uint32_t, ArpEntry> arpTable; // Capture thread only
+	std::atomic<size_t> arpTableSize{ 0 };
+	int64_t lastArpSweepUs = 0;
+	UnreachableInfo lastUnreachable; // Latest unreachable, quoted by the flood event
+
+	mutable std::mutex eventMutex; // Guards events, taken only when an event is raised
+	std::deque<Event> events;
+
+	void Count(Counter counter, int64_t nowUs);
+	void CloseSecond(int64_t slot, int64_t nowUs); // Updates peaks and checks the thresholds
+	void ProcessArp(const PacketInfo& pkt, const uint8_t* frame, size_t size, int64_t nowUs);
+	void ProcessIcmp(const PacketInfo& pkt, const uint8_t* frame, size_t size, int64_t nowUs);
+	void AddEvent(int64_t timestampUs, std::string text);
+};
@@ -0,0 +1,26 @@
+#include "PacketField.h"
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+
+PacketField& PacketField::Add(std::string fieldName, std::string fieldValue, size_t fieldOffset, size_t fieldLength)
+{
+	PacketField& child = children.emplace_back();
+	child.name = std::move(fieldName);
+	child.value = std::move(fieldValue);
+	child.offset = static_cast<uint32_t>(fieldOffset);
+	child.length = static_cast<uint32_t>(fieldLength);
+	return child;
+}
+
+std::string FormatFieldValue(const char* format, ...)
+{
+	char buf[128];
+	va_list args;
+	va_start(args, format);
+	const int written = std::vsnprintf(buf, sizeof(buf), format, args);
+	va_end(args);
+
+	if (written < 0) return {};
+	return std::string(buf, std::min<size_t>(static_cast<size_t>(written), sizeof(buf) - 1));
+}
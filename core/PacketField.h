@@ -0,0 +1,22 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// One decoded header field. Offset and length locate its bytes in PacketInfo::data,
+// children hold sub-fields such as individual flags or options.
+struct PacketField
+{
+	std::string name;
+	std::string value;
+	uint32_t offset = 0;
+	uint32_t length = 0;
+	std::vector<PacketField> children;
+
+	// Appends a child and returns it, the reference is only valid until the next Add
+	PacketField& Add(std::string fieldName, std::string fieldValue, size_t fieldOffset, size_t fieldLength);
+};
+
+// printf-style formatting for field values
+std::string FormatFieldValue(const char* format, ...);
@@ -1,4 +1,12 @@
 #include "PacketInfo.h"
+#include "DnsMessage.h"
+#include "TlsHello.h"
+#include "HttpMessage.h"
+#include "QuicPacket.h"
+#include "ArpPacket.h"
+#include "IcmpMessage.h"
+#include <algorithm>
+#include <cstdio>
 #include <iomanip>
 #include <sstream>
 
@@ -25,4 +33,279 @@ std::string PacketInfo::GetHexPreview(size_t maxBytes) const
 		oss << std::hex << std::setw(2) << std::setfill('0') << (int)data[i] << " ";
 	}
 	return oss.str();
-}
\ No newline at end of file
+}
+
+namespace
+{
+	std::string FormatMac(const std::vector<uint8_t>& data, size_t offset)
+	{
+		if (data.size() < offset + 6)
+		{
+			return {};
+		}
+
+		char buf[32];
+		snprintf(buf, sizeof(buf), "%02X:%02X:%02X:%02X:%02X:%02X",
+			data[offset], data[offset + 1], data[offset + 2], data[offset + 3], data[offset + 4], data[offset + 5]);
+		return buf;
+	}
+}
+
+std::string PacketInfo::GetEtherSrcString() const
+{
+	return FormatMac(data, 6);
+}
+
+std::string PacketInfo::GetEtherDstString() const
+{
+	return FormatMac(data, 0);
+}
+
+const char* PacketInfo::GetEtherTypeName() const
+{
+	if (data.size() < 14) return "";
+	switch (layers.etherType)
+	{
+		case 0x0800: return "IPv4";
+		case 0x86DD: return "IPv6";
+		case ArpPacket::etherType: return "ARP";
+		default: return "Other";
+	}
+}
+
+std::string PacketInfo::GetSrcAddressString() const
+{
+	return layers.srcAddr.ToString();
+}
+
+std::string PacketInfo::GetDstAddressString() const
+{
+	return layers.dstAddr.ToString();
+}
+
+const char* PacketInfo::GetTransportName() const
+{
+	if (layers.IsArp())
+	{
+		return "ARP";
+	}
+	if (!layers.HasTransport())
+	{
+		return "";
+	}
+
+	switch (layers.ipProtocol)
+	{
+		case IcmpMessage::protocolV4: return "ICMP";
+		case 6: return "TCP";
+		case 17: return "UDP";
+		case IcmpMessage::protocolV6: return "ICMPv6";
+		default: return "Other";
+	}
+}
+
+std::string PacketInfo::FormatTcpFlags(uint8_t flags)
+{
+	static const char* const names[] = { "FIN", "SYN", "RST", "PSH", "ACK", "URG", "ECE", "CWR" };
+
+	std::string result;
+	for (int bit = 0; bit < 8; ++bit)
+	{
+		if (flags & (1 << bit))
+		{
+			if (!result.empty()) result += ", ";
+			result += names[bit];
+		}
+	}
+	return result;
+}
+
+std::string PacketInfo::GetInfoString() const
+{
+	if (layers.fragment)
+	{
+		return "IP fragment";
+	}
+	if (layers.moreFragments)
+	{
+		return "IP fragment (first)";
+	}
+	if (layers.IsArp())
+	{
+		return GetArpInfoString();
+	}
+	if (layers.IsIcmp())
+	{
+		return GetIcmpInfoString();
+	}
+	if (layers.IsDns())
+	{
+		return GetDnsInfoString();
+	}
+	if (layers.IsTls())
+	{
+		return GetTlsInfoString();
+	}
+	if (layers.IsQuic())
+	{
+		return GetQuicInfoString();
+	}
+	if (layers.IsHttp())
+	{
+		// The request or status line, e.g. "GET /index.html HTTP/1.1"
+		const size_t offset = std::min<size_t>(layers.payloadOffset, data.size());
+		const size_t end = std::min<size_t>(data.size(), offset + layers.payloadLength);
+		return std::string(HttpMessage::FirstLine(data.data() + offset, end - offset).substr(0, 200));
+	}
+	if (!layers.IsTcp())
+	{
+		return layers.reassembledFragments != 0 ? "Reassembled from " + std::to_string(layers.reassembledFragments) + " fragments" : std::string{};
+	}
+
+	// Analysis results lead, as they are what the list is scanned for
+	std::string info;
+	if (tcpAnalysis.Has(TcpAnalysis::Retransmission)) info += "[Retransmission] ";
+	if (tcpAnalysis.Has(TcpAnalysis::OutOfOrder)) info += "[Out-Of-Order] ";
+	if (tcpAnalysis.Has(TcpAnalysis::DuplicateAck)) info += "[Dup ACK] ";
+	if (tcpAnalysis.Has(TcpAnalysis::ZeroWindow)) info += "[Zero Window] ";
+
+	char buf[96];
+	std::snprintf(buf, sizeof(buf), "[%s] Seq=%u Ack=%u Win=%u", FormatTcpFlags(layers.tcpFlags).c_str(),
+		layers.tcpSeq, layers.tcpAck, layers.tcpWindow);
+	info += buf;
+
+	if (layers.HasTcpOption(PacketLayers::TcpOptionMss))
+	{
+		info += " MSS=" + std::to_string(layers.tcpMss);
+	}
+	if (layers.HasTcpOption(PacketLayers::TcpOptionWindowScale))
+	{
+		info += " WS=" + std::to_string(1u << layers.tcpWindowScale);
+	}
+	if (layers.HasTcpOption(PacketLayers::TcpOptionSack))
+	{
+		info += " SACK";
+	}
+	return info;
+}
+
+std::string PacketInfo::GetDnsInfoString() const
+{
+	const bool response = (layers.dnsFlags & 0x8000) != 0;
+	char buf[64];
+	std::snprintf(buf, sizeof(buf), "%s 0x%04x", response ? "Response" : "Query", layers.dnsId);
+	std::string info = buf;
+	if (response)
+	{
+		info += " ";
+		info += DnsMessage::RcodeName(layers.dnsFlags & 0x0F);
+	}
+
+	const size_t offset = layers.payloadOffset;
+	const size_t end = std::min<size_t>(data.size(), offset + layers.payloadLength);
+	DnsName name;
+	uint16_t type = 0;
+	size_t questionEnd = 0;
+	if (end > offset && DnsMessage::ReadQuestion(data.data() + offset, end - offset, DnsMessage::headerSize, name, type, questionEnd))
+	{
+		const char* typeName = DnsMessage::TypeName(type);
+		info += " ";
+		info += typeName ? typeName : "TYPE" + std::to_string(type);
+		info += " ";
+		info += name.View();
+	}
+	return info;
+}
+
+std::string PacketInfo::GetTlsInfoString() const
+{
+	if (layers.tlsContentType != TlsHello::contentHandshake)
+	{
+		switch (layers.tlsContentType)
+		{
+			case 20: return "TLS Change Cipher Spec";
+			case 21: return "TLS Alert";
+			case 23: return "TLS Application Data";
+			default: return "TLS";
+		}
+	}
+
+	const size_t offset = layers.payloadOffset;
+	const size_t end = std::min<size_t>(data.size(), offset + layers.payloadLength);
+	TlsHelloInfo info;
+	if (end > offset && TlsHello::Parse(data.data() + offset, end - offset, info) == TlsParseResult::Parsed)
+	{
+		return std::string(info.IsClientHello() ? "TLS Client Hello: " : "TLS Server Hello: ") + TlsHello::FormatSummary(info);
+	}
+	if (layers.tlsHandshakeType == TlsHello::clientHello) return "TLS Client Hello (continues in later segments)";
+	if (layers.tlsHandshakeType == TlsHello::serverHello) return "TLS Server Hello (continues in later segments)";
+	return "TLS Handshake";
+}
+
+std::string PacketInfo::GetQuicInfoString() const
+{
+	const size_t offset = std::min<size_t>(layers.payloadOffset, data.size());
+	const size_t end = std::min<size_t>(data.size(), offset + layers.payloadLength);
+	QuicHeader header;
+	if (!QuicPacket::Parse(data.data() + offset, end - offset, header))
+	{
+		return "QUIC";
+	}
+
+	std::string info = std::string("QUIC ") + QuicPacket::TypeName(header.type);
+	if (header.IsLongHeader())
+	{
+		if (header.type != QuicHeader::Type::VersionNegotiation)
+		{
+			info += " " + QuicPacket::VersionName(header.version);
+		}
+		info += ", DCID " + (header.dcidLength != 0 ? QuicPacket::FormatConnectionId(header.dcid, header.dcidLength) : std::string("(empty)"));
+		info += ", SCID " + (header.scidLength != 0 ? QuicPacket::FormatConnectionId(header.scid, header.scidLength) : std::string("(empty)"));
+	}
+	if (quicConnection != 0)
+	{
+		info += " [connection " + std::to_string(quicConnection) + "]";
+	}
+	return info;
+}
+
+std::string PacketInfo::GetArpInfoString() const
+{
+	ArpInfo info;
+	const size_t offset = layers.networkOffset;
+	if (offset >= data.size() || !ArpPacket::Parse(data.data() + offset, data.size() - offset, info))
+	{
+		return "ARP";
+	}
+
+	return ArpPacket::FormatSummary(info);
+}
+
+std::string PacketInfo::GetIcmpInfoString() const
+{
+	const bool v6 = layers.ipProtocol == IcmpMessage::protocolV6;
+	std::string info = IcmpMessage::TypeName(v6, layers.icmpType);
+	if (IcmpMessage::IsEcho(v6, layers.icmpType))
+	{
+		char buf[48];
+		std::snprintf(buf, sizeof(buf), " id=0x%04x seq=%u", layers.icmpId, layers.icmpSequence);
+		return info + buf;
+	}
+
+	if (const char* codeName = IcmpMessage::CodeName(v6, layers.icmpType, layers.icmpCode))
+	{
+		info += " (";
+		info += codeName;
+		info += ")";
+	}
+
+	// The quoted header says which conversation the error belongs to
+	const size_t offset = layers.payloadOffset;
+	IcmpEmbeddedDatagram datagram;
+	if (IcmpMessage::CarriesDatagram(v6, layers.icmpType) && offset < data.size() &&
+		IcmpMessage::ReadEmbedded(data.data() + offset, data.size() - offset, v6, datagram))
+	{
+		info += " for " + IcmpMessage::FormatEmbedded(datagram);
+	}
+	return info;
+}
@@ -2,6 +2,27 @@
 #include <string>
 #include <vector>
 #include <chrono>
+#include <memory>
+#include "PacketLayers.h"
+#include "PacketField.h"
+
+// TCP analysis of one packet within its connection, filled in at capture time
+struct TcpAnalysis
+{
+	enum Flag : uint8_t
+	{
+		Retransmission = 0x01, // Resends data that was already seen
+		DuplicateAck = 0x02, // Repeats the previous ACK while data is outstanding
+		OutOfOrder = 0x04, // Fills in data below the highest sequence shortly after it
+		ZeroWindow = 0x08 // Receiver advertises no buffer space
+	};
+
+	uint8_t flags = 0;
+	uint32_t rttUs = 0; // Set on ACKs: time since the acknowledged data was seen
+	uint32_t handshakeRttUs = 0; // Set on the ACK completing the handshake: time since the SYN
+
+	bool Has(Flag flag) const { return (flags & flag) != 0; }
+};
 
 struct PacketInfo
 {
@@ -10,23 +31,39 @@ struct PacketInfo
 	std::vector<uint8_t> data;
 
 	// Parsed layer info
-	std::string etherSrc;
-	std::string etherDst;
-	std::string etherTypeStr;
+	PacketLayers layers;
 
-	std::string srcIP;
-	std::string dstIP;
-	uint8_t ttl = 0;
-	uint8_t protocol = 0;
+	TcpAnalysis tcpAnalysis;
 
-	std::string transportProtocol; // e.g., "TCP", "UDP", "ICMP"
-	uint16_t srcPort = 0;
-	uint16_t dstPort = 0;
-
-	std::vector<std::pair<std::string, std::string>> extraFields; // e.g., TCP flags, ICMP type/code
+	// Full field tree, only filled by deep dissection when the packet is inspected
+	std::vector<PacketField> extraFields;
+	bool dissected = false;
 
 	std::string GetTimeString() const;
 	std::string GetHexPreview(size_t maxBytes = 16) const;
 
+	// Human-readable layer fields, formatted on demand from the layer map
+	std::string GetEtherSrcString() const;
+	std::string GetEtherDstString() const;
+	const char* GetEtherTypeName() const;
+	std::string GetSrcAddressString() const;
+	std::string GetDstAddressString() const;
+	const char* GetTransportName() const; // e.g., "TCP", "UDP", "Other"
+	std::string GetInfoString() const; // Short protocol summary for the packet list, e.g. "[SYN, ACK] Seq=0 Win=64240"
+	std::string GetDnsInfoString() const; // e.g. "Query 0x1a2b A example.com", from the stored bytes
+	std::string GetTlsInfoString() const; // e.g. "TLS Client Hello: TLS 1.3, h2, example.com"
+	std::string GetQuicInfoString() const; // e.g. "QUIC Initial v1, DCID 1a2b3c4d, SCID 5e6f"
+	std::string GetArpInfoString() const; // e.g. "Who has 10.0.0.1? Tell 10.0.0.2"
+	std::string GetIcmpInfoString() const; // e.g. "Destination Unreachable (Port unreachable) for UDP 10.0.0.2:5353 -> 10.0.0.1:53"
+
+	static std::string FormatTcpFlags(uint8_t flags); // e.g., "SYN, ACK"
+
 	bool incoming = false; // true = received, false = sent
-};
\ No newline at end of file
+	uint64_t flowId = 0; // Assigned by the capture engine, 0 = no flow
+	uint64_t quicConnection = 0; // QUIC connection grouped by connection ID, 0 = none
+	uint64_t sequence = 0; // Stable capture sequence number, used to look packets up in the history
+	std::vector<uint32_t> ruleMatches; // IDs of the capture rules the packet matched, see RuleEngine
+};
+
+// Captured packets are immutable once stored, so they are shared between buffers instead of copied
+using PacketRef = std::shared_ptr<const PacketInfo>;
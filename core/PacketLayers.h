@@ -0,0 +1,127 @@
+#pragma once
+#include <cstdint>
+#include "IpAddress.h"
+
+// Fixed-size layer map filled by the parser: where each layer starts in the packet
+// bytes plus the header fields the list and flow table need. Parsing into it never
+// allocates, human-readable strings are produced on demand from PacketInfo.
+struct PacketLayers
+{
+	enum class Tunnel : uint8_t
+	{
+		None,
+		GRE,
+		VXLAN
+	};
+
+	// Application protocol recognised in the payload by a port dissector
+	enum class Application : uint8_t
+	{
+		None,
+		DNS,
+		TLS,
+		HTTP,
+		QUIC
+	};
+
+	// TCP flag bits as they appear in the header
+	enum TcpFlag : uint8_t
+	{
+		TcpFin = 0x01,
+		TcpSyn = 0x02,
+		TcpRst = 0x04,
+		TcpPsh = 0x08,
+		TcpAck = 0x10,
+		TcpUrg = 0x20,
+		TcpEce = 0x40,
+		TcpCwr = 0x80
+	};
+
+	// TCP options seen in the segment, one bit each
+	enum TcpOption : uint8_t
+	{
+		TcpOptionMss = 0x01,
+		TcpOptionWindowScale = 0x02,
+		TcpOptionSackPermitted = 0x04,
+		TcpOptionSack = 0x08,
+		TcpOptionTimestamps = 0x10
+	};
+
+	static constexpr int maxVlanTags = 2;
+	static constexpr int maxMplsLabels = 4;
+	static constexpr int maxSackBlocks = 4;
+
+	// Byte offsets into the packet data, 0 = layer not parsed
+	uint16_t networkOffset = 0;
+	uint16_t transportOffset = 0;
+	uint16_t payloadOffset = 0;
+	uint16_t payloadLength = 0; // From the IP length fields, so link-layer padding is excluded
+
+	uint16_t etherType = 0;
+	uint8_t ipProtocol = 0; // Final next header for IPv6, after any extension headers
+	uint8_t ttl = 0; // Hop limit for IPv6
+	uint8_t ipv6ExtensionHeaders = 0;
+	bool fragment = false; // Non-first fragment, transport header not present
+	bool moreFragments = false; // First fragment, transport header present but the payload is incomplete
+	uint8_t reassembledFragments = 0; // Set when the layers describe a datagram rebuilt from fragments
+
+	IpAddress srcAddr;
+	IpAddress dstAddr;
+
+	uint16_t srcPort = 0;
+	uint16_t dstPort = 0;
+
+	// TCP header, only meaningful when ipProtocol is 6 and the transport layer was parsed
+	uint32_t tcpSeq = 0;
+	uint32_t tcpAck = 0;
+	uint16_t tcpWindow = 0; // Unscaled, as on the wire
+	uint8_t tcpFlags = 0;
+	uint8_t tcpOptions = 0; // TcpOption bits
+	uint16_t tcpMss = 0;
+	uint8_t tcpWindowScale = 0;
+	uint8_t tcpSackCount = 0;
+	uint32_t tcpSackBlocks[maxSackBlocks][2] = {}; // Left and right edge
+	uint32_t tcpTsVal = 0;
+	uint32_t tcpTsEcr = 0;
+
+	// ARP, the sender and target protocol addresses go to srcAddr and dstAddr
+	uint16_t arpOperation = 0; // 0 = not ARP
+
+	// ICMP and ICMPv6 header, only meaningful when IsIcmp()
+	uint8_t icmpType = 0;
+	uint8_t icmpCode = 0;
+	uint16_t icmpId = 0; // Echo messages only
+	uint16_t icmpSequence = 0;
+
+	// Application layer, the payload starts at payloadOffset
+	Application application = Application::None;
+	uint16_t dnsId = 0;
+	uint16_t dnsFlags = 0;
+	uint8_t tlsContentType = 0; // First record in the segment
+	uint8_t tlsHandshakeType = 0; // When that record is a handshake
+
+	// Encapsulation stripped before reaching IP, outermost first
+	uint16_t vlanIds[maxVlanTags] = {};
+	uint8_t vlanCount = 0;
+	uint32_t mplsLabels[maxMplsLabels] = {};
+	uint8_t mplsCount = 0;
+
+	// Set when the addresses and ports above belong to a packet carried inside a tunnel
+	Tunnel tunnel = Tunnel::None;
+	uint32_t tunnelId = 0; // VXLAN VNI or GRE key
+	uint16_t outerNetworkOffset = 0;
+
+	bool HasNetwork() const { return networkOffset != 0; }
+	bool HasTransport() const { return transportOffset != 0; }
+	uint16_t OuterVlan() const { return vlanCount ? vlanIds[0] : 0; }
+	bool IsFragment() const { return fragment || moreFragments; }
+	bool IsTcp() const { return ipProtocol == 6 && payloadOffset != 0; }
+	bool IsArp() const { return arpOperation != 0; }
+	bool IsIcmp() const { return (ipProtocol == 1 || ipProtocol == 58) && payloadOffset != 0; }
+	bool HasTcpFlag(uint8_t flag) const { return (tcpFlags & flag) != 0; }
+	bool HasTcpOption(uint8_t option) const { return (tcpOptions & option) != 0; }
+	bool IsDns() const { return application == Application::DNS; }
+	bool IsTls() const { return application == Application::TLS; }
+	bool IsHttp() const { return application == Application::HTTP; }
+	bool IsQuic() const { return application == Application::QUIC; }
+};
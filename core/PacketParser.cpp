@@ -1,12 +1,19 @@
 #include "PacketParser.h"
+#include "DnsMessage.h"
+#include "TlsHello.h"
+#include "HttpMessage.h"
+#include "QuicPacket.h"
+#include "ArpPacket.h"
+#include "IcmpMessage.h"
 #ifdef _WIN32
 #include <winsock2.h>
 #include <ws2tcpip.h>
 #else
 #include <arpa/inet.h>
 #endif
-#include <sstream>
-#include <cstring>
+#include <algorithm>
+#include <array>
+#include <memory>
 
 
 #pragma pack(push, 1)
@@ -31,6 +38,16 @@ struct IPv4Header
 	uint32_t daddr;
 };
 
+struct IPv6Header
+{
+	uint32_t version_class_flow;
+	uint16_t payload_len;
+	uint8_t next_header;
+	uint8_t hop_limit;
+	uint8_t saddr[16];
+	uint8_t daddr[16];
+};
+
 struct TCPHeader
 {
 	uint16_t src_port;
@@ -53,103 +70,1165 @@ struct UDPHeader
 };
 #pragma pack(pop)
 
-static std::string macToStr(const uint8_t* mac)
+// Read a big-endian value from an unaligned position
+static uint16_t ReadU16(const uint8_t* p)
+{
+	return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+static uint32_t ReadU32(const uint8_t* p)
+{
+	return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) | (static_cast<uint32_t>(p[2]) << 8) | p[3];
+}
+
+// Kinds of IPv6 extension header, indexed by next header value
+enum : uint8_t
+{
+	ExtNone = 0,
+	ExtOptions,  // Hop-by-hop, routing, destination options: (len + 1) * 8 bytes
+	ExtFragment, // Fixed 8 bytes
+	ExtAuth      // Authentication header: (len + 2) * 4 bytes
+};
+
+static constexpr std::array<uint8_t, 256> MakeExtensionTable()
+{
+	std::array<uint8_t, 256> table{};
+	table[0] = ExtOptions;   // Hop-by-hop
+	table[43] = ExtOptions;  // Routing
+	table[60] = ExtOptions;  // Destination options
+	table[135] = ExtOptions; // Mobility
+	table[44] = ExtFragment;
+	table[51] = ExtAuth;
+	return table;
+}
+
+static constexpr std::array<uint8_t, 256> extensionKinds = MakeExtensionTable();
+static constexpr int maxExtensionHeaders = 8;
+
+static constexpr uint16_t vxlanPort = 4789;
+static constexpr int maxTunnelDepth = 1; // Only one level of GRE/VXLAN is unwrapped
+static constexpr int maxVlanTags = PacketLayers::maxVlanTags + 2; // Extra tags are skipped but not recorded
+
+static bool DissectEthernet(DissectContext& ctx, size_t offset);
+
+// Field tree helpers, they do nothing on the capture path where ctx.fields is null.
+// A layer must be filled in before dispatching further, since later layers may move it.
+static PacketField* AddLayer(DissectContext& ctx, const char* name, size_t offset, size_t length)
+{
+	if (!ctx.fields) return nullptr;
+
+	PacketField& layer = ctx.fields->emplace_back();
+	layer.name = name;
+	layer.offset = static_cast<uint32_t>(offset);
+	layer.length = static_cast<uint32_t>(std::min(length, ctx.size - std::min(offset, ctx.size)));
+	return &layer;
+}
+
+static std::string FormatMac(const uint8_t* mac)
+{
+	return FormatFieldValue("%02x:%02x:%02x:%02x:%02x:%02x", mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+}
+
+static std::string FormatEtherType(const DissectContext& ctx, uint16_t etherType)
+{
+	const Dissector* dissector = ctx.registry.FindEtherType(etherType);
+	return FormatFieldValue("0x%04x (%s)", etherType, dissector ? dissector->name : "Unknown");
+}
+
+static std::string FormatIpProtocol(const DissectContext& ctx, uint8_t protocol)
+{
+	const Dissector* dissector = ctx.registry.FindIpProtocol(protocol);
+	return FormatFieldValue("%u (%s)", protocol, dissector ? dissector->name : "Unknown");
+}
+
+static void DispatchEtherType(DissectContext& ctx, uint16_t etherType, size_t offset)
+{
+	ctx.layers.etherType = etherType;
+	ctx.registry.DispatchEtherType(etherType, ctx, offset);
+}
+
+// Switch the layer map over to the packet carried inside a tunnel
+static void EnterTunnel(DissectContext& ctx, PacketLayers::Tunnel tunnel, uint32_t tunnelId)
+{
+	PacketLayers& layers = ctx.layers;
+	layers.tunnel = tunnel;
+	layers.tunnelId = tunnelId;
+	layers.outerNetworkOffset = layers.networkOffset;
+	layers.networkOffset = 0;
+	layers.transportOffset = 0;
+	layers.payloadOffset = 0;
+	layers.payloadLength = 0;
+	layers.ipProtocol = 0;
+	layers.ipv6ExtensionHeaders = 0;
+	layers.fragment = false;
+	layers.moreFragments = false;
+	layers.srcAddr = {};
+	layers.dstAddr = {};
+	layers.srcPort = 0;
+	layers.dstPort = 0;
+	++ctx.tunnelDepth;
+}
+
+static bool CanEnterTunnel(const DissectContext& ctx)
+{
+	return ctx.options.decodeTunnels && ctx.tunnelDepth < maxTunnelDepth;
+}
+
+// Stacked VLAN tags: 2-byte TCI (low 12 bits are the VLAN ID) then the next EtherType
+static bool DissectVlan(DissectContext& ctx, size_t offset)
+{
+	PacketLayers& layers = ctx.layers;
+	if (ctx.size < offset + 4 || ++ctx.vlanTags > maxVlanTags) return false;
+
+	const uint16_t tci = ReadU16(ctx.data + offset);
+	const uint16_t etherType = ReadU16(ctx.data + offset + 2);
+	if (layers.vlanCount < PacketLayers::maxVlanTags)
+	{
+		layers.vlanIds[layers.vlanCount++] = tci & 0x0FFF;
+	}
+
+	if (PacketField* layer = AddLayer(ctx, "802.1Q VLAN", offset, 4))
+	{
+		layer->value = FormatFieldValue("ID %u", tci & 0x0FFF);
+		layer->Add("Priority", std::to_string(tci >> 13), offset, 1);
+		layer->Add("Drop Eligible", (tci & 0x1000) ? "Yes" : "No", offset, 1);
+		layer->Add("VLAN ID", std::to_string(tci & 0x0FFF), offset, 2);
+		layer->Add("Type", FormatEtherType(ctx, etherType), offset + 2, 2);
+	}
+	DispatchEtherType(ctx, etherType, offset + 4);
+	return true;
+}
+
+// MPLS label stack, each entry is label(20) | TC(3) | bottom-of-stack(1) | TTL(8)
+static bool DissectMpls(DissectContext& ctx, size_t offset)
 {
-	char buf[32];
-	snprintf(buf, sizeof(buf), "%02X:%02X:%02X:%02X:%02X:%02X", mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
-	return buf;
+	PacketLayers& layers = ctx.layers;
+	if (ctx.size < offset + 4) return false;
+
+	PacketField* layer = AddLayer(ctx, "MPLS", offset, 0);
+	for (int i = 0; i < 8; ++i)
+	{
+		if (ctx.size < offset + 4) return true;
+		const uint32_t entry = ReadU32(ctx.data + offset);
+		if (layers.mplsCount < PacketLayers::maxMplsLabels)
+		{
+			layers.mplsLabels[layers.mplsCount++] = entry >> 12;
+		}
+		if (layer)
+		{
+			PacketField& label = layer->Add("Label", std::to_string(entry >> 12), offset, 4);
+			label.Add("Traffic Class", std::to_string((entry >> 9) & 0x07), offset + 2, 1);
+			label.Add("Bottom of Stack", (entry & 0x100) ? "Yes" : "No", offset + 2, 1);
+			label.Add("TTL", std::to_string(entry & 0xFF), offset + 3, 1);
+			layer->length += 4;
+		}
+		offset += 4;
+		if (entry & 0x100) break;
+	}
+
+	// MPLS does not say what it carries, guess IP from the version nibble
+	if (ctx.size <= offset) return true;
+	const uint8_t version = ctx.data[offset] >> 4;
+	if (version == 4 || version == 6)
+	{
+		DispatchEtherType(ctx, version == 4 ? 0x0800 : 0x86DD, offset);
+	}
+	return true;
 }
 
-static bool IsLocalAddress(const std::string& ip)
+static bool DissectGre(DissectContext& ctx, size_t offset)
 {
-	// Check for common private IP ranges
-	if (ip.rfind("10.", 0) == 0) return true;
-	if (ip.rfind("192.168.", 0) == 0) return true;
-	if (ip.rfind("127.", 0) == 0) return true;
-	if (ip.rfind("172.", 0) == 0)
+	// GRE has no ports, it is only looked into when tunnels are decoded
+	if (!CanEnterTunnel(ctx) || ctx.size < offset + 4) return false;
+
+	// Optional checksum, key and sequence fields follow the fixed header when their flag is set
+	const uint16_t flags = ReadU16(ctx.data + offset);
+	const uint16_t protocol = ReadU16(ctx.data + offset + 2);
+	size_t headerLen = 4;
+	uint32_t key = 0;
+	if (flags & 0x8000) headerLen += 4;
+	if (flags & 0x2000)
 	{
-		// Check if its in 172.16.0.0 to 172.31.255.255 range
-		size_t dot = ip.find('.', 4);
-		if (dot != std::string::npos)
+		if (ctx.size < offset + headerLen + 4) return false;
+		key = ReadU32(ctx.data + offset + headerLen);
+		headerLen += 4;
+	}
+	if (flags & 0x1000) headerLen += 4;
+
+	if (PacketField* layer = AddLayer(ctx, "GRE", offset, headerLen))
+	{
+		layer->Add("Flags", FormatFieldValue("0x%04x", flags), offset, 2);
+		layer->Add("Protocol", FormatFieldValue("0x%04x", protocol), offset + 2, 2);
+		if (flags & 0x2000)
 		{
-			int second = std::stoi(ip.substr(4, dot - 4));
-			if (second >= 16 && second <= 31) return true;
+			layer->Add("Key", std::to_string(key), offset + ((flags & 0x8000) ? 8 : 4), 4);
 		}
 	}
-	return false;
+
+	const size_t inner = offset + headerLen;
+	if (protocol == 0x6558) // Transparent Ethernet bridging
+	{
+		EnterTunnel(ctx, PacketLayers::Tunnel::GRE, key);
+		DissectEthernet(ctx, inner);
+	}
+	else if (protocol == 0x0800 || protocol == 0x86DD)
+	{
+		EnterTunnel(ctx, PacketLayers::Tunnel::GRE, key);
+		DispatchEtherType(ctx, protocol, inner);
+	}
+	return true;
 }
 
-void PacketParser::ParsePacket(PacketInfo& pkt)
+// VXLAN: 8-byte header with the I flag set, then a full Ethernet frame
+static bool DissectVxlan(DissectContext& ctx, size_t offset)
 {
-	if (pkt.data.size() < sizeof(EthernetHeader)) return;
+	if (!CanEnterTunnel(ctx) || ctx.size < offset + 8 || !(ctx.data[offset] & 0x08)) return false;
+
+	const uint32_t vni = ReadU32(ctx.data + offset + 4) >> 8;
+	if (PacketField* layer = AddLayer(ctx, "VXLAN", offset, 8))
+	{
+		layer->value = FormatFieldValue("VNI %u", vni);
+		layer->Add("Flags", FormatFieldValue("0x%02x", ctx.data[offset]), offset, 1);
+		layer->Add("VNI", std::to_string(vni), offset + 4, 3);
+	}
+	EnterTunnel(ctx, PacketLayers::Tunnel::VXLAN, vni);
+	DissectEthernet(ctx, offset + 8);
+	return true;
+}
 
-	// Ethernet Layer
-	const auto* eth = reinterpret_cast<const EthernetHeader*>(pkt.data.data());
-	uint16_t etherType = ntohs(eth->type);
+// TCP option kinds
+enum : uint8_t
+{
+	TcpOptEnd = 0,
+	TcpOptNop = 1,
+	TcpOptMss = 2,
+	TcpOptWindowScale = 3,
+	TcpOptSackPermitted = 4,
+	TcpOptSack = 5,
+	TcpOptTimestamps = 8
+};
+
+// Calls fn(kind, offset, length) for each option in [start, end), length includes kind and
+// length bytes. Stops at the end-of-list option or at the first malformed length.
+template <typename Fn>
+static void ForEachTcpOption(const uint8_t* data, size_t start, size_t end, Fn&& fn)
+{
+	size_t offset = start;
+	while (offset < end)
+	{
+		const uint8_t kind = data[offset];
+		if (kind == TcpOptEnd) return;
+		if (kind == TcpOptNop)
+		{
+			++offset;
+			continue;
+		}
 
-	pkt.etherSrc = macToStr(eth->src);
-	pkt.etherDst = macToStr(eth->dst);
-	pkt.etherTypeStr = (etherType == 0x0800) ? "IPv4" : "Other";
+		if (offset + 2 > end) return;
+		const size_t length = data[offset + 1];
+		if (length < 2 || offset + length > end) return;
 
-	// If not IPv4, return (for now we only handle IPv4)
-	if (etherType != 0x0800) return;
+		fn(kind, offset, length);
+		offset += length;
+	}
+}
 
-	// IP Layer
-	const size_t ipOffset = sizeof(EthernetHeader);
-	if (pkt.data.size() < ipOffset + sizeof(IPv4Header)) return;
+static void ParseTcpOptions(DissectContext& ctx, size_t start, size_t end)
+{
+	PacketLayers& layers = ctx.layers;
+	const uint8_t* data = ctx.data;
+	ForEachTcpOption(data, start, end, [&](uint8_t kind, size_t offset, size_t length)
+		{
+			switch (kind)
+			{
+				case TcpOptMss:
+					if (length != 4) return;
+					layers.tcpMss = ReadU16(data + offset + 2);
+					layers.tcpOptions |= PacketLayers::TcpOptionMss;
+					break;
+				case TcpOptWindowScale:
+					if (length != 3) return;
+					layers.tcpWindowScale = std::min<uint8_t>(data[offset + 2], 14); // RFC 7323 caps the shift at 14
+					layers.tcpOptions |= PacketLayers::TcpOptionWindowScale;
+					break;
+				case TcpOptSackPermitted:
+					layers.tcpOptions |= PacketLayers::TcpOptionSackPermitted;
+					break;
+				case TcpOptSack:
+					layers.tcpOptions |= PacketLayers::TcpOptionSack;
+					for (size_t block = offset + 2; block + 8 <= offset + length && layers.tcpSackCount < PacketLayers::maxSackBlocks; block += 8)
+					{
+						layers.tcpSackBlocks[layers.tcpSackCount][0] = ReadU32(data + block);
+						layers.tcpSackBlocks[layers.tcpSackCount][1] = ReadU32(data + block + 4);
+						++layers.tcpSackCount;
+					}
+					break;
+				case TcpOptTimestamps:
+					if (length != 10) return;
+					layers.tcpTsVal = ReadU32(data + offset + 2);
+					layers.tcpTsEcr = ReadU32(data + offset + 6);
+					layers.tcpOptions |= PacketLayers::TcpOptionTimestamps;
+					break;
+				default:
+					break;
+			}
+		});
+}
 
-	const auto* ip = reinterpret_cast<const IPv4Header*>(pkt.data.data() + ipOffset);
-	const uint8_t ipHeaderLen = (ip->ihl_version & 0x0F) * 4;
-	const uint8_t protocol = ip->protocol;
+static void DescribeTcpOptions(DissectContext& ctx, PacketField& options, size_t start, size_t end)
+{
+	const uint8_t* data = ctx.data;
+	ForEachTcpOption(data, start, end, [&](uint8_t kind, size_t offset, size_t length)
+		{
+			switch (kind)
+			{
+				case TcpOptMss:
+					options.Add("Maximum Segment Size", length == 4 ? std::to_string(ReadU16(data + offset + 2)) : "Malformed", offset, length);
+					break;
+				case TcpOptWindowScale:
+					options.Add("Window Scale", length == 3 ? FormatFieldValue("%u (x%u)", data[offset + 2], 1u << std::min<uint8_t>(data[offset + 2], 14)) : "Malformed", offset, length);
+					break;
+				case TcpOptSackPermitted:
+					options.Add("SACK Permitted", "Yes", offset, length);
+					break;
+				case TcpOptSack:
+				{
+					PacketField& sack = options.Add("SACK", FormatFieldValue("%zu blocks", (length - 2) / 8), offset, length);
+					for (size_t block = offset + 2; block + 8 <= offset + length; block += 8)
+					{
+						sack.Add("Block", FormatFieldValue("%u-%u", ReadU32(data + block), ReadU32(data + block + 4)), block, 8);
+					}
+					break;
+				}
+				case TcpOptTimestamps:
+					options.Add("Timestamps", length == 10 ? FormatFieldValue("TSval %u, TSecr %u", ReadU32(data + offset + 2), ReadU32(data + offset + 6)) : "Malformed", offset, length);
+					break;
+				default:
+					options.Add("Option", FormatFieldValue("Kind %u, %zu bytes", kind, length), offset, length);
+					break;
+			}
+		});
+}
 
-	char src[INET_ADDRSTRLEN];
-	char dst[INET_ADDRSTRLEN];
-	inet_ntop(AF_INET, &ip->saddr, src, sizeof(src));
-	inet_ntop(AF_INET, &ip->daddr, dst, sizeof(dst));
+static void DescribeTcp(DissectContext& ctx, const TCPHeader* tcp, size_t offset)
+{
+	const PacketLayers& layers = ctx.layers;
+	PacketField& layer = *AddLayer(ctx, "TCP", offset, layers.payloadOffset - offset);
+	layer.value = FormatFieldValue("%u -> %u [%s]", layers.srcPort, layers.dstPort, PacketInfo::FormatTcpFlags(layers.tcpFlags).c_str());
+	layer.Add("Source Port", std::to_string(layers.srcPort), offset, 2);
+	layer.Add("Destination Port", std::to_string(layers.dstPort), offset + 2, 2);
+	layer.Add("Sequence Number", std::to_string(layers.tcpSeq), offset + 4, 4);
+	layer.Add("Acknowledgment Number", std::to_string(layers.tcpAck), offset + 8, 4);
+	layer.Add("Header Length", FormatFieldValue("%u bytes", (tcp->offset_reserved >> 4) * 4), offset + 12, 1);
+
+	static const char* const flagNames[] = { "FIN", "SYN", "RST", "PSH", "ACK", "URG", "ECE", "CWR" };
+	PacketField& flags = layer.Add("Flags", FormatFieldValue("0x%02x", tcp->flags), offset + 13, 1);
+	for (int bit = 0; bit < 8; ++bit)
+	{
+		flags.Add(flagNames[bit], (tcp->flags & (1 << bit)) ? "Set" : "Not set", offset + 13, 1);
+	}
+
+	layer.Add("Window", std::to_string(layers.tcpWindow), offset + 14, 2);
+	layer.Add("Checksum", FormatFieldValue("0x%04x", ntohs(tcp->check)), offset + 16, 2);
+	layer.Add("Urgent Pointer", std::to_string(ntohs(tcp->urg_ptr)), offset + 18, 2);
+
+	const size_t optionsStart = offset + sizeof(TCPHeader);
+	const size_t optionsEnd = std::min<size_t>(layers.payloadOffset, ctx.size);
+	if (optionsEnd > optionsStart)
+	{
+		PacketField& options = layer.Add("Options", FormatFieldValue("%zu bytes", optionsEnd - optionsStart), optionsStart, optionsEnd - optionsStart);
+		DescribeTcpOptions(ctx, options, optionsStart, optionsEnd);
+	}
+}
+
+static bool DissectTcp(DissectContext& ctx, size_t offset)
+{
+	PacketLayers& layers = ctx.layers;
+	if (ctx.size < offset + sizeof(TCPHeader)) return false;
+
+	const auto* tcp = reinterpret_cast<const TCPHeader*>(ctx.data + offset);
+	const size_t tcpHeaderLen = (tcp->offset_reserved >> 4) * 4;
+	if (tcpHeaderLen < sizeof(TCPHeader)) return false; // Would put the payload inside the TCP header
+
+	layers.srcPort = ntohs(tcp->src_port);
+	layers.dstPort = ntohs(tcp->dst_port);
+	layers.payloadOffset = static_cast<uint16_t>(offset + tcpHeaderLen);
+	layers.payloadLength = static_cast<uint16_t>(ctx.networkEnd > layers.payloadOffset ? ctx.networkEnd - layers.payloadOffset : 0);
+	layers.tcpSeq = ntohl(tcp->seq);
+	layers.tcpAck = ntohl(tcp->ack_seq);
+	layers.tcpFlags = tcp->flags;
+	layers.tcpWindow = ntohs(tcp->window);
+
+	// Options sit between the fixed header and the data offset
+	const size_t optionsEnd = std::min<size_t>(layers.payloadOffset, ctx.size);
+	if (optionsEnd > offset + sizeof(TCPHeader))
+	{
+		ParseTcpOptions(ctx, offset + sizeof(TCPHeader), optionsEnd);
+	}
+
+	if (ctx.fields)
+	{
+		DescribeTcp(ctx, tcp, offset);
+	}
+
+	if (!layers.moreFragments)
+	{
+		ctx.registry.DispatchPort(DissectorRegistry::Transport::TCP, layers.srcPort, layers.dstPort, ctx, layers.payloadOffset);
+	}
+	return true;
+}
 
-	pkt.srcIP = src;
-	pkt.dstIP = dst;
-	pkt.ttl = ip->ttl;
+static void DescribeIcmp(DissectContext& ctx, size_t offset, bool v6)
+{
+	const PacketLayers& layers = ctx.layers;
+	const uint8_t type = layers.icmpType;
+	const uint8_t code = layers.icmpCode;
+	const char* codeName = IcmpMessage::CodeName(v6, type, code);
 
-	size_t transportOffset = ipOffset + ipHeaderLen;
-	if (pkt.data.size() < transportOffset + 4) return;
+	PacketField& layer = *AddLayer(ctx, v6 ? "ICMPv6" : "ICMP", offset, IcmpMessage::headerSize);
+	layer.value = IcmpMessage::TypeName(v6, type);
+	layer.Add("Type", FormatFieldValue("%u (%s)", type, IcmpMessage::TypeName(v6, type)), offset, 1);
+	layer.Add("Code", codeName ? FormatFieldValue("%u (%s)", code, codeName) : std::to_string(code), offset + 1, 1);
+	layer.Add("Checksum", FormatFieldValue("0x%04x", ReadU16(ctx.data + offset + 2)), offset + 2, 2);
 
+	if (IcmpMessage::IsEcho(v6, type))
+	{
+		layer.Add("Identifier", FormatFieldValue("%u (0x%04x)", layers.icmpId, layers.icmpId), offset + 4, 2);
+		layer.Add("Sequence", std::to_string(layers.icmpSequence), offset + 6, 2);
+		return;
+	}
+	if (v6 && type == 2)
+	{
+		layer.Add("MTU", std::to_string(ReadU32(ctx.data + offset + 4)), offset + 4, 4);
+	}
+	else if (!v6 && type == 3 && code == 4)
+	{
+		layer.Add("Next-Hop MTU", std::to_string(ReadU16(ctx.data + offset + 6)), offset + 6, 2);
+	}
+	else if (!v6 && type == 5)
+	{
+		layer.Add("Gateway", IpAddress::FromIPv4(ReadU32(ctx.data + offset + 4)).ToString(), offset + 4, 4);
+	}
 
-	// Transport Layer
-	switch (protocol)
+	// Errors quote the header of the datagram that caused them
+	const size_t quoted = offset + IcmpMessage::headerSize;
+	IcmpEmbeddedDatagram datagram;
+	if (IcmpMessage::CarriesDatagram(v6, type) && quoted < ctx.size && IcmpMessage::ReadEmbedded(ctx.data + quoted, ctx.size - quoted, v6, datagram))
 	{
-		case 6: // TCP
+		PacketField& original = layer.Add("Original Datagram", IcmpMessage::FormatEmbedded(datagram), quoted, ctx.size - quoted);
+		original.Add("Source", datagram.srcAddr.ToString(), quoted, 0);
+		original.Add("Destination", datagram.dstAddr.ToString(), quoted, 0);
+		original.Add("Protocol", FormatIpProtocol(ctx, datagram.protocol), quoted, 0);
+		if (datagram.hasPorts)
 		{
-			pkt.transportProtocol = "TCP";
-			if (pkt.data.size() < transportOffset + sizeof(TCPHeader)) return;
+			original.Add("Source Port", std::to_string(datagram.srcPort), quoted, 0);
+			original.Add("Destination Port", std::to_string(datagram.dstPort), quoted, 0);
+		}
+	}
+}
+
+// ICMP and ICMPv6 share the header layout, the type numbering depends on the family
+static bool DissectIcmp(DissectContext& ctx, size_t offset, bool v6)
+{
+	PacketLayers& layers = ctx.layers;
+	if (ctx.size < offset + IcmpMessage::headerSize) return false;
+
+	layers.icmpType = ctx.data[offset];
+	layers.icmpCode = ctx.data[offset + 1];
+	if (IcmpMessage::IsEcho(v6, layers.icmpType))
+	{
+		layers.icmpId = ReadU16(ctx.data + offset + 4);
+		layers.icmpSequence = ReadU16(ctx.data + offset + 6);
+	}
+	layers.payloadOffset = static_cast<uint16_t>(offset + IcmpMessage::headerSize);
+	layers.payloadLength = static_cast<uint16_t>(ctx.networkEnd > layers.payloadOffset ? ctx.networkEnd - layers.payloadOffset : 0);
+
+	if (ctx.fields)
+	{
+		DescribeIcmp(ctx, offset, v6);
+	}
+	return true;
+}
 
-			const auto* tcp = reinterpret_cast<const TCPHeader*>(pkt.data.data() + transportOffset);
-			pkt.srcPort = ntohs(tcp->src_port);
-			pkt.dstPort = ntohs(tcp->dst_port);
+// Separate entry points so the registry lists each family under its own name
+static bool DissectIcmpV4(DissectContext& ctx, size_t offset)
+{
+	return DissectIcmp(ctx, offset, false);
+}
+
+static bool DissectIcmpV6(DissectContext& ctx, size_t offset)
+{
+	return DissectIcmp(ctx, offset, true);
+}
+
+static void DescribeArp(DissectContext& ctx, const ArpInfo& info, size_t offset)
+{
+	PacketField& layer = *AddLayer(ctx, "ARP", offset, ArpPacket::size);
+	layer.value = ArpPacket::FormatSummary(info);
+	layer.Add("Hardware Type", "1 (Ethernet)", offset, 2);
+	layer.Add("Protocol Type", "0x0800 (IPv4)", offset + 2, 2);
+	layer.Add("Operation", FormatFieldValue("%u (%s)", info.operation, ArpPacket::OperationName(info.operation)), offset + 6, 2);
+	layer.Add("Sender MAC", ArpPacket::FormatMac(info.senderMac), offset + 8, 6);
+	layer.Add("Sender IP", info.senderIp.ToString(), offset + 14, 4);
+	layer.Add("Target MAC", ArpPacket::FormatMac(info.targetMac), offset + 18, 6);
+	layer.Add("Target IP", info.targetIp.ToString(), offset + 24, 4);
+	if (info.IsGratuitous()) layer.Add("Gratuitous", "Sender announces its own address", offset, 0);
+	if (info.IsProbe()) layer.Add("Probe", "Address conflict detection", offset, 0);
+}
+
+// ARP stands in for the network layer: its protocol addresses fill srcAddr and dstAddr
+static bool DissectArp(DissectContext& ctx, size_t offset)
+{
+	PacketLayers& layers = ctx.layers;
+	ArpInfo info;
+	if (offset >= ctx.size || !ArpPacket::Parse(ctx.data + offset, ctx.size - offset, info)) return false;
+
+	layers.networkOffset = static_cast<uint16_t>(offset);
+	layers.arpOperation = info.operation;
+	layers.srcAddr = info.senderIp;
+	layers.dstAddr = info.targetIp;
+
+	if (ctx.fields)
+	{
+		DescribeArp(ctx, info, offset);
+	}
+	return true;
+}
+
+static void DescribeUdp(DissectContext& ctx, const UDPHeader* udp, size_t offset)
+{
+	const PacketLayers& layers = ctx.layers;
+	PacketField& layer = *AddLayer(ctx, "UDP", offset, sizeof(UDPHeader));
+	layer.value = FormatFieldValue("%u -> %u", layers.srcPort, layers.dstPort);
+	layer.Add("Source Port", std::to_string(layers.srcPort), offset, 2);
+	layer.Add("Destination Port", std::to_string(layers.dstPort), offset + 2, 2);
+	layer.Add("Length", std::to_string(ntohs(udp->len)), offset + 4, 2);
+	layer.Add("Checksum", FormatFieldValue("0x%04x", ntohs(udp->check)), offset + 6, 2);
+}
+
+static bool DissectUdp(DissectContext& ctx, size_t offset)
+{
+	PacketLayers& layers = ctx.layers;
+	if (ctx.size < offset + sizeof(UDPHeader)) return false;
+
+	const auto* udp = reinterpret_cast<const UDPHeader*>(ctx.data + offset);
+	layers.srcPort = ntohs(udp->src_port);
+	layers.dstPort = ntohs(udp->dst_port);
+	layers.payloadOffset = static_cast<uint16_t>(offset + sizeof(UDPHeader));
+	layers.payloadLength = static_cast<uint16_t>(ctx.networkEnd > layers.payloadOffset ? ctx.networkEnd - layers.payloadOffset : 0);
+
+	if (ctx.fields)
+	{
+		DescribeUdp(ctx, udp, offset);
+	}
+
+	// Port-based dissectors only see complete datagrams
+	if (!layers.moreFragments)
+	{
+		ctx.registry.DispatchPort(DissectorRegistry::Transport::UDP, layers.srcPort, layers.dstPort, ctx, layers.payloadOffset);
+	}
+	return true;
+}
+
+// Resource record data for the common types, a byte count for the rest
+static std::string FormatDnsRecordData(const uint8_t* message, size_t size, size_t offset, uint16_t type, uint16_t length)
+{
+	DnsName name;
+	size_t end = 0;
+	switch (type)
+	{
+		case 1:
+			if (length == 4) return IpAddress::FromIPv4(ReadU32(message + offset)).ToString();
+			break;
+		case 28:
+			if (length == 16) return IpAddress::FromIPv6(message + offset).ToString();
+			break;
+		case 2:
+		case 5:
+		case 12:
+			if (DnsMessage::ReadName(message, size, offset, name, end)) return std::string(name.View());
 			break;
+		case 15:
+			if (length > 2 && DnsMessage::ReadName(message, size, offset + 2, name, end))
+			{
+				return FormatFieldValue("%u %s", ReadU16(message + offset), name.text);
+			}
+			break;
+		case 16:
+			if (length >= 1 && message[offset] < length)
+			{
+				return "\"" + std::string(reinterpret_cast<const char*>(message + offset + 1), message[offset]) + "\"";
+			}
+			break;
+	}
+	return FormatFieldValue("%u bytes", length);
+}
+
+// One question or resource record, returns the offset after it or 0 when malformed
+static size_t DescribeDnsRecord(PacketField& section, const uint8_t* message, size_t size, size_t offset, size_t base, bool question)
+{
+	DnsName name;
+	size_t nameEnd = 0;
+	if (!DnsMessage::ReadName(message, size, offset, name, nameEnd) || nameEnd + 4 > size) return 0;
+
+	const uint16_t type = ReadU16(message + nameEnd);
+	const uint16_t recordClass = ReadU16(message + nameEnd + 2);
+	const char* typeName = DnsMessage::TypeName(type);
+	const std::string typeText = typeName ? typeName : FormatFieldValue("TYPE%u", type);
+
+	if (question)
+	{
+		PacketField& record = section.Add(std::string(name.View()), typeText, base + offset, nameEnd + 4 - offset);
+		record.Add("Name", std::string(name.View()), base + offset, nameEnd - offset);
+		record.Add("Type", typeText, base + nameEnd, 2);
+		record.Add("Class", std::to_string(recordClass), base + nameEnd + 2, 2);
+		return nameEnd + 4;
+	}
+
+	if (nameEnd + 10 > size) return 0;
+	const uint32_t ttl = ReadU32(message + nameEnd + 4);
+	const uint16_t dataLength = ReadU16(message + nameEnd + 8);
+	const size_t dataOffset = nameEnd + 10;
+	if (dataOffset + dataLength > size) return 0;
+
+	// OPT reuses class and TTL for EDNS parameters
+	const std::string data = type == 41 ? FormatFieldValue("UDP payload size %u", recordClass)
+		: FormatDnsRecordData(message, size, dataOffset, type, dataLength);
+	PacketField& record = section.Add(std::string(name.View()), typeText + " " + data, base + offset, dataOffset + dataLength - offset);
+	record.Add("Name", std::string(name.View()), base + offset, nameEnd - offset);
+	record.Add("Type", typeText, base + nameEnd, 2);
+	record.Add("Class", std::to_string(recordClass), base + nameEnd + 2, 2);
+	record.Add("TTL", std::to_string(ttl), base + nameEnd + 4, 4);
+	record.Add("Data", data, base + dataOffset, dataLength);
+	return dataOffset + dataLength;
+}
+
+static void DescribeDns(DissectContext& ctx, const DnsHeader& header, const uint8_t* message, size_t size, size_t offset)
+{
+	PacketField& layer = *AddLayer(ctx, "DNS", offset, size);
+	layer.value = FormatFieldValue("%s 0x%04x", header.IsResponse() ? "Response" : "Query", header.id);
+	layer.Add("Transaction ID", FormatFieldValue("0x%04x", header.id), offset, 2);
+
+	PacketField& flags = layer.Add("Flags", FormatFieldValue("0x%04x", header.flags), offset + 2, 2);
+	flags.Add("Response", header.IsResponse() ? "Yes" : "No", offset + 2, 1);
+	flags.Add("Opcode", std::to_string(header.Opcode()), offset + 2, 1);
+	flags.Add("Authoritative", (header.flags & 0x0400) ? "Yes" : "No", offset + 2, 1);
+	flags.Add("Truncated", (header.flags & 0x0200) ? "Yes" : "No", offset + 2, 1);
+	flags.Add("Recursion Desired", (header.flags & 0x0100) ? "Yes" : "No", offset + 2, 1);
+	flags.Add("Recursion Available", (header.flags & 0x0080) ? "Yes" : "No", offset + 3, 1);
+	flags.Add("Reply Code", DnsMessage::RcodeName(header.Rcode()), offset + 3, 1);
+
+	layer.Add("Questions", std::to_string(header.questions), offset + 4, 2);
+	layer.Add("Answer RRs", std::to_string(header.answers), offset + 6, 2);
+	layer.Add("Authority RRs", std::to_string(header.authorities), offset + 8, 2);
+	layer.Add("Additional RRs", std::to_string(header.additionals), offset + 10, 2);
+
+	// Counts come from the packet, so the number of records described is capped
+	constexpr int maxRecords = 64;
+	const std::pair<const char*, uint16_t> sections[] = {
+		{ "Queries", header.questions }, { "Answers", header.answers },
+		{ "Authority", header.authorities }, { "Additional", header.additionals } };
+
+	size_t position = DnsMessage::headerSize;
+	int described = 0;
+	for (size_t s = 0; s < 4 && position != 0; ++s)
+	{
+		if (sections[s].second == 0) continue;
+
+		const size_t sectionStart = position;
+		PacketField& section = layer.Add(sections[s].first, std::to_string(sections[s].second), offset + position, 0);
+		for (uint16_t i = 0; i < sections[s].second && position != 0 && described < maxRecords; ++i, ++described)
+		{
+			position = DescribeDnsRecord(section, message, size, position, offset, s == 0);
+		}
+		section.length = static_cast<uint32_t>(position != 0 ? position - sectionStart : 0);
+		if (described == maxRecords) break;
+	}
+}
+
+// Header only on the capture path, the latency tracker reads names from the frame itself
+static bool DissectDns(DissectContext& ctx, size_t offset)
+{
+	PacketLayers& layers = ctx.layers;
+	const size_t messageEnd = std::min<size_t>(ctx.size, static_cast<size_t>(layers.payloadOffset) + layers.payloadLength);
+	if (messageEnd < offset + DnsMessage::headerSize) return false;
+
+	DnsHeader header;
+	DnsMessage::ReadHeader(ctx.data + offset, messageEnd - offset, header);
+	layers.application = PacketLayers::Application::DNS;
+	layers.dnsId = header.id;
+	layers.dnsFlags = header.flags;
+
+	if (ctx.fields)
+	{
+		DescribeDns(ctx, header, ctx.data + offset, messageEnd - offset, offset);
+	}
+	return true;
+}
+
+static const char* TlsContentTypeName(uint8_t type)
+{
+	switch (type)
+	{
+		case 20: return "Change Cipher Spec";
+		case 21: return "Alert";
+		case 22: return "Handshake";
+		case 23: return "Application Data";
+		case 24: return "Heartbeat";
+		default: return "Unknown";
+	}
+}
+
+static void DescribeTls(DissectContext& ctx, size_t offset, size_t end)
+{
+	const PacketLayers& layers = ctx.layers;
+	PacketField& layer = *AddLayer(ctx, "TLS", offset, end - offset);
+	layer.value = TlsContentTypeName(layers.tlsContentType);
+
+	// Record headers, a segment can carry several records
+	constexpr int maxRecords = 16;
+	size_t position = offset;
+	for (int i = 0; i < maxRecords && position + 5 <= end && TlsHello::IsRecordStart(ctx.data + position, end - position); ++i)
+	{
+		const uint16_t length = ReadU16(ctx.data + position + 3);
+		PacketField& record = layer.Add("Record", TlsContentTypeName(ctx.data[position]), position, 5 + length);
+		record.Add("Content Type", std::to_string(ctx.data[position]), position, 1);
+		record.Add("Version", FormatFieldValue("0x%04x", ReadU16(ctx.data + position + 1)), position + 1, 2);
+		record.Add("Length", std::to_string(length), position + 3, 2);
+		position += 5 + length;
+	}
+
+	// Hellos that fit in this segment, split ones are only summarised on the flow
+	TlsHelloInfo info;
+	if (layers.tlsContentType == TlsHello::contentHandshake &&
+		TlsHello::Parse(ctx.data + offset, end - offset, info) == TlsParseResult::Parsed)
+	{
+		PacketField& hello = layer.Add(info.IsClientHello() ? "Client Hello" : "Server Hello", TlsHello::FormatSummary(info), offset + 5, end - offset - 5);
+		const char* version = TlsHello::VersionName(info.version);
+		hello.Add(info.IsClientHello() ? "Highest Version" : "Version", version ? version : FormatFieldValue("0x%04x", info.version), offset + 5, 0);
+		if (!info.IsClientHello()) hello.Add("Cipher Suite", FormatFieldValue("0x%04x", info.cipherSuite), offset + 5, 0);
+		if (!info.serverName.empty()) hello.Add("Server Name", info.serverName, offset + 5, 0);
+		if (!info.alpn.empty()) hello.Add("ALPN", info.alpn, offset + 5, 0);
+	}
+}
+
+// Only the first record header is looked at on the capture path, hellos are extracted from
+// the reassembled stream. Segments that do not start a record are left unmarked.
+static bool DissectTls(DissectContext& ctx, size_t offset)
+{
+	PacketLayers& layers = ctx.layers;
+	const size_t end = std::min<size_t>(ctx.size, static_cast<size_t>(layers.payloadOffset) + layers.payloadLength);
+	if (end <= offset || !TlsHello::IsRecordStart(ctx.data + offset, end - offset)) return false;
+
+	layers.application = PacketLayers::Application::TLS;
+	layers.tlsContentType = ctx.data[offset];
+	if (layers.tlsContentType == TlsHello::contentHandshake && end > offset + 5)
+	{
+		layers.tlsHandshakeType = ctx.data[offset + 5];
+	}
+
+	if (ctx.fields)
+	{
+		DescribeTls(ctx, offset, end);
+	}
+	return true;
+}
+
+static void DescribeHttp(DissectContext& ctx, size_t offset, size_t end)
+{
+	const bool request = HttpMessage::IsRequestStart(ctx.data + offset, end - offset);
+	const size_t headEnd = HttpMessage::FindHeadEnd(ctx.data + offset, end - offset);
+	const size_t headSize = headEnd != 0 ? headEnd : end - offset;
+
+	PacketField& layer = *AddLayer(ctx, "HTTP", offset, headSize);
+	layer.value = std::string(HttpMessage::FirstLine(ctx.data + offset, end - offset));
+
+	// One field per head line, the first is the request or status line
+	constexpr int maxLines = 64;
+	size_t position = offset;
+	for (int i = 0; i < maxLines && position < offset + headSize; ++i)
+	{
+		const size_t lineEnd = position + HttpMessage::Find(ctx.data + position, offset + headSize - position, '\n');
+		const std::string_view line = HttpMessage::FirstLine(ctx.data + position, offset + headSize - position);
+		if (line.empty()) break;
+
+		const size_t colon = line.find(':');
+		if (i == 0)
+		{
+			layer.Add(request ? "Request Line" : "Status Line", std::string(line), position, lineEnd - position);
 		}
-		case 17: // UDP
+		else if (colon != std::string_view::npos)
 		{
-			pkt.transportProtocol = "UDP";
-			if (pkt.data.size() < transportOffset + sizeof(UDPHeader)) return;
+			const size_t valueStart = line.find_first_not_of(' ', colon + 1);
+			layer.Add(std::string(line.substr(0, colon)), std::string(valueStart != std::string_view::npos ? line.substr(valueStart) : std::string_view()), position, lineEnd - position);
+		}
+		position = lineEnd + 1;
+	}
 
-			const auto* udp = reinterpret_cast<const UDPHeader*>(pkt.data.data() + transportOffset);
-			pkt.srcPort = ntohs(udp->src_port);
-			pkt.dstPort = ntohs(udp->dst_port);
-			break;
+	if (headEnd == 0)
+	{
+		layer.Add("Head", "Continues in later segments", end, 0);
+	}
+	else if (offset + headEnd < end)
+	{
+		layer.Add("Body", std::to_string(end - offset - headEnd) + " bytes in this segment", offset + headEnd, end - offset - headEnd);
+	}
+}
+
+// Marks segments that start a request or response. Pairing and timing happen on the
+// reassembled streams, the capture path only looks at the first bytes.
+static bool DissectHttp(DissectContext& ctx, size_t offset)
+{
+	PacketLayers& layers = ctx.layers;
+	const size_t end = std::min<size_t>(ctx.size, static_cast<size_t>(layers.payloadOffset) + layers.payloadLength);
+	if (end <= offset) return false;
+	if (!HttpMessage::IsRequestStart(ctx.data + offset, end - offset) && !HttpMessage::IsResponseStart(ctx.data + offset, end - offset)) return false;
+
+	layers.application = PacketLayers::Application::HTTP;
+	if (ctx.fields)
+	{
+		DescribeHttp(ctx, offset, end);
+	}
+	return true;
+}
+
+static void DescribeQuic(DissectContext& ctx, size_t offset, size_t end, const QuicHeader& header)
+{
+	PacketField& layer = *AddLayer(ctx, "QUIC", offset, end - offset);
+	layer.value = QuicPacket::TypeName(header.type);
+	layer.Add("Header Form", header.IsLongHeader() ? "Long" : "Short", offset, 1);
+	layer.Add("Packet Type", QuicPacket::TypeName(header.type), offset, 1);
+	if (!header.IsLongHeader())
+	{
+		// The connection ID length is only known to the endpoints
+		layer.Add("Protected Payload", std::to_string(end - offset - 1) + " bytes", offset + 1, end - offset - 1);
+		return;
+	}
+
+	layer.Add("Version", QuicPacket::VersionName(header.version), offset + 1, 4);
+	const size_t dcidOffset = offset + 6;
+	const size_t scidOffset = dcidOffset + header.dcidLength + 1;
+	layer.Add("Destination Connection ID Length", std::to_string(header.dcidLength), offset + 5, 1);
+	layer.Add("Destination Connection ID", QuicPacket::FormatConnectionId(header.dcid, header.dcidLength), dcidOffset, header.dcidLength);
+	layer.Add("Source Connection ID Length", std::to_string(header.scidLength), scidOffset - 1, 1);
+	layer.Add("Source Connection ID", QuicPacket::FormatConnectionId(header.scid, header.scidLength), scidOffset, header.scidLength);
+
+	const size_t rest = scidOffset + header.scidLength;
+	if (header.type == QuicHeader::Type::VersionNegotiation)
+	{
+		for (size_t position = rest; position + 4 <= end; position += 4)
+		{
+			layer.Add("Supported Version", QuicPacket::VersionName(ReadU32(ctx.data + position)), position, 4);
 		}
-		default:
-			pkt.transportProtocol = "Other";
-			break;
+	}
+	else if (rest < end)
+	{
+		layer.Add("Protected Payload", std::to_string(end - rest) + " bytes, not decrypted", rest, end - rest);
+	}
+}
+
+// Recognises the QUIC invariant header, connections are grouped by ID after parsing
+static bool DissectQuic(DissectContext& ctx, size_t offset)
+{
+	PacketLayers& layers = ctx.layers;
+	const size_t end = std::min<size_t>(ctx.size, static_cast<size_t>(layers.payloadOffset) + layers.payloadLength);
+	QuicHeader header;
+	if (end <= offset || !QuicPacket::Parse(ctx.data + offset, end - offset, header)) return false;
+
+	layers.application = PacketLayers::Application::QUIC;
+	if (ctx.fields)
+	{
+		DescribeQuic(ctx, offset, end, header);
+	}
+	return true;
+}
+
+static void DispatchTransport(DissectContext& ctx, size_t offset)
+{
+	// Ports are read from the first 4 bytes, so the transport layer only counts once they are present
+	if (ctx.size >= offset + 4)
+	{
+		ctx.layers.transportOffset = static_cast<uint16_t>(offset);
+	}
+	ctx.registry.DispatchIpProtocol(ctx.layers.ipProtocol, ctx, offset);
+}
+
+static void DescribeIPv4(DissectContext& ctx, const IPv4Header* ip, size_t offset, uint8_t ipHeaderLen)
+{
+	const PacketLayers& layers = ctx.layers;
+	PacketField& layer = *AddLayer(ctx, "IPv4", offset, ipHeaderLen);
+	layer.value = layers.srcAddr.ToString() + " -> " + layers.dstAddr.ToString();
+	const uint16_t fragment = ntohs(ip->frag_off);
+	layer.Add("Version", std::to_string(ip->ihl_version >> 4), offset, 1);
+	layer.Add("Header Length", FormatFieldValue("%u bytes", ipHeaderLen), offset, 1);
+	layer.Add("DSCP", std::to_string(ip->tos >> 2), offset + 1, 1);
+	layer.Add("ECN", std::to_string(ip->tos & 0x03), offset + 1, 1);
+	layer.Add("Total Length", std::to_string(ntohs(ip->tot_len)), offset + 2, 2);
+	layer.Add("Identification", FormatFieldValue("0x%04x", ntohs(ip->id)), offset + 4, 2);
+	PacketField& flags = layer.Add("Flags", FormatFieldValue("0x%x", fragment >> 13), offset + 6, 1);
+	flags.Add("Don't Fragment", (fragment & 0x4000) ? "Set" : "Not set", offset + 6, 1);
+	flags.Add("More Fragments", (fragment & 0x2000) ? "Set" : "Not set", offset + 6, 1);
+	layer.Add("Fragment Offset", std::to_string((fragment & 0x1FFF) * 8), offset + 6, 2);
+	layer.Add("TTL", std::to_string(ip->ttl), offset + 8, 1);
+	layer.Add("Protocol", FormatIpProtocol(ctx, ip->protocol), offset + 9, 1);
+	layer.Add("Header Checksum", FormatFieldValue("0x%04x", ntohs(ip->check)), offset + 10, 2);
+	layer.Add("Source", layers.srcAddr.ToString(), offset + 12, 4);
+	layer.Add("Destination", layers.dstAddr.ToString(), offset + 16, 4);
+}
+
+static bool DissectIPv4(DissectContext& ctx, size_t offset)
+{
+	PacketLayers& layers = ctx.layers;
+	if (ctx.size < offset + sizeof(IPv4Header)) return false;
+
+	const auto* ip = reinterpret_cast<const IPv4Header*>(ctx.data + offset);
+	const uint8_t ipHeaderLen = (ip->ihl_version & 0x0F) * 4;
+	if (ipHeaderLen < sizeof(IPv4Header)) return false; // Would put the transport layer inside the IP header
+
+	layers.networkOffset = static_cast<uint16_t>(offset);
+	layers.srcAddr = IpAddress::FromIPv4(ReadU32(reinterpret_cast<const uint8_t*>(&ip->saddr)));
+	layers.dstAddr = IpAddress::FromIPv4(ReadU32(reinterpret_cast<const uint8_t*>(&ip->daddr)));
+	layers.ttl = ip->ttl;
+	layers.ipProtocol = ip->protocol;
+
+	// A zero total length shows up on captured TSO segments, fall back to the captured size
+	const uint16_t totalLength = ntohs(ip->tot_len);
+	ctx.networkEnd = totalLength >= ipHeaderLen ? offset + totalLength : ctx.size;
+
+	// Only the first fragment carries the transport header
+	const uint16_t fragmentField = ntohs(ip->frag_off);
+	layers.fragment = (fragmentField & 0x1FFF) != 0;
+	layers.moreFragments = !layers.fragment && (fragmentField & 0x2000) != 0;
+
+	if (ctx.fields)
+	{
+		DescribeIPv4(ctx, ip, offset, ipHeaderLen);
+	}
+
+	// Options cut off by the snap length leave no transport header to find
+	if (!layers.fragment && offset + ipHeaderLen <= ctx.size)
+	{
+		DispatchTransport(ctx, offset + ipHeaderLen);
+	}
+	return true;
+}
+
+static PacketField* DescribeIPv6(DissectContext& ctx, const IPv6Header* ip, size_t offset)
+{
+	const PacketLayers& layers = ctx.layers;
+	PacketField* layer = AddLayer(ctx, "IPv6", offset, sizeof(IPv6Header));
+	layer->value = layers.srcAddr.ToString() + " -> " + layers.dstAddr.ToString();
+	const uint32_t versionClassFlow = ntohl(ip->version_class_flow);
+	layer->Add("Version", std::to_string(versionClassFlow >> 28), offset, 1);
+	layer->Add("Traffic Class", FormatFieldValue("0x%02x", (versionClassFlow >> 20) & 0xFF), offset, 2);
+	layer->Add("Flow Label", FormatFieldValue("0x%05x", versionClassFlow & 0xFFFFF), offset + 1, 3);
+	layer->Add("Payload Length", std::to_string(ntohs(ip->payload_len)), offset + 4, 2);
+	layer->Add("Next Header", FormatIpProtocol(ctx, ip->next_header), offset + 6, 1);
+	layer->Add("Hop Limit", std::to_string(ip->hop_limit), offset + 7, 1);
+	layer->Add("Source", layers.srcAddr.ToString(), offset + 8, 16);
+	layer->Add("Destination", layers.dstAddr.ToString(), offset + 24, 16);
+	return layer;
+}
+
+static bool DissectIPv6(DissectContext& ctx, size_t offset)
+{
+	PacketLayers& layers = ctx.layers;
+	if (ctx.size < offset + sizeof(IPv6Header)) return false;
+
+	const auto* ip = reinterpret_cast<const IPv6Header*>(ctx.data + offset);
+	if ((ctx.data[offset] >> 4) != 6) return false;
+
+	layers.networkOffset = static_cast<uint16_t>(offset);
+	layers.srcAddr = IpAddress::FromIPv6(ip->saddr);
+	layers.dstAddr = IpAddress::FromIPv6(ip->daddr);
+	layers.ttl = ip->hop_limit;
+
+	// Jumbograms carry a zero payload length
+	const uint16_t payloadLength = ntohs(ip->payload_len);
+	ctx.networkEnd = payloadLength ? offset + sizeof(IPv6Header) + payloadLength : ctx.size;
+
+	PacketField* layer = ctx.fields ? DescribeIPv6(ctx, ip, offset) : nullptr;
+
+	// Walk a bounded number of extension headers. Their kind comes from a table and their
+	// length from the kind, so the loop has no per-protocol branches.
+	uint8_t nextHeader = ip->next_header;
+	offset += sizeof(IPv6Header);
+	for (int i = 0; i < maxExtensionHeaders; ++i)
+	{
+		const uint8_t kind = extensionKinds[nextHeader];
+		if (kind == ExtNone || ctx.size < offset + 8) break;
+
+		const uint8_t* ext = ctx.data + offset;
+		size_t length = (static_cast<size_t>(ext[1]) + 1) * 8;
+		if (kind == ExtFragment)
+		{
+			length = 8;
+			// Only the first fragment carries the transport header
+			const uint16_t fragmentField = ReadU16(ext + 2);
+			layers.fragment = (fragmentField & 0xFFF8) != 0;
+			layers.moreFragments = !layers.fragment && (fragmentField & 0x0001) != 0;
+		}
+		else if (kind == ExtAuth)
+		{
+			length = (static_cast<size_t>(ext[1]) + 2) * 4;
+		}
+
+		if (layer)
+		{
+			static const char* const kindNames[] = { "", "Options", "Fragment", "Authentication" };
+			PacketField& header = layer->Add("Extension Header", kindNames[kind], offset, length);
+			header.Add("Next Header", FormatIpProtocol(ctx, ext[0]), offset, 1);
+			layer->length += static_cast<uint32_t>(length);
+		}
+
+		nextHeader = ext[0];
+		offset += length;
+		++layers.ipv6ExtensionHeaders;
+	}
+
+	layers.ipProtocol = nextHeader;
+	if (!layers.fragment && extensionKinds[nextHeader] == ExtNone)
+	{
+		DispatchTransport(ctx, offset);
+	}
+	return true;
+}
+
+static void DescribeEthernet(DissectContext& ctx, const EthernetHeader* eth, uint16_t etherType, size_t offset)
+{
+	PacketField& layer = *AddLayer(ctx, "Ethernet", offset, sizeof(EthernetHeader));
+	layer.value = FormatMac(eth->src) + " -> " + FormatMac(eth->dst);
+	layer.Add("Destination", FormatMac(eth->dst), offset, 6);
+	layer.Add("Source", FormatMac(eth->src), offset + 6, 6);
+	layer.Add("Type", FormatEtherType(ctx, etherType), offset + 12, 2);
+}
+
+static bool DissectEthernet(DissectContext& ctx, size_t offset)
+{
+	if (ctx.size < offset + sizeof(EthernetHeader)) return false;
+
+	const auto* eth = reinterpret_cast<const EthernetHeader*>(ctx.data + offset);
+	const uint16_t etherType = ReadU16(reinterpret_cast<const uint8_t*>(&eth->type));
+	if (ctx.fields)
+	{
+		DescribeEthernet(ctx, eth, etherType, offset);
+	}
+	DispatchEtherType(ctx, etherType, offset + sizeof(EthernetHeader));
+	return true;
+}
+
+// Built-in dissectors. They all run on the capture path, their field trees are only built
+// when ctx.fields is set for deep dissection.
+static std::unique_ptr<DissectorRegistry> CreateRegistry()
+{
+	auto registry = std::make_unique<DissectorRegistry>();
+
+	registry->RegisterEtherType(0x0800, { "IPv4", DissectIPv4 });
+	registry->RegisterEtherType(0x86DD, { "IPv6", DissectIPv6 });
+	registry->RegisterEtherType(ArpPacket::etherType, { "ARP", DissectArp });
+
+	// 802.1Q, 802.1ad (QinQ outer tag) and the pre-standard QinQ TPID
+	const Dissector vlan{ "VLAN", DissectVlan };
+	registry->RegisterEtherType(0x8100, vlan);
+	registry->RegisterEtherType(0x88A8, vlan);
+	registry->RegisterEtherType(0x9100, vlan);
+
+	const Dissector mpls{ "MPLS", DissectMpls };
+	registry->RegisterEtherType(0x8847, mpls);
+	registry->RegisterEtherType(0x8848, mpls);
+
+	registry->RegisterIpProtocol(IcmpMessage::protocolV4, { "ICMP", DissectIcmpV4 });
+	registry->RegisterIpProtocol(6, { "TCP", DissectTcp });
+	registry->RegisterIpProtocol(17, { "UDP", DissectUdp });
+	registry->RegisterIpProtocol(47, { "GRE", DissectGre });
+	registry->RegisterIpProtocol(IcmpMessage::protocolV6, { "ICMPv6", DissectIcmpV6 });
+
+	registry->RegisterPort(DissectorRegistry::Transport::UDP, vxlanPort, { "VXLAN", DissectVxlan });
+	registry->RegisterPort(DissectorRegistry::Transport::UDP, DnsMessage::port, { "DNS", DissectDns });
+
+	// HTTPS, DNS over TLS, implicit-TLS mail and directory ports, SIP over TLS
+	const Dissector tls{ "TLS", DissectTls };
+	for (const uint16_t port : { 443, 465, 636, 853, 993, 995, 5061, 8443 })
+	{
+		registry->RegisterPort(DissectorRegistry::Transport::TCP, port, tls);
+	}
+
+	// HTTP/3 and the common alternate port
+	const Dissector quic{ "QUIC", DissectQuic };
+	registry->RegisterPort(DissectorRegistry::Transport::UDP, QuicPacket::port, quic);
+	registry->RegisterPort(DissectorRegistry::Transport::UDP, 8443, quic);
+
+	// Plain HTTP and the usual alternate and proxy ports
+	const Dissector http{ "HTTP", DissectHttp };
+	for (const uint16_t port : { 80, 3128, 8000, 8008, 8080, 8888 })
+	{
+		registry->RegisterPort(DissectorRegistry::Transport::TCP, port, http);
+	}
+	return registry;
+}
+
+DissectorRegistry& PacketParser::GetDissectors()
+{
+	static const std::unique_ptr<DissectorRegistry> registry = CreateRegistry();
+	return *registry;
+}
+
+void PacketParser::ParseLayers(const uint8_t* data, size_t size, PacketLayers& layers, const ParserOptions& options)
+{
+	layers = PacketLayers{};
+	DissectContext ctx{ GetDissectors(), data, size, layers, options };
+	DissectEthernet(ctx, 0);
+}
+
+void PacketParser::DissectFields(PacketInfo& pkt, const ParserOptions& options)
+{
+	// Layers are re-derived from the stored bytes only, the capture-time layer map is kept as is
+	PacketLayers layers;
+	pkt.extraFields.clear();
+
+	DissectContext ctx{ GetDissectors(), pkt.data.data(), pkt.data.size(), layers, options };
+	ctx.fields = &pkt.extraFields;
+	DissectEthernet(ctx, 0);
+
+	// Analysis comes from the connection state at capture time, not from this packet's bytes
+	const TcpAnalysis& analysis = pkt.tcpAnalysis;
+	if (layers.IsTcp() && (analysis.flags != 0 || analysis.rttUs != 0 || analysis.handshakeRttUs != 0))
+	{
+		PacketField& layer = *AddLayer(ctx, "TCP Analysis", layers.transportOffset, layers.payloadOffset - layers.transportOffset);
+		if (analysis.Has(TcpAnalysis::Retransmission)) layer.Add("Retransmission", "Data was already seen", layer.offset, 0);
+		if (analysis.Has(TcpAnalysis::OutOfOrder)) layer.Add("Out-Of-Order", "Fills in below the highest sequence", layer.offset, 0);
+		if (analysis.Has(TcpAnalysis::DuplicateAck)) layer.Add("Duplicate ACK", std::to_string(layers.tcpAck), layer.offset, 0);
+		if (analysis.Has(TcpAnalysis::ZeroWindow)) layer.Add("Zero Window", "Receiver buffer full", layer.offset, 0);
+		if (analysis.rttUs != 0) layer.Add("ACK RTT", FormatFieldValue("%.3f ms", analysis.rttUs / 1000.0), layer.offset, 0);
+		if (analysis.handshakeRttUs != 0) layer.Add("Handshake RTT", FormatFieldValue("%.3f ms", analysis.handshakeRttUs / 1000.0), layer.offset, 0);
+		layer.value = std::to_string(layer.children.size()) + (layer.children.size() == 1 ? " finding" : " findings");
+	}
+
+	if (pkt.layers.reassembledFragments != 0 && layers.HasNetwork())
+	{
+		AddLayer(ctx, "IP Reassembly", layers.networkOffset, pkt.data.size() - layers.networkOffset)->value =
+			FormatFieldValue("Rebuilt from %u fragments", pkt.layers.reassembledFragments);
 	}
 
+	if (layers.payloadOffset != 0 && layers.payloadOffset < pkt.data.size())
+	{
+		const size_t payloadSize = pkt.data.size() - layers.payloadOffset;
+		AddLayer(ctx, "Payload", layers.payloadOffset, payloadSize)->value = FormatFieldValue("%zu bytes", payloadSize);
+	}
+	pkt.dissected = true;
+}
+
+void PacketParser::ParsePacket(const uint8_t* data, size_t size, PacketInfo& pkt, const LocalNetworks& localNetworks, const ParserOptions& options)
+{
+	ParseLayers(data, size, pkt.layers, options);
+	if (!pkt.layers.HasNetwork()) return;
+
 	// Determine packet direction: incoming if source IP is not local
-	bool srcIsLocal = IsLocalAddress(pkt.srcIP);
-	bool dstIsLocal = IsLocalAddress(pkt.dstIP);
+	bool srcIsLocal = localNetworks.IsLocal(pkt.layers.srcAddr);
+	bool dstIsLocal = localNetworks.IsLocal(pkt.layers.dstAddr);
 
 	// If source is external and destination local -> incoming
 	// If source is local and destination external -> outgoing
 
 	pkt.incoming = !srcIsLocal && dstIsLocal;
 }
-
@@ -1,9 +1,26 @@
 #pragma once
 #include "PacketInfo.h"
+#include "LocalNetworks.h"
+#include "DissectorRegistry.h"
+#include <cstddef>
 #include <cstdint>
 
 class PacketParser
 {
 public:
-	static void ParsePacket(PacketInfo& pkt);
-};
\ No newline at end of file
+	// Parses a captured frame into pkt.layers and sets the packet direction from the local networks.
+	// The frame may be longer than the bytes kept in pkt.data.
+	static void ParsePacket(const uint8_t* data, size_t size, PacketInfo& pkt, const LocalNetworks& localNetworks, const ParserOptions& options = {});
+
+	// Allocation-free parse that only records layer offsets and key header fields.
+	// VLAN tags and MPLS labels are stripped before IP.
+	static void ParseLayers(const uint8_t* data, size_t size, PacketLayers& layers, const ParserOptions& options = {});
+
+	// Deep decode of the stored bytes into pkt.extraFields, the dissectors build their field trees.
+	// Meant for the one packet being inspected, not for the capture path.
+	static void DissectFields(PacketInfo& pkt, const ParserOptions& options = {});
+
+	// Dissectors used by both parse functions, pre-filled with the built-in protocols.
+	// Register additional protocols before capture starts.
+	static DissectorRegistry& GetDissectors();
+};
@@ -0,0 +1,363 @@
+#include "PacketRule.h"
+#include "LocalNetworks.h"
+#include "PatternMatcher.h"
+#include <charconv>
+
+namespace
+{
+	struct Token
+	{
+		std::string text;
+		size_t quoteStart = std::string::npos; // Where the quoted part begins in text, npos = unquoted
+	};
+
+	bool IsSpace(char c)
+	{
+		return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+	}
+
+	// Splits on whitespace. Double quotes group text and are dropped, \" and \\ escape inside them.
+	bool Tokenize(std::string_view text, std::vector<Token>& tokens, std::string& error)
+	{
+		size_t i = 0;
+		while (i < text.size())
+		{
+			if (IsSpace(text[i]))
+			{
+				++i;
+				continue;
+			}
+
+			Token token;
+			bool quoted = false;
+			for (; i < text.size() && (quoted || !IsSpace(text[i])); ++i)
+			{
+				const char c = text[i];
+				if (c == '"')
+				{
+					if (!quoted && token.quoteStart == std::string::npos) token.quoteStart = token.text.size();
+					quoted = !quoted;
+				}
+				else if (quoted && c == '\\' && i + 1 < text.size())
+				{
+					token.text += text[++i];
+				}
+				else
+				{
+					token.text += c;
+				}
+			}
+			if (quoted)
+			{
+				error = "Unterminated quote";
+				return false;
+			}
+			tokens.push_back(std::move(token));
+		}
+		return true;
+	}
+
+	bool ParseNumber(const std::string& text, uint32_t max, uint16_t& value)
+	{
+		uint32_t number = 0;
+		const auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), number);
+		if (ec != std::errc() || end != text.data() + text.size() || number > max) return false;
+		value = static_cast<uint16_t>(number);
+		return true;
+	}
+
+	IpAddress MaskAddress(IpAddress address, uint8_t length)
+	{
+		if (address.IsIPv4())
+		{
+			address.low &= length == 0 ? 0 : (0xFFFFFFFFull << (32 - length)) & 0xFFFFFFFFull;
+		}
+		else
+		{
+			address.high &= length == 0 ? 0 : (length >= 64 ? ~0ull : ~0ull << (64 - length));
+			address.low &= length <= 64 ? 0 : (length >= 128 ? ~0ull : ~0ull << (128 - length));
+		}
+		return address;
+	}
+
+	bool MatchesAddress(const RuleCondition& condition, const IpAddress& address)
+	{
+		return address.version == condition.network.version && MaskAddress(address, condition.prefixLength) == condition.network;
+	}
+
+	bool ParseProtocol(const std::string& text, RuleCondition::Protocol& protocol)
+	{
+		static const std::pair<const char*, RuleCondition::Protocol> names[] = {
+			{ "tcp", RuleCondition::Protocol::Tcp }, { "udp", RuleCondition::Protocol::Udp }, { "icmp", RuleCondition::Protocol::Icmp },
+			{ "arp", RuleCondition::Protocol::Arp }, { "ip", RuleCondition::Protocol::Ip }, { "ip6", RuleCondition::Protocol::Ip6 }
+		};
+		for (const auto& [name, value] : names)
+		{
+			if (text == name)
+			{
+				protocol = value;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool HasPorts(const PacketLayers& layers)
+	{
+		return layers.HasTransport() && (layers.ipProtocol == 6 || layers.ipProtocol == 17);
+	}
+}
+
+bool RuleCondition::Matches(const PacketLayers& layers) const
+{
+	bool result = false;
+	switch (kind)
+	{
+		case Kind::Protocol:
+			switch (protocol)
+			{
+				case Protocol::Tcp: result = layers.HasNetwork() && !layers.IsArp() && layers.ipProtocol == 6; break;
+				case Protocol::Udp: result = layers.HasNetwork() && !layers.IsArp() && layers.ipProtocol == 17; break;
+				case Protocol::Icmp: result = layers.IsIcmp(); break;
+				case Protocol::Arp: result = layers.IsArp(); break;
+				case Protocol::Ip: result = !layers.IsArp() && layers.srcAddr.IsIPv4(); break;
+				case Protocol::Ip6: result = layers.srcAddr.IsIPv6(); break;
+			}
+			break;
+
+		case Kind::Address:
+			result = (direction != Direction::Destination && MatchesAddress(*this, layers.srcAddr)) ||
+				(direction != Direction::Source && MatchesAddress(*this, layers.dstAddr));
+			break;
+
+		case Kind::Port:
+			result = HasPorts(layers) &&
+				((direction != Direction::Destination && layers.srcPort >= low && layers.srcPort <= high) ||
+				(direction != Direction::Source && layers.dstPort >= low && layers.dstPort <= high));
+			break;
+
+		case Kind::Vlan:
+			for (uint8_t i = 0; i < layers.vlanCount; ++i)
+			{
+				result |= layers.vlanIds[i] == low;
+			}
+			break;
+
+		case Kind::TcpFlags:
+			result = layers.IsTcp() && (layers.tcpFlags & tcpFlags) == tcpFlags;
+			break;
+	}
+	return result != negate;
+}
+
+bool PacketRule::MatchesHeaders(const PacketLayers& layers) const
+{
+	for (const RuleCondition& condition : conditions)
+	{
+		if (!condition.Matches(layers)) return false;
+	}
+	return true;
+}
+
+bool PacketRule::Parse(std::string_view line, PacketRule& rule, std::string& error)
+{
+	rule = PacketRule{};
+
+	auto trim = [](std::string_view text)
+	{
+		while (!text.empty() && IsSpace(text.front())) text.remove_prefix(1);
+		while (!text.empty() && IsSpace(text.back())) text.remove_suffix(1);
+		return text;
+	};
+
+	const size_t colon = line.find(':');
+	if (colon == std::string_view::npos)
+	{
+		error = "Expected 'name: conditions'";
+		return false;
+	}
+	rule.name = trim(line.substr(0, colon));
+	rule.expression = trim(line.substr(colon + 1));
+	if (rule.name.empty())
+	{
+		error = "Rule has no name";
+		return false;
+	}
+
+	std::vector<Token> tokens;
+	if (!Tokenize(rule.expression, tokens, error)) return false;
+	if (tokens.empty())
+	{
+		error = "Rule has no conditions";
+		return false;
+	}
+
+	size_t i = 0;
+	auto next = [&](const char* what) -> const Token*
+	{
+		if (i < tokens.size()) return &tokens[i++];
+		error = std::string("Expected ") + what + " at the end";
+		return nullptr;
+	};
+
+	while (true)
+	{
+		const Token* token = next("a condition");
+		if (!token) return false;
+
+		RuleCondition condition;
+		if (token->text == "not" || token->text == "!")
+		{
+			condition.negate = true;
+			if (!(token = next("a condition after 'not'"))) return false;
+		}
+		if (token->text == "src" || token->text == "dst")
+		{
+			condition.direction = token->text == "src" ? RuleCondition::Direction::Source : RuleCondition::Direction::Destination;
+			if (!(token = next("host, net, port or portrange"))) return false;
+			if (token->text != "host" && token->text != "net" && token->text != "port" && token->text != "portrange")
+			{
+				error = "Expected host, net, port or portrange after '" + std::string(condition.direction == RuleCondition::Direction::Source ? "src" : "dst") + "'";
+				return false;
+			}
+		}
+
+		const std::string& keyword = token->text;
+		if (ParseProtocol(keyword, condition.protocol))
+		{
+			condition.kind = RuleCondition::Kind::Protocol;
+		}
+		else if (keyword == "host" || keyword == "net")
+		{
+			const Token* value = next("an address");
+			if (!value) return false;
+			LocalNetworks parsed;
+			if (value->text.empty() || (keyword == "host" && value->text.find('/') != std::string::npos) || !parsed.AddPrefix(value->text))
+			{
+				error = "Not an address: '" + value->text + "'";
+				return false;
+			}
+			const LocalNetworks::Prefix prefix = parsed.GetPrefixes().front();
+			condition.kind = RuleCondition::Kind::Address;
+			condition.network = prefix.network;
+			condition.prefixLength = prefix.length;
+		}
+		else if (keyword == "port" || keyword == "portrange")
+		{
+			const Token* value = next("a port");
+			if (!value) return false;
+			condition.kind = RuleCondition::Kind::Port;
+			const size_t dash = keyword == "portrange" ? value->text.find('-') : std::string::npos;
+			const bool valid = keyword == "port"
+				? ParseNumber(value->text, 65535, condition.low)
+				: dash != std::string::npos && ParseNumber(value->text.substr(0, dash), 65535, condition.low) && ParseNumber(value->text.substr(dash + 1), 65535, condition.high);
+			if (keyword == "port") condition.high = condition.low;
+			if (!valid || condition.low > condition.high)
+			{
+				error = "Not a " + std::string(keyword == "port" ? "port" : "port range (low-high)") + ": '" + value->text + "'";
+				return false;
+			}
+		}
+		else if (keyword == "vlan")
+		{
+			const Token* value = next("a VLAN ID");
+			if (!value) return false;
+			condition.kind = RuleCondition::Kind::Vlan;
+			if (!ParseNumber(value->text, 4095, condition.low))
+			{
+				error = "Not a VLAN ID: '" + value->text + "'";
+				return false;
+			}
+		}
+		else if (keyword == "tcpflags")
+		{
+			// Letters as tcpdump prints them, all must be set
+			const Token* value = next("TCP flags");
+			if (!value) return false;
+			condition.kind = RuleCondition::Kind::TcpFlags;
+			static const std::string letters = "FSRPAUEC";
+			for (char c : value->text)
+			{
+				const size_t bit = letters.find(static_cast<char>(c >= 'a' && c <= 'z' ? c - 'a' + 'A' : c));
+				if (bit == std::string::npos)
+				{
+					error = "Unknown TCP flag '" + std::string(1, c) + "', use FSRPAUEC";
+					return false;
+				}
+				condition.tcpFlags |= static_cast<uint8_t>(1 << bit);
+			}
+			if (condition.tcpFlags == 0)
+			{
+				error = "No TCP flags given";
+				return false;
+			}
+		}
+		else if (keyword == "content")
+		{
+			if (condition.negate)
+			{
+				error = "Contents cannot be negated";
+				return false;
+			}
+			const Token* value = next("a content");
+			if (!value) return false;
+
+			// Quoted text, or hex: followed by the bytes, quoted when they contain spaces
+			RuleContent content;
+			const bool hex = value->quoteStart != 0 && PatternMatcher::IsHexPattern(value->text);
+			if (hex)
+			{
+				if (!PatternMatcher::ParsePattern(value->text, content.bytes, error)) return false;
+			}
+			else if (value->quoteStart == 0)
+			{
+				content.bytes.assign(value->text.begin(), value->text.end());
+				if (content.bytes.empty())
+				{
+					error = "Empty content";
+					return false;
+				}
+			}
+			else
+			{
+				error = "Content must be quoted text or hex:\"..\", got '" + value->text + "'";
+				return false;
+			}
+			if (i < tokens.size() && tokens[i].text == "nocase" && tokens[i].quoteStart == std::string::npos)
+			{
+				content.ignoreCase = !hex;
+				++i;
+			}
+			rule.contents.push_back(std::move(content));
+		}
+		else if (keyword == "or" || keyword == "||")
+		{
+			error = "'or' is not supported, write one rule per alternative";
+			return false;
+		}
+		else
+		{
+			error = "Unknown condition '" + keyword + "'";
+			return false;
+		}
+
+		if (keyword != "content")
+		{
+			rule.conditions.push_back(condition);
+		}
+
+		if (i == tokens.size()) break;
+		const std::string& joiner = tokens[i++].text;
+		if (joiner == "or" || joiner == "||")
+		{
+			error = "'or' is not supported, write one rule per alternative";
+			return false;
+		}
+		if (joiner != "and" && joiner != "&&")
+		{
+			error = "Expected 'and' before '" + joiner + "'";
+			return false;
+		}
+	}
+	return true;
+}
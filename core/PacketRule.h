@@ -0,0 +1,72 @@
+#pragma once
+#include "IpAddress.h"
+#include "PacketLayers.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// One header test of a rule, a small subset of BPF primitives
+struct RuleCondition
+{
+	enum class Kind : uint8_t
+	{
+		Protocol, // tcp, udp, icmp, arp, ip, ip6
+		Address, // host and net
+		Port, // port and portrange
+		Vlan,
+		TcpFlags // All the given flags set
+	};
+
+	enum class Protocol : uint8_t
+	{
+		Tcp,
+		Udp,
+		Icmp, // ICMP and ICMPv6
+		Arp,
+		Ip,
+		Ip6
+	};
+
+	enum class Direction : uint8_t
+	{
+		Either,
+		Source,
+		Destination
+	};
+
+	Kind kind = Kind::Protocol;
+	Direction direction = Direction::Either;
+	bool negate = false;
+	Protocol protocol = Protocol::Tcp;
+	IpAddress network; // Masked to prefixLength
+	uint8_t prefixLength = 0;
+	uint16_t low = 0; // Port range or VLAN ID, low == high for a single value
+	uint16_t high = 0;
+	uint8_t tcpFlags = 0;
+
+	bool Matches(const PacketLayers& layers) const;
+};
+
+// Payload byte pattern of a rule, searched from the transport payload on
+struct RuleContent
+{
+	std::vector<uint8_t> bytes;
+	bool ignoreCase = false;
+};
+
+// A named rule: header conditions and payload contents that must all hold. Written as
+//   name: tcp and dst port 80 and not src net 10.0.0.0/8 and content "GET /admin" nocase
+// Contents are quoted text or hex:"de ad be ef". Alternatives ("or") are separate rules.
+struct PacketRule
+{
+	std::string name;
+	std::string expression; // Everything after the name, as written
+	std::vector<RuleCondition> conditions;
+	std::vector<RuleContent> contents;
+
+	// Returns false with a message when the line is not a valid rule
+	static bool Parse(std::string_view line, PacketRule& rule, std::string& error);
+	bool MatchesHeaders(const PacketLayers& layers) const;
+	std::string ToString() const { return name + ": " + expression; }
+};
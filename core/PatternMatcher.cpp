@@ -0,0 +1,195 @@
+#include "PatternMatcher.h"
+#include <cstring>
+#include <deque>
+#include <limits>
+
+namespace
+{
+	constexpr uint32_t noState = std::numeric_limits<uint32_t>::max();
+
+	uint8_t ToLower(uint8_t c)
+	{
+		return (c >= 'A' && c <= 'Z') ? static_cast<uint8_t>(c - 'A' + 'a') : c;
+	}
+
+	int HexValue(char c)
+	{
+		if (c >= '0' && c <= '9') return c - '0';
+		if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+		if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+		return -1;
+	}
+}
+
+bool PatternMatcher::ParsePattern(std::string_view text, std::vector<uint8_t>& bytes, std::string& error)
+{
+	bytes.clear();
+	if (!IsHexPattern(text))
+	{
+		bytes.assign(text.begin(), text.end());
+	}
+	else
+	{
+		int high = -1;
+		for (char c : text.substr(4))
+		{
+			if (c == ' ' || c == ':') continue;
+			const int value = HexValue(c);
+			if (value < 0)
+			{
+				error = std::string("Not a hex digit: '") + c + "'";
+				return false;
+			}
+			if (high < 0)
+			{
+				high = value;
+			}
+			else
+			{
+				bytes.push_back(static_cast<uint8_t>(high << 4 | value));
+				high = -1;
+			}
+		}
+		if (high >= 0)
+		{
+			error = "Odd number of hex digits";
+			return false;
+		}
+	}
+
+	if (bytes.empty())
+	{
+		error = "Empty pattern";
+		return false;
+	}
+	return true;
+}
+
+uint32_t PatternMatcher::Add(std::vector<uint8_t> bytes, bool ignoreCase)
+{
+	patterns.push_back({ std::move(bytes), ignoreCase });
+	return static_cast<uint32_t>(patterns.size() - 1);
+}
+
+void PatternMatcher::Compile()
+{
+	foldCase = false;
+	for (const Pattern& pattern : patterns)
+	{
+		foldCase |= pattern.ignoreCase;
+	}
+	auto fold = [this](uint8_t c) { return foldCase ? ToLower(c) : c; };
+
+	// One class per byte the patterns use, case folding happens here rather than per scanned byte
+	std::array<uint16_t, 256> foldedClass{};
+	classCount = 1;
+	for (const Pattern& pattern : patterns)
+	{
+		for (uint8_t c : pattern.bytes)
+		{
+			const uint8_t folded = fold(c);
+			if (foldedClass[folded] == 0)
+			{
+				foldedClass[folded] = static_cast<uint16_t>(classCount++);
+			}
+		}
+	}
+	for (size_t b = 0; b < 256; ++b)
+	{
+		byteClass[b] = foldedClass[fold(static_cast<uint8_t>(b))];
+	}
+
+	// Trie over classes, missing edges are filled in by the breadth-first pass below
+	transitions.assign(classCount, noState);
+	std::vector<std::vector<uint32_t>> stateOutputs(1);
+	stateCount = 1;
+	for (uint32_t index = 0; index < patterns.size(); ++index)
+	{
+		const Pattern& pattern = patterns[index];
+		if (pattern.bytes.empty()) continue;
+
+		uint32_t state = 0;
+		for (uint8_t c : pattern.bytes)
+		{
+			uint32_t& next = transitions[state * classCount + byteClass[c]];
+			if (next == noState)
+			{
+				next = static_cast<uint32_t>(stateCount++);
+				transitions.resize(stateCount * classCount, noState);
+				stateOutputs.emplace_back();
+			}
+			state = transitions[state * classCount + byteClass[c]];
+		}
+		stateOutputs[state].push_back(index);
+	}
+
+	// Suffix links turn the trie into a DFA, each state inherits the outputs of its link
+	std::vector<uint32_t> fail(stateCount, 0);
+	std::deque<uint32_t> queue;
+	for (size_t c = 0; c < classCount; ++c)
+	{
+		uint32_t& next = transitions[c];
+		if (next == noState)
+		{
+			next = 0;
+		}
+		else
+		{
+			queue.push_back(next);
+		}
+	}
+	while (!queue.empty())
+	{
+		const uint32_t state = queue.front();
+		queue.pop_front();
+		const std::vector<uint32_t>& inherited = stateOutputs[fail[state]];
+		stateOutputs[state].insert(stateOutputs[state].end(), inherited.begin(), inherited.end());
+
+		for (size_t c = 0; c < classCount; ++c)
+		{
+			uint32_t& next = transitions[state * classCount + c];
+			const uint32_t viaLink = transitions[fail[state] * classCount + c];
+			if (next == noState)
+			{
+				next = viaLink;
+			}
+			else
+			{
+				fail[next] = viaLink;
+				queue.push_back(next);
+			}
+		}
+	}
+
+	outputStart.assign(stateCount + 1, 0);
+	outputs.clear();
+	for (size_t state = 0; state < stateCount; ++state)
+	{
+		outputStart[state] = static_cast<uint32_t>(outputs.size());
+		outputs.insert(outputs.end(), stateOutputs[state].begin(), stateOutputs[state].end());
+	}
+	outputStart[stateCount] = static_cast<uint32_t>(outputs.size());
+
+	for (size_t b = 0; b < 256; ++b)
+	{
+		leavesRoot[b] = transitions[byteClass[b]] != 0;
+	}
+}
+
+bool PatternMatcher::FindFirst(const uint8_t* data, size_t size, Match& match) const
+{
+	bool found = false;
+	ForEachMatch(data, size, [&](const Match& m)
+	{
+		match = m;
+		found = true;
+		return false;
+	});
+	return found;
+}
+
+bool PatternMatcher::Verify(uint32_t pattern, const uint8_t* data, size_t start) const
+{
+	const std::vector<uint8_t>& bytes = patterns[pattern].bytes;
+	return std::memcmp(data + start, bytes.data(), bytes.size()) == 0;
+}
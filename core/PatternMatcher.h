@@ -0,0 +1,88 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Multi-pattern byte search with an Aho-Corasick automaton compiled to a dense DFA. Bytes are
+// first mapped to equivalence classes (every byte that appears in no pattern shares one class),
+// so the table stays small with many patterns, and case folding costs nothing per byte because
+// it is part of the class map. A scan is one table step per byte however many patterns there are.
+class PatternMatcher
+{
+public:
+	struct Match
+	{
+		uint32_t pattern = 0;
+		size_t offset = 0; // First byte of the match
+	};
+
+	// "hex:48 54 54 50" (spaces optional) is a byte pattern, anything else is literal text.
+	// Returns false with a message when the pattern is empty or the hex is malformed.
+	static bool ParsePattern(std::string_view text, std::vector<uint8_t>& bytes, std::string& error);
+	static bool IsHexPattern(std::string_view text) { return text.starts_with("hex:"); }
+
+	// Returns the pattern index, patterns can only be added before Compile()
+	uint32_t Add(std::vector<uint8_t> bytes, bool ignoreCase);
+	void Compile();
+
+	bool Empty() const { return patterns.empty(); }
+	size_t GetPatternCount() const { return patterns.size(); }
+	size_t GetStateCount() const { return stateCount; }
+	size_t GetPatternLength(uint32_t pattern) const { return patterns[pattern].bytes.size(); }
+
+	// Match that ends first, false when there is none
+	bool FindFirst(const uint8_t* data, size_t size, Match& match) const;
+
+	// Calls onMatch(const Match&) for every match in order of its end, returning false stops the scan
+	template <typename Callback>
+	void ForEachMatch(const uint8_t* data, size_t size, Callback&& onMatch) const;
+
+private:
+	struct Pattern
+	{
+		std::vector<uint8_t> bytes;
+		bool ignoreCase = false;
+	};
+
+	std::vector<Pattern> patterns;
+	std::array<uint16_t, 256> byteClass{}; // Class 0 is every byte no pattern uses
+	std::array<bool, 256> leavesRoot{}; // Bytes that move the root state anywhere
+	size_t classCount = 1;
+	size_t stateCount = 0;
+	bool foldCase = false; // The class map folds case, case-sensitive patterns are verified on a match
+	std::vector<uint32_t> transitions; // stateCount x classCount
+	std::vector<uint32_t> outputStart; // Per state into outputs, stateCount + 1 entries
+	std::vector<uint32_t> outputs; // Pattern indexes ending in each state, via suffix links too
+
+	bool Verify(uint32_t pattern, const uint8_t* data, size_t start) const;
+};
+
+template <typename Callback>
+void PatternMatcher::ForEachMatch(const uint8_t* data, size_t size, Callback&& onMatch) const
+{
+	if (stateCount == 0) return;
+
+	uint32_t state = 0;
+	for (size_t i = 0; i < size; ++i)
+	{
+		// Most input never leaves the root, skip it without touching the transition table
+		if (state == 0)
+		{
+			while (i < size && !leavesRoot[data[i]]) ++i;
+			if (i == size) return;
+		}
+
+		state = transitions[state * classCount + byteClass[data[i]]];
+		for (uint32_t o = outputStart[state]; o < outputStart[state + 1]; ++o)
+		{
+			const uint32_t pattern = outputs[o];
+			const size_t start = i + 1 - patterns[pattern].bytes.size();
+			if (foldCase && !patterns[pattern].ignoreCase && !Verify(pattern, data, start)) continue;
+			const Match match{ pattern, start };
+			if (!onMatch(match)) return;
+		}
+	}
+}
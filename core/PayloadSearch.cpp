@@ -0,0 +1,286 @@
+#include "PayloadSearch.h"
+#include "PacketParser.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <limits>
+
+namespace
+{
+	constexpr size_t fileHeaderSize = 24;
+	constexpr size_t recordHeaderSize = 16;
+	constexpr uint32_t linkTypeEthernet = 1;
+
+	uint32_t ReadU32(const uint8_t* data, bool swapped)
+	{
+		uint32_t value;
+		std::memcpy(&value, data, sizeof(value));
+		if (swapped)
+		{
+			value = (value >> 24) | ((value >> 8) & 0xFF00) | ((value << 8) & 0xFF0000) | (value << 24);
+		}
+		return value;
+	}
+}
+
+PayloadSearch::~PayloadSearch()
+{
+	Cancel();
+}
+
+void PayloadSearch::Start(PatternMatcher newMatcher, std::vector<PacketRef> newPackets, const PayloadSearchOptions& newOptions)
+{
+	Cancel();
+	file.Close();
+	records.clear();
+
+	matcher = std::move(newMatcher);
+	options = newOptions;
+	packets = std::move(newPackets);
+	{
+		std::scoped_lock lock(hitsMutex);
+		hits.clear();
+	}
+	nextSegment = 0;
+	scannedPackets = 0;
+	scannedBytes = 0;
+	totalPackets = packets.size();
+	truncated = false;
+	cancelled = false;
+	running = true;
+	controller = std::thread(&PayloadSearch::Run, this);
+}
+
+bool PayloadSearch::StartFile(PatternMatcher newMatcher, const std::string& path, const LocalNetworks& networks, const PayloadSearchOptions& newOptions, std::string& error)
+{
+	Cancel();
+	packets.clear();
+	records.clear();
+	if (!file.Open(path, error) || !ReadFileHeader(error))
+	{
+		file.Close();
+		return false;
+	}
+
+	matcher = std::move(newMatcher);
+	options = newOptions;
+	localNetworks = networks;
+	{
+		std::scoped_lock lock(hitsMutex);
+		hits.clear();
+	}
+	nextSegment = 0;
+	scannedPackets = 0;
+	scannedBytes = 0;
+	totalPackets = 0; // Known once the file is indexed
+	truncated = false;
+	cancelled = false;
+	running = true;
+	controller = std::thread(&PayloadSearch::Run, this);
+	return true;
+}
+
+void PayloadSearch::Cancel()
+{
+	cancelled = true;
+	if (controller.joinable())
+	{
+		controller.join();
+	}
+}
+
+size_t PayloadSearch::GetHitCount() const
+{
+	std::scoped_lock lock(hitsMutex);
+	return hits.size();
+}
+
+void PayloadSearch::GetHits(size_t from, std::vector<SearchHit>& out) const
+{
+	std::scoped_lock lock(hitsMutex);
+	if (from < hits.size())
+	{
+		out.insert(out.end(), hits.begin() + from, hits.end());
+	}
+}
+
+bool PayloadSearch::ReadFileHeader(std::string& error)
+{
+	if (file.Size() < fileHeaderSize)
+	{
+		error = "Not a pcap file: too short";
+		return false;
+	}
+
+	// The magic number gives the timestamp resolution and the writer's byte order
+	const uint32_t magic = ReadU32(file.Data(), false);
+	switch (magic)
+	{
+		case 0xA1B2C3D4: swapped = false; nanoseconds = false; break;
+		case 0xD4C3B2A1: swapped = true; nanoseconds = false; break;
+		case 0xA1B23C4D: swapped = false; nanoseconds = true; break;
+		case 0x4D3CB2A1: swapped = true; nanoseconds = true; break;
+		default:
+			error = "Not a pcap file (pcapng is not supported)";
+			return false;
+	}
+
+	const uint32_t linkType = ReadU32(file.Data() + 20, swapped) & 0x0FFFFFFF;
+	if (linkType != linkTypeEthernet)
+	{
+		error = "Unsupported link type " + std::to_string(linkType) + ", only Ethernet dumps can be searched";
+		return false;
+	}
+	return true;
+}
+
+void PayloadSearch::IndexFile()
+{
+	// Records have to be walked in order to find where each starts, the scan itself is parallel
+	const uint8_t* data = file.Data();
+	const size_t size = file.Size();
+	size_t offset = fileHeaderSize;
+	while (offset + recordHeaderSize <= size)
+	{
+		Record record;
+		const int64_t seconds = ReadU32(data + offset, swapped);
+		const uint32_t fraction = ReadU32(data + offset + 4, swapped);
+		record.timestampUs = seconds * 1000000 + (nanoseconds ? fraction / 1000 : fraction);
+		record.capturedLength = ReadU32(data + offset + 8, swapped);
+		record.originalLength = ReadU32(data + offset + 12, swapped);
+		record.offset = offset + recordHeaderSize;
+
+		// A record running past the end is a dump that is still being written, or cut short
+		if (record.capturedLength > size - record.offset) break;
+		records.push_back(record);
+		offset = record.offset + record.capturedLength;
+
+		if ((records.size() & 0xFFFF) == 0)
+		{
+			totalPackets = records.size();
+			if (cancelled.load(std::memory_order_relaxed)) return;
+		}
+	}
+	totalPackets = records.size();
+}
+
+void PayloadSearch::Run()
+{
+	if (file.Data())
+	{
+		IndexFile();
+	}
+
+	const unsigned workerCount = std::max(1u, std::thread::hardware_concurrency());
+	std::vector<std::thread> workers;
+	for (unsigned i = 0; i < workerCount; ++i)
+	{
+		workers.emplace_back(&PayloadSearch::Worker, this);
+	}
+	for (std::thread& worker : workers)
+	{
+		worker.join();
+	}
+
+	// Hits hold their own packets, so the inputs can go
+	file.Close();
+	records = {};
+	packets = {};
+	running = false;
+}
+
+void PayloadSearch::Worker()
+{
+	const bool fromFile = !records.empty();
+	const size_t count = fromFile ? records.size() : packets.size();
+	const size_t segmentCount = (count + segmentPackets - 1) / segmentPackets;
+
+	// Only the first occurrence of each pattern in a packet is reported
+	std::vector<size_t> lastPacket(matcher.GetPatternCount(), std::numeric_limits<size_t>::max());
+	std::vector<SearchHit> segmentHits;
+	std::vector<PatternMatcher::Match> packetMatches;
+
+	for (size_t segment = nextSegment.fetch_add(1); segment < segmentCount; segment = nextSegment.fetch_add(1))
+	{
+		if (cancelled.load(std::memory_order_relaxed) || truncated.load(std::memory_order_relaxed)) return;
+
+		const size_t begin = segment * segmentPackets;
+		const size_t end = std::min(count, begin + segmentPackets);
+		uint64_t bytes = 0;
+		for (size_t i = begin; i < end; ++i)
+		{
+			const uint8_t* data;
+			size_t size;
+			size_t start = 0;
+			if (fromFile)
+			{
+				data = file.Data() + records[i].offset;
+				size = records[i].capturedLength;
+				if (options.payloadOnly)
+				{
+					PacketLayers layers;
+					PacketParser::ParseLayers(data, size, layers);
+					start = layers.payloadOffset;
+				}
+			}
+			else
+			{
+				data = packets[i]->data.data();
+				size = packets[i]->data.size();
+				start = options.payloadOnly ? packets[i]->layers.payloadOffset : 0;
+			}
+			// Without a transport payload there is nothing to search in payload-only mode
+			if (options.payloadOnly && (start == 0 || start >= size)) continue;
+
+			bytes += size - start;
+			packetMatches.clear();
+			matcher.ForEachMatch(data + start, size - start, [&](const PatternMatcher::Match& match)
+			{
+				if (lastPacket[match.pattern] != i)
+				{
+					lastPacket[match.pattern] = i;
+					packetMatches.push_back({ match.pattern, start + match.offset });
+				}
+				return true;
+			});
+			if (packetMatches.empty()) continue;
+
+			const PacketRef packet = fromFile ? ParseRecord(records[i]) : packets[i];
+			for (const PatternMatcher::Match& match : packetMatches)
+			{
+				segmentHits.push_back({ packet, match.pattern, match.offset });
+			}
+		}
+
+		scannedPackets.fetch_add(end - begin, std::memory_order_relaxed);
+		scannedBytes.fetch_add(bytes, std::memory_order_relaxed);
+		if (!Publish(segmentHits)) return;
+	}
+}
+
+bool PayloadSearch::Publish(std::vector<SearchHit>& segmentHits)
+{
+	std::scoped_lock lock(hitsMutex);
+	const size_t room = maxHits - std::min(maxHits, hits.size());
+	const size_t taken = std::min(room, segmentHits.size());
+	hits.insert(hits.end(), std::make_move_iterator(segmentHits.begin()), std::make_move_iterator(segmentHits.begin() + taken));
+	segmentHits.clear();
+	if (hits.size() >= maxHits)
+	{
+		truncated = true;
+		return false;
+	}
+	return true;
+}
+
+PacketRef PayloadSearch::ParseRecord(const Record& record) const
+{
+	auto packet = std::make_shared<PacketInfo>();
+	packet->timestamp = std::chrono::system_clock::time_point{ std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::microseconds{ record.timestampUs }) };
+	packet->length = record.originalLength;
+
+	const uint8_t* data = file.Data() + record.offset;
+	PacketParser::ParsePacket(data, record.capturedLength, *packet, localNetworks);
+	packet->data.assign(data, data + std::min<size_t>(record.capturedLength, 65535));
+	return packet;
+}
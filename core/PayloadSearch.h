@@ -0,0 +1,92 @@
+#pragma once
+#include "LocalNetworks.h"
+#include "MappedFile.h"
+#include "PacketInfo.h"
+#include "PatternMatcher.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// One pattern found in one packet, the first occurrence only
+struct SearchHit
+{
+	PacketRef packet; // Packets from a dump file are parsed for the hit and have sequence 0
+	uint32_t pattern = 0;
+	size_t offset = 0; // Into the frame
+};
+
+struct PayloadSearchOptions
+{
+	bool payloadOnly = false; // Skip the headers, start at the transport payload
+};
+
+// Background multi-pattern search over packet bytes, either the capture history or a pcap
+// dump mapped into memory. Packets are cut into segments that worker threads claim one at a
+// time, and each finished segment's hits are published at once so results can be shown while
+// the search is still running.
+class PayloadSearch
+{
+public:
+	static constexpr size_t maxHits = 100000; // The search stops once this many are found
+
+	~PayloadSearch();
+
+	// Both replace any search that is still running
+	void Start(PatternMatcher matcher, std::vector<PacketRef> packets, const PayloadSearchOptions& options);
+	bool StartFile(PatternMatcher matcher, const std::string& path, const LocalNetworks& localNetworks, const PayloadSearchOptions& options, std::string& error);
+	void Cancel(); // Waits for the workers
+
+	bool IsRunning() const { return running.load(); }
+	size_t GetScannedPackets() const { return scannedPackets.load(); }
+	size_t GetTotalPackets() const { return totalPackets.load(); }
+	uint64_t GetScannedBytes() const { return scannedBytes.load(); }
+	bool IsTruncated() const { return truncated.load(); }
+
+	// Appends the hits from index from on. Hits only ever grow until the next Start, so the
+	// caller keeps its own copy and asks for the new ones each frame.
+	size_t GetHitCount() const;
+	void GetHits(size_t from, std::vector<SearchHit>& out) const;
+
+private:
+	static constexpr size_t segmentPackets = 2048;
+
+	struct Record
+	{
+		size_t offset = 0; // Of the packet bytes in the mapping
+		uint32_t capturedLength = 0;
+		uint32_t originalLength = 0;
+		int64_t timestampUs = 0;
+	};
+
+	PatternMatcher matcher;
+	PayloadSearchOptions options;
+	std::vector<PacketRef> packets; // History search
+	MappedFile file; // Dump file search
+	bool swapped = false; // Written on a host of the other byte order
+	bool nanoseconds = false;
+	std::vector<Record> records; // Filled in by the controller before the workers start
+	LocalNetworks localNetworks;
+
+	std::thread controller; // Indexes the file if there is one, then runs the workers
+	std::atomic<bool> running{ false };
+	std::atomic<bool> cancelled{ false };
+	std::atomic<size_t> nextSegment{ 0 };
+	std::atomic<size_t> scannedPackets{ 0 };
+	std::atomic<size_t> totalPackets{ 0 };
+	std::atomic<uint64_t> scannedBytes{ 0 };
+	std::atomic<bool> truncated{ false };
+
+	mutable std::mutex hitsMutex;
+	std::vector<SearchHit> hits;
+
+	void Run();
+	void Worker();
+	bool ReadFileHeader(std::string& error);
+	void IndexFile();
+	bool Publish(std::vector<SearchHit>& segmentHits);
+	PacketRef ParseRecord(const Record& record) const;
+};
@@ -0,0 +1,90 @@
+#include "QuicPacket.h"
+#include <cstdio>
+
+namespace
+{
+	uint32_t ReadU32(const uint8_t* data)
+	{
+		return (static_cast<uint32_t>(data[0]) << 24) | (static_cast<uint32_t>(data[1]) << 16) | (static_cast<uint32_t>(data[2]) << 8) | data[3];
+	}
+
+	constexpr uint8_t longHeaderBit = 0x80;
+	constexpr uint8_t fixedBit = 0x40;
+}
+
+bool QuicPacket::Parse(const uint8_t* data, size_t size, QuicHeader& header)
+{
+	header = QuicHeader{};
+	if (size == 0) return false;
+
+	const uint8_t first = data[0];
+	if ((first & longHeaderBit) == 0)
+	{
+		// Short headers only promise the fixed bit, the connection ID length is known to the endpoints alone
+		if ((first & fixedBit) == 0 || size < 2) return false;
+		header.type = QuicHeader::Type::OneRtt;
+		return true;
+	}
+
+	// Flags, version, DCID length, DCID, SCID length, SCID
+	if (size < 7) return false;
+	header.version = ReadU32(data + 1);
+	header.dcidLength = data[5];
+	if (header.dcidLength > maxConnectionIdLength || size < 7u + header.dcidLength) return false;
+	header.dcid = data + 6;
+	header.scidLength = data[6 + header.dcidLength];
+	if (header.scidLength > maxConnectionIdLength || size < 7u + header.dcidLength + header.scidLength) return false;
+	header.scid = data + 7 + header.dcidLength;
+
+	if (header.version == 0)
+	{
+		header.type = QuicHeader::Type::VersionNegotiation;
+		return true;
+	}
+	if ((first & fixedBit) == 0) return false;
+
+	// v2 rotates the type codes by one
+	static constexpr QuicHeader::Type version1Types[] = { QuicHeader::Type::Initial, QuicHeader::Type::ZeroRtt, QuicHeader::Type::Handshake, QuicHeader::Type::Retry };
+	static constexpr QuicHeader::Type version2Types[] = { QuicHeader::Type::Retry, QuicHeader::Type::Initial, QuicHeader::Type::ZeroRtt, QuicHeader::Type::Handshake };
+	const uint8_t typeBits = (first >> 4) & 0x03;
+	header.type = header.version == version2 ? version2Types[typeBits] : version1Types[typeBits];
+	return true;
+}
+
+const char* QuicPacket::TypeName(QuicHeader::Type type)
+{
+	switch (type)
+	{
+		case QuicHeader::Type::Initial: return "Initial";
+		case QuicHeader::Type::ZeroRtt: return "0-RTT";
+		case QuicHeader::Type::Handshake: return "Handshake";
+		case QuicHeader::Type::Retry: return "Retry";
+		case QuicHeader::Type::VersionNegotiation: return "Version Negotiation";
+		case QuicHeader::Type::OneRtt: return "1-RTT";
+	}
+	return "Unknown";
+}
+
+std::string QuicPacket::VersionName(uint32_t version)
+{
+	if (version == version1) return "v1";
+	if (version == version2) return "v2";
+	if ((version & 0xFFFFFF00) == 0xFF000000) return "draft-" + std::to_string(version & 0xFF);
+
+	char text[16];
+	std::snprintf(text, sizeof(text), "0x%08x", version);
+	return text;
+}
+
+std::string QuicPacket::FormatConnectionId(const uint8_t* id, size_t length)
+{
+	static constexpr char digits[] = "0123456789abcdef";
+	std::string text;
+	text.reserve(length * 2);
+	for (size_t i = 0; i < length; ++i)
+	{
+		text += digits[id[i] >> 4];
+		text += digits[id[i] & 0x0F];
+	}
+	return text;
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// First QUIC packet of a datagram, as far as it can be read without keys
+struct QuicHeader
+{
+	enum class Type : uint8_t
+	{
+		Initial,
+		ZeroRtt,
+		Handshake,
+		Retry,
+		VersionNegotiation,
+		OneRtt // Short header
+	};
+
+	Type type = Type::OneRtt;
+	uint32_t version = 0; // Long header only
+	const uint8_t* dcid = nullptr; // Long header only, short headers do not carry the length
+	uint8_t dcidLength = 0;
+	const uint8_t* scid = nullptr;
+	uint8_t scidLength = 0;
+
+	bool IsLongHeader() const { return type != Type::OneRtt; }
+};
+
+// QUIC invariant header parsing (RFC 8999) with the v1 and v2 long header types.
+// Packet payloads are protected, so nothing past the connection IDs is interpreted.
+class QuicPacket
+{
+public:
+	static constexpr uint16_t port = 443;
+	static constexpr size_t maxConnectionIdLength = 20;
+	static constexpr uint32_t version1 = 0x00000001;
+	static constexpr uint32_t version2 = 0x6b3343cf;
+
+	// False when the bytes cannot be a QUIC packet
+	static bool Parse(const uint8_t* data, size_t size, QuicHeader& header);
+
+	static const char* TypeName(QuicHeader::Type type);
+	static std::string VersionName(uint32_t version); // e.g. "v1", "draft-29", "0xfaceb002"
+	static std::string FormatConnectionId(const uint8_t* id, size_t length); // Lower-case hex
+};
@@ -0,0 +1,192 @@
+#include "QuicTracker.h"
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstring>
+
+namespace
+{
+	constexpr size_t tableSize = 16384;
+	constexpr size_t maxUsed = tableSize * 3 / 4; // Keeps probe sequences short
+	constexpr int64_t idleTimeoutUs = 60ll * 1000 * 1000;
+	constexpr int64_t sweepIntervalUs = 5ll * 1000 * 1000;
+	constexpr int64_t fullSweepIntervalUs = 1000ll * 1000; // At most one eviction pass a second when full
+
+	int64_t ToMicroseconds(std::chrono::system_clock::time_point timestamp)
+	{
+		return std::chrono::duration_cast<std::chrono::microseconds>(timestamp.time_since_epoch()).count();
+	}
+
+	// FNV-1a, connection IDs are short and usually random already
+	size_t HashId(const uint8_t* id, uint8_t length)
+	{
+		uint64_t hash = 0xcbf29ce484222325ull ^ length;
+		for (uint8_t i = 0; i < length; ++i)
+		{
+			hash = (hash ^ id[i]) * 0x100000001b3ull;
+		}
+		return static_cast<size_t>(hash ^ (hash >> 32));
+	}
+}
+
+void QuicTracker::Process(PacketInfo& pkt, const uint8_t* frame, size_t size)
+{
+	const PacketLayers& layers = pkt.layers;
+	const size_t offset = layers.payloadOffset;
+	const size_t end = std::min<size_t>(size, offset + layers.payloadLength);
+	QuicHeader header;
+	if (end <= offset || !QuicPacket::Parse(frame + offset, end - offset, header)) return;
+
+	if (slots.empty())
+	{
+		slots.resize(tableSize);
+	}
+
+	const int64_t nowUs = ToMicroseconds(pkt.timestamp);
+	if (nowUs - lastSweepUs >= sweepIntervalUs)
+	{
+		Sweep(nowUs);
+		lastSweepUs = nowUs;
+	}
+
+	if (!header.IsLongHeader())
+	{
+		// The destination ID follows the first byte, try each length the endpoints chose
+		for (uint32_t lengths = lengthMask; lengths != 0; lengths &= lengths - 1)
+		{
+			const uint8_t length = static_cast<uint8_t>(std::countr_zero(lengths));
+			if (end - offset < 1u + length) break;
+
+			if (Slot* slot = Find(frame + offset + 1, length))
+			{
+				slot->lastSeenUs = nowUs;
+				pkt.quicConnection = slot->connection;
+				return;
+			}
+		}
+		return;
+	}
+
+	// Either ID may already be known: the client's own ID, or one the server chose
+	const Slot* match = header.dcidLength != 0 ? Find(header.dcid, header.dcidLength) : nullptr;
+	if (!match && header.scidLength != 0)
+	{
+		match = Find(header.scid, header.scidLength);
+	}
+
+	uint64_t connection = match ? match->connection : 0;
+	if (connection == 0)
+	{
+		if (header.dcidLength == 0 && header.scidLength == 0) return;
+		connection = nextConnection++;
+		connectionCount.store(nextConnection - 1, std::memory_order_relaxed);
+	}
+
+	Insert(header.dcid, header.dcidLength, connection, nowUs);
+	Insert(header.scid, header.scidLength, connection, nowUs);
+	if (header.scidLength != 0)
+	{
+		lengthMask |= 1u << header.scidLength;
+	}
+	pkt.quicConnection = connection;
+}
+
+QuicTracker::Slot* QuicTracker::Find(const uint8_t* id, uint8_t length)
+{
+	if (slots.empty()) return nullptr;
+
+	const size_t mask = slots.size() - 1;
+	for (size_t index = HashId(id, length) & mask;; index = (index + 1) & mask)
+	{
+		Slot& slot = slots[index];
+		if (slot.connection == 0) return nullptr;
+		if (slot.length == length && std::memcmp(slot.id, id, length) == 0) return &slot;
+	}
+}
+
+void QuicTracker::Insert(const uint8_t* id, uint8_t length, uint64_t connection, int64_t nowUs)
+{
+	if (length == 0) return;
+
+	// An ID keeps the connection it was first seen with
+	if (Slot* existing = Find(id, length))
+	{
+		existing->lastSeenUs = nowUs;
+		return;
+	}
+
+	if (used >= maxUsed)
+	{
+		// A flood of new IDs costs one rebuild a second, the IDs in between are not tracked
+		if (nowUs - lastFullSweepUs < fullSweepIntervalUs) return;
+		lastFullSweepUs = nowUs;
+		Sweep(nowUs, true);
+
+		// IDs all seen at the same time survive the cut, and a full table would never end the probe
+		if (used >= maxUsed) return;
+	}
+
+	const size_t mask = slots.size() - 1;
+	size_t index = HashId(id, length) & mask;
+	while (slots[index].connection != 0)
+	{
+		index = (index + 1) & mask;
+	}
+
+	Slot& slot = slots[index];
+	slot.connection = connection;
+	slot.lastSeenUs = nowUs;
+	slot.length = length;
+	std::memcpy(slot.id, id, length);
+	++used;
+	idCount.store(used, std::memory_order_relaxed);
+}
+
+void QuicTracker::Sweep(int64_t nowUs, bool makeRoom)
+{
+	if (used == 0) return;
+
+	// Making room drops the least recently seen half on top of the idle entries
+	int64_t cutoffUs = nowUs - idleTimeoutUs;
+	if (makeRoom)
+	{
+		std::vector<int64_t> seen;
+		seen.reserve(used);
+		for (const Slot& slot : slots)
+		{
+			if (slot.connection != 0) seen.push_back(slot.lastSeenUs);
+		}
+		std::nth_element(seen.begin(), seen.begin() + seen.size() / 2, seen.end());
+		cutoffUs = std::max(cutoffUs, seen[seen.size() / 2]);
+	}
+
+	// Linear probing cannot simply empty a slot, so the live entries are reinserted instead
+	std::vector<Slot> old(slots.size());
+	old.swap(slots);
+	used = 0;
+
+	const size_t mask = slots.size() - 1;
+	for (const Slot& slot : old)
+	{
+		if (slot.connection == 0 || slot.lastSeenUs < cutoffUs) continue;
+
+		size_t index = HashId(slot.id, slot.length) & mask;
+		while (slots[index].connection != 0)
+		{
+			index = (index + 1) & mask;
+		}
+		slots[index] = slot;
+		++used;
+	}
+	idCount.store(used, std::memory_order_relaxed);
+}
+
+void QuicTracker::Clear()
+{
+	slots.clear();
+	used = 0;
+	lengthMask = 0;
+	lastSweepUs = 0;
+	lastFullSweepUs = 0;
+	idCount.store(0);
+}
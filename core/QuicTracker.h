@@ -0,0 +1,44 @@
+#pragma once
+#include "PacketInfo.h"
+#include "QuicPacket.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Groups QUIC packets into connections by connection ID on the capture thread, so a
+// connection keeps one identity when its client address or port changes. Connection IDs
+// are learnt from long headers and live in an open-addressing table, so classifying a
+// short-header packet costs one probe per connection ID length in use.
+class QuicTracker
+{
+public:
+	// Capture thread only, before the packet is shared. frame is the full captured frame.
+	void Process(PacketInfo& pkt, const uint8_t* frame, size_t size);
+
+	void Clear(); // Capture thread only, or while capture is stopped
+	size_t GetConnectionIdCount() const { return idCount.load(); }
+	uint64_t GetConnectionCount() const { return connectionCount.load(); }
+
+private:
+	struct Slot
+	{
+		uint64_t connection = 0; // 0 = empty
+		int64_t lastSeenUs = 0;
+		uint8_t length = 0;
+		uint8_t id[QuicPacket::maxConnectionIdLength] = {};
+	};
+
+	std::vector<Slot> slots; // Power-of-two size, allocated on the first QUIC packet
+	size_t used = 0;
+	uint32_t lengthMask = 0; // Bit n is set once a source connection ID of n bytes was seen
+	uint64_t nextConnection = 1;
+	int64_t lastSweepUs = 0;
+	int64_t lastFullSweepUs = 0;
+	std::atomic<size_t> idCount{ 0 };
+	std::atomic<uint64_t> connectionCount{ 0 };
+
+	Slot* Find(const uint8_t* id, uint8_t length);
+	void Insert(const uint8_t* id, uint8_t length, uint64_t connection, int64_t nowUs);
+	void Sweep(int64_t nowUs, bool makeRoom = false); // Rebuilds the table without idle entries
+};
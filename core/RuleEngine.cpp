@@ -0,0 +1,273 @@
+#include "RuleEngine.h"
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+
+namespace
+{
+	constexpr RuleCondition::Protocol protocols[] = {
+		RuleCondition::Protocol::Tcp, RuleCondition::Protocol::Udp, RuleCondition::Protocol::Icmp,
+		RuleCondition::Protocol::Arp, RuleCondition::Protocol::Ip, RuleCondition::Protocol::Ip6
+	};
+	constexpr size_t protocolCount = std::size(protocols);
+}
+
+bool RuleEngine::SetRules(const std::string& text, std::string& error)
+{
+	std::vector<std::unique_ptr<CompiledRule>> compiled;
+	std::istringstream lines(text);
+	std::string line;
+	size_t lineNumber = 0;
+	while (std::getline(lines, line))
+	{
+		++lineNumber;
+		const size_t first = line.find_first_not_of(" \t\r");
+		if (first == std::string::npos || line[first] == '#') continue;
+
+		auto entry = std::make_unique<CompiledRule>();
+		std::string lineError;
+		if (!PacketRule::Parse(line, entry->rule, lineError))
+		{
+			error = "Line " + std::to_string(lineNumber) + ": " + lineError;
+			return false;
+		}
+		for (const auto& other : compiled)
+		{
+			if (other->rule.name == entry->rule.name)
+			{
+				error = "Line " + std::to_string(lineNumber) + ": a rule named '" + entry->rule.name + "' already exists";
+				return false;
+			}
+		}
+		entry->contentCount = static_cast<uint32_t>(entry->rule.contents.size());
+		compiled.push_back(std::move(entry));
+	}
+
+	std::scoped_lock lock(mutex);
+
+	// Unchanged rules carry their ID and counts over. Matches the capture thread still counts
+	// on the old set until it picks up the new one are lost, which is at most a packet or two.
+	for (auto& entry : compiled)
+	{
+		const CompiledRule* previous = nullptr;
+		if (rules)
+		{
+			for (const auto& old : rules->rules)
+			{
+				if (old->rule.name == entry->rule.name && old->rule.expression == entry->rule.expression) previous = old.get();
+			}
+		}
+		if (previous)
+		{
+			entry->id = previous->id;
+			entry->matches = previous->matches.load();
+			entry->lastMatchUs = previous->lastMatchUs.load();
+		}
+		else
+		{
+			entry->id = nextRuleId++;
+		}
+	}
+
+	rules = Compile(std::move(compiled));
+	rulesText = text;
+	rulesVersion.fetch_add(1, std::memory_order_release);
+	return true;
+}
+
+std::shared_ptr<const RuleEngine::RuleSet> RuleEngine::Compile(std::vector<std::unique_ptr<CompiledRule>> compiled)
+{
+	auto set = std::make_shared<RuleSet>();
+	set->rules = std::move(compiled);
+	set->byProtocol.resize(protocolCount);
+
+	for (uint32_t index = 0; index < set->rules.size(); ++index)
+	{
+		const CompiledRule& entry = *set->rules[index];
+		set->byId[entry.id] = index;
+
+		// Rules with contents are reached through the automaton only
+		if (entry.contentCount != 0)
+		{
+			for (const RuleContent& content : entry.rule.contents)
+			{
+				set->matcher.Add(content.bytes, content.ignoreCase);
+				set->contentRule.push_back(index);
+			}
+			continue;
+		}
+
+		// Header-only rules are filed under the most selective condition they cannot do without
+		const RuleCondition* port = nullptr;
+		const RuleCondition* host = nullptr;
+		const RuleCondition* protocol = nullptr;
+		for (const RuleCondition& condition : entry.rule.conditions)
+		{
+			if (condition.negate) continue;
+			if (condition.kind == RuleCondition::Kind::Port && condition.low == condition.high) port = &condition;
+			if (condition.kind == RuleCondition::Kind::Address && condition.prefixLength == (condition.network.IsIPv4() ? 32 : 128)) host = &condition;
+			if (condition.kind == RuleCondition::Kind::Protocol) protocol = &condition;
+		}
+		if (port)
+		{
+			set->byPort[port->low].push_back(index);
+		}
+		else if (host)
+		{
+			set->byHost[host->network.Hash()].push_back(index);
+		}
+		else if (protocol)
+		{
+			set->byProtocol[static_cast<size_t>(protocol->protocol)].push_back(index);
+		}
+		else
+		{
+			set->unindexed.push_back(index);
+		}
+	}
+
+	set->matcher.Compile();
+	return set;
+}
+
+std::string RuleEngine::GetRulesText() const
+{
+	std::scoped_lock lock(mutex);
+	return rulesText;
+}
+
+void RuleEngine::Evaluate(const PacketInfo& pkt, const uint8_t* frame, size_t size, std::vector<uint32_t>& matches)
+{
+	// Pick up a new rule set, a single atomic load in the common case
+	const uint64_t version = rulesVersion.load(std::memory_order_acquire);
+	if (version != captureRulesVersion)
+	{
+		std::scoped_lock lock(mutex);
+		captureRules = rules;
+		captureRulesVersion = version;
+		const size_t ruleCount = captureRules ? captureRules->rules.size() : 0;
+		stamp.assign(ruleCount, 0);
+		contentsSeen.assign(ruleCount, 0);
+		patternStamp.assign(captureRules ? captureRules->matcher.GetPatternCount() : 0, 0);
+		packetStamp = 0;
+	}
+	if (!captureRules || captureRules->rules.empty()) return;
+	const RuleSet& set = *captureRules;
+
+	evaluatedPackets.store(evaluatedPackets.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	if (++packetStamp == 0)
+	{
+		std::fill(stamp.begin(), stamp.end(), 0);
+		std::fill(patternStamp.begin(), patternStamp.end(), 0);
+		packetStamp = 1;
+	}
+
+	const PacketLayers& layers = pkt.layers;
+	const int64_t nowUs = std::chrono::duration_cast<std::chrono::microseconds>(pkt.timestamp.time_since_epoch()).count();
+
+	// Header-only rules: only the lists this packet's ports, hosts and protocols select
+	auto visit = [&](const std::vector<uint32_t>& list)
+	{
+		for (uint32_t index : list)
+		{
+			if (stamp[index] == packetStamp) continue;
+			stamp[index] = packetStamp;
+			Check(set, index, pkt, nowUs, matches);
+		}
+	};
+	auto visitKey = [&](const auto& map, auto key)
+	{
+		const auto it = map.find(key);
+		if (it != map.end()) visit(it->second);
+	};
+
+	if (!set.byPort.empty() && layers.HasTransport() && (layers.ipProtocol == 6 || layers.ipProtocol == 17))
+	{
+		visitKey(set.byPort, layers.srcPort);
+		visitKey(set.byPort, layers.dstPort);
+	}
+	if (!set.byHost.empty() && layers.srcAddr.IsSet())
+	{
+		visitKey(set.byHost, layers.srcAddr.Hash());
+		visitKey(set.byHost, layers.dstAddr.Hash());
+	}
+	for (size_t p = 0; p < protocolCount; ++p)
+	{
+		if (set.byProtocol[p].empty()) continue;
+		RuleCondition condition;
+		condition.protocol = protocols[p];
+		if (condition.Matches(layers)) visit(set.byProtocol[p]);
+	}
+	visit(set.unindexed);
+
+	// Rules with contents: one pass of the automaton over the payload, a rule is checked once
+	// all of its contents were found
+	if (set.matcher.Empty() || layers.payloadOffset == 0 || layers.payloadOffset >= size) return;
+	set.matcher.ForEachMatch(frame + layers.payloadOffset, size - layers.payloadOffset, [&](const PatternMatcher::Match& match)
+	{
+		if (patternStamp[match.pattern] == packetStamp) return true;
+		patternStamp[match.pattern] = packetStamp;
+
+		const uint32_t index = set.contentRule[match.pattern];
+		if (stamp[index] != packetStamp)
+		{
+			stamp[index] = packetStamp;
+			contentsSeen[index] = 0;
+		}
+		if (++contentsSeen[index] == set.rules[index]->contentCount)
+		{
+			Check(set, index, pkt, nowUs, matches);
+		}
+		return true;
+	});
+}
+
+void RuleEngine::Check(const RuleSet& set, uint32_t index, const PacketInfo& pkt, int64_t nowUs, std::vector<uint32_t>& matches)
+{
+	const CompiledRule& entry = *set.rules[index];
+	if (!entry.rule.MatchesHeaders(pkt.layers)) return;
+
+	entry.matches.store(entry.matches.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	entry.lastMatchUs.store(nowUs, std::memory_order_relaxed);
+	matches.push_back(entry.id);
+}
+
+std::vector<RuleStats> RuleEngine::GetStats() const
+{
+	std::scoped_lock lock(mutex);
+	std::vector<RuleStats> stats;
+	if (!rules) return stats;
+
+	stats.reserve(rules->rules.size());
+	for (const auto& entry : rules->rules)
+	{
+		stats.push_back({ entry->id, entry->rule.name, entry->rule.expression, entry->matches.load(), entry->lastMatchUs.load() });
+	}
+	return stats;
+}
+
+std::string RuleEngine::FormatRuleNames(const std::vector<uint32_t>& ids) const
+{
+	std::scoped_lock lock(mutex);
+	std::string names;
+	if (!rules) return names;
+	for (uint32_t id : ids)
+	{
+		const auto it = rules->byId.find(id);
+		if (it == rules->byId.end()) continue; // Removed since the packet was captured
+		if (!names.empty()) names += ", ";
+		names += rules->rules[it->second]->rule.name;
+	}
+	return names;
+}
+
+void RuleEngine::ResetCounts()
+{
+	std::scoped_lock lock(mutex);
+	if (!rules) return;
+	for (const auto& entry : rules->rules)
+	{
+		entry->matches = 0;
+		entry->lastMatchUs = 0;
+	}
+}
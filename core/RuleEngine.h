@@ -0,0 +1,85 @@
+#pragma once
+#include "PacketInfo.h"
+#include "PacketRule.h"
+#include "PatternMatcher.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct RuleStats
+{
+	uint32_t id = 0;
+	std::string name;
+	std::string expression;
+	uint64_t matches = 0;
+	int64_t lastMatchUs = 0; // 0 = never
+};
+
+// Packet rules evaluated on every captured packet, kept across captures. A rule set is compiled once
+// into indexes and a single pattern automaton: header-only rules are filed under a port,
+// host or protocol they require, rules with contents are only looked at when the automaton
+// finds one of their contents. A packet therefore only checks the rules that can match it,
+// and the payload is scanned once however many rules there are.
+class RuleEngine
+{
+public:
+	// One rule per line, blank lines and lines starting with # are skipped. Nothing changes
+	// when a line fails to parse. Rules kept with the same name and expression keep their ID
+	// and counts.
+	bool SetRules(const std::string& text, std::string& error);
+	std::string GetRulesText() const;
+
+	// Capture thread only. Appends the IDs of the rules the packet matches.
+	void Evaluate(const PacketInfo& pkt, const uint8_t* frame, size_t size, std::vector<uint32_t>& matches);
+
+	std::vector<RuleStats> GetStats() const; // In rule order
+	std::string FormatRuleNames(const std::vector<uint32_t>& ids) const; // e.g. "ssh-scan, admin-login"
+	uint64_t GetEvaluatedPackets() const { return evaluatedPackets.load(); }
+	void ResetCounts();
+
+private:
+	struct CompiledRule
+	{
+		uint32_t id = 0;
+		PacketRule rule;
+		uint32_t contentCount = 0;
+		mutable std::atomic<uint64_t> matches{ 0 };
+		mutable std::atomic<int64_t> lastMatchUs{ 0 };
+	};
+
+	// Immutable once built, the capture thread keeps its own reference while a new one is swapped in
+	struct RuleSet
+	{
+		std::vector<std::unique_ptr<CompiledRule>> rules;
+		PatternMatcher matcher; // Every content of every rule
+		std::vector<uint32_t> contentRule; // Pattern index -> rule index
+		std::unordered_map<uint16_t, std::vector<uint32_t>> byPort; // Header-only rules by a port they need
+		std::unordered_map<uint64_t, std::vector<uint32_t>> byHost; // By the hash of a host they need
+		std::vector<std::vector<uint32_t>> byProtocol; // By RuleCondition::Protocol
+		std::vector<uint32_t> unindexed; // Header-only rules with nothing to file them under
+		std::unordered_map<uint32_t, uint32_t> byId; // Rule ID -> rule index
+	};
+
+	mutable std::mutex mutex; // Guards rules, their source text and the ID counter
+	std::shared_ptr<const RuleSet> rules;
+	std::string rulesText; // As given, comments included
+	uint32_t nextRuleId = 1;
+	std::atomic<uint64_t> rulesVersion{ 1 };
+	std::atomic<uint64_t> evaluatedPackets{ 0 };
+
+	// Capture thread state
+	std::shared_ptr<const RuleSet> captureRules;
+	uint64_t captureRulesVersion = 0;
+	std::vector<uint32_t> stamp; // Per rule, the last packet that looked at it
+	std::vector<uint32_t> contentsSeen; // Per rule, contents found in the current packet
+	std::vector<uint32_t> patternStamp; // Per pattern, so each content counts once per packet
+	uint32_t packetStamp = 0;
+
+	static std::shared_ptr<const RuleSet> Compile(std::vector<std::unique_ptr<CompiledRule>> compiled);
+	void Check(const RuleSet& set, uint32_t index, const PacketInfo& pkt, int64_t nowUs, std::vector<uint32_t>& matches);
+};
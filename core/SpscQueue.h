@@ -0,0 +1,61 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+// Bounded lock-free queue for exactly one producer thread and one consumer thread.
+// Capacity is rounded up to a power of two so positions wrap with a mask.
+template <typename T>
+class SpscQueue
+{
+public:
+	explicit SpscQueue(size_t capacity)
+	{
+		size_t rounded = 1;
+		while (rounded < capacity) rounded <<= 1;
+		slots = std::make_unique<T[]>(rounded);
+		mask = rounded - 1;
+	}
+
+	// Producer only, returns false when the queue is full
+	bool TryPush(T&& item)
+	{
+		const size_t position = tail.load(std::memory_order_relaxed);
+		if (position - head.load(std::memory_order_acquire) > mask)
+		{
+			return false;
+		}
+
+		slots[position & mask] = std::move(item);
+		tail.store(position + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Consumer only, returns false when the queue is empty
+	bool TryPop(T& item)
+	{
+		const size_t position = head.load(std::memory_order_relaxed);
+		if (position == tail.load(std::memory_order_acquire))
+		{
+			return false;
+		}
+
+		item = std::move(slots[position & mask]);
+		slots[position & mask] = T{};
+		head.store(position + 1, std::memory_order_release);
+		return true;
+	}
+
+	size_t SizeApprox() const
+	{
+		return tail.load(std::memory_order_relaxed) - head.load(std::memory_order_relaxed);
+	}
+
+private:
+	std::unique_ptr<T[]> slots;
+	size_t mask = 0;
+
+	// Kept on separate cache lines so producer and consumer do not share one
+	alignas(64) std::atomic<size_t> head{ 0 }; // Next slot to pop, written by the consumer
+	alignas(64) std::atomic<size_t> tail{ 0 }; // Next slot to push, written by the producer
+};
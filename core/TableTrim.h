@@ -0,0 +1,39 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Drops the lowest-counted eighth of a full table in one pass, so inserting into a full
+// table costs a scan only once every maxSize / 8 insertions. count maps an entry's value
+// to the number it is ranked by, e.g. its queries or requests.
+template <typename Map, typename Count>
+void TrimLeastCounted(Map& map, size_t maxSize, Count&& count)
+{
+	if (map.size() < maxSize) return;
+
+	std::vector<uint64_t> counts;
+	counts.reserve(map.size());
+	for (const auto& [key, value] : map)
+	{
+		counts.push_back(count(value));
+	}
+
+	const size_t toRemove = std::max<size_t>(maxSize / 8, 1);
+	std::nth_element(counts.begin(), counts.begin() + (toRemove - 1), counts.end());
+	const uint64_t threshold = counts[toRemove - 1];
+
+	size_t removed = 0;
+	for (auto it = map.begin(); it != map.end() && removed < toRemove;)
+	{
+		if (count(it->second) <= threshold)
+		{
+			it = map.erase(it);
+			++removed;
+		}
+		else
+		{
+			++it;
+		}
+	}
+}
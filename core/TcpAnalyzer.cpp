@@ -0,0 +1,254 @@
+#include "TcpAnalyzer.h"
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+namespace
+{
+	constexpr size_t maxConnections = 65536;
+	constexpr int64_t idleTimeoutUs = 120ll * 1000 * 1000;
+	constexpr int64_t closedTimeoutUs = 10ll * 1000 * 1000; // Both FINs seen, kept briefly for the last ACKs
+	constexpr int64_t expiryIntervalUs = 1000ll * 1000;
+	constexpr int64_t defaultReorderWindowUs = 3000; // Used until the connection has an RTT sample
+
+	int64_t ToMicroseconds(std::chrono::system_clock::time_point timestamp)
+	{
+		return std::chrono::duration_cast<std::chrono::microseconds>(timestamp.time_since_epoch()).count();
+	}
+
+	// Sequence number comparison modulo 2^32
+	bool SeqBefore(uint32_t a, uint32_t b)
+	{
+		return static_cast<int32_t>(a - b) < 0;
+	}
+
+	uint32_t ClampDuration(int64_t us)
+	{
+		return static_cast<uint32_t>(std::clamp<int64_t>(us, 0, std::numeric_limits<uint32_t>::max()));
+	}
+}
+
+void TcpFlowStats::Add(const TcpAnalysis& analysis)
+{
+	retransmissions += analysis.Has(TcpAnalysis::Retransmission);
+	duplicateAcks += analysis.Has(TcpAnalysis::DuplicateAck);
+	outOfOrder += analysis.Has(TcpAnalysis::OutOfOrder);
+	zeroWindows += analysis.Has(TcpAnalysis::ZeroWindow);
+	rttSamples += analysis.rttUs != 0;
+	rttTotalUs += analysis.rttUs;
+	handshakes += analysis.handshakeRttUs != 0;
+	handshakeTotalUs += analysis.handshakeRttUs;
+}
+
+void TcpFlowStats::Add(const TcpFlowStats& other)
+{
+	retransmissions += other.retransmissions;
+	duplicateAcks += other.duplicateAcks;
+	outOfOrder += other.outOfOrder;
+	zeroWindows += other.zeroWindows;
+	rttSamples += other.rttSamples;
+	rttTotalUs += other.rttTotalUs;
+	handshakes += other.handshakes;
+	handshakeTotalUs += other.handshakeTotalUs;
+}
+
+const TcpFlowStats* TcpAnalyzer::Analyze(PacketInfo& pkt)
+{
+	const PacketLayers& layers = pkt.layers;
+	if (!layers.IsTcp() || layers.moreFragments) return nullptr;
+
+	const int64_t nowUs = ToMicroseconds(pkt.timestamp);
+	if (nowUs - lastExpiryUs >= expiryIntervalUs)
+	{
+		Expire(nowUs);
+		lastExpiryUs = nowUs;
+	}
+
+	// A reset ends the connection, a later SYN on the same ports starts over
+	if (layers.HasTcpFlag(PacketLayers::TcpRst))
+	{
+		auto it = connections.find(TcpConnectionKey::FromPacket(layers));
+		if (it != connections.end())
+		{
+			Erase(it);
+			connectionCount.store(connections.size(), std::memory_order_relaxed);
+		}
+		return nullptr;
+	}
+
+	Connection& conn = FindOrCreate(layers)->second;
+	conn.lastSeenUs = nowUs;
+
+	const uint8_t side = TcpConnectionKey::SourceIsA(layers) ? 0 : 1;
+	Direction& sender = conn.directions[side];
+	Direction& receiver = conn.directions[side ^ 1];
+	TcpAnalysis& analysis = pkt.tcpAnalysis;
+
+	const bool syn = layers.HasTcpFlag(PacketLayers::TcpSyn);
+	const bool ack = layers.HasTcpFlag(PacketLayers::TcpAck);
+	if (syn && !ack && conn.synUs == 0)
+	{
+		conn.synUs = nowUs;
+		conn.synDirection = side;
+	}
+	else if (syn && ack)
+	{
+		conn.synAckSeen = true;
+	}
+
+	TrackSegment(conn, sender, layers, nowUs, analysis);
+
+	// Move to the back of its list, the closed one once both sides sent a FIN
+	std::list<TcpConnectionKey>& from = conn.closed ? closedLru : lru;
+	conn.closed = conn.directions[0].finSent && conn.directions[1].finSent;
+	std::list<TcpConnectionKey>& to = conn.closed ? closedLru : lru;
+	to.splice(to.end(), from, conn.lruPosition);
+
+	if (ack)
+	{
+		TrackAck(conn, sender, receiver, layers, nowUs, analysis);
+	}
+
+	// The client's ACK of the SYN-ACK completes the handshake
+	if (!conn.handshakeDone && conn.synAckSeen && conn.synUs != 0 && ack && !syn &&
+		side == conn.synDirection && receiver.seen && layers.tcpAck == receiver.nextSeq)
+	{
+		analysis.handshakeRttUs = ClampDuration(nowUs - conn.synUs);
+		conn.handshakeDone = true;
+	}
+
+	if (layers.tcpWindow == 0 && !syn && !layers.HasTcpFlag(PacketLayers::TcpFin))
+	{
+		analysis.flags |= TcpAnalysis::ZeroWindow;
+	}
+
+	conn.totals.Add(analysis);
+	return &conn.totals;
+}
+
+void TcpAnalyzer::TrackSegment(Connection& conn, Direction& sender, const PacketLayers& layers, int64_t nowUs, TcpAnalysis& analysis)
+{
+	const bool syn = layers.HasTcpFlag(PacketLayers::TcpSyn);
+	const bool fin = layers.HasTcpFlag(PacketLayers::TcpFin);
+	if (fin) sender.finSent = true;
+
+	// SYN and FIN each take one sequence number
+	const uint32_t seqLength = layers.payloadLength + (syn ? 1 : 0) + (fin ? 1 : 0);
+	if (seqLength == 0) return;
+
+	const uint32_t seq = layers.tcpSeq;
+	const uint32_t end = seq + seqLength;
+
+	if (sender.seen && SeqBefore(seq, sender.nextSeq))
+	{
+		// Keep-alives resend the last byte to provoke an ACK, they are not loss
+		if (layers.payloadLength <= 1 && seq + 1 == sender.nextSeq && !syn && !fin) return;
+
+		// Shortly after the sequence moved on this is reordering in the network, later a resend
+		const int64_t reorderWindowUs = conn.rttUs != 0 ? conn.rttUs : defaultReorderWindowUs;
+		analysis.flags |= nowUs - sender.lastAdvanceUs < reorderWindowUs ? TcpAnalysis::OutOfOrder : TcpAnalysis::Retransmission;
+
+		// Karn's algorithm: an ACK of resent data cannot tell which copy it acknowledges
+		const auto keepEnd = std::remove_if(sender.pending.begin(), sender.pending.begin() + sender.pendingCount,
+			[seq](const auto& sample) { return SeqBefore(seq, sample.first); });
+		sender.pendingCount = static_cast<uint8_t>(keepEnd - sender.pending.begin());
+
+		if (SeqBefore(sender.nextSeq, end))
+		{
+			sender.nextSeq = end;
+			sender.lastAdvanceUs = nowUs;
+		}
+		return;
+	}
+
+	sender.seen = true;
+	sender.nextSeq = end;
+	sender.lastAdvanceUs = nowUs;
+	if (sender.pendingCount < maxRttSamples)
+	{
+		sender.pending[sender.pendingCount++] = { end, nowUs };
+	}
+}
+
+void TcpAnalyzer::TrackAck(Connection& conn, Direction& sender, Direction& receiver, const PacketLayers& layers, int64_t nowUs, TcpAnalysis& analysis)
+{
+	const uint32_t ack = layers.tcpAck;
+
+	// The newest segment this ACK fully covers gives the sample, older ones were waiting on it
+	uint8_t covered = 0;
+	while (covered < receiver.pendingCount && !SeqBefore(ack, receiver.pending[covered].first))
+	{
+		++covered;
+	}
+	if (covered != 0)
+	{
+		analysis.rttUs = ClampDuration(nowUs - receiver.pending[covered - 1].second);
+		conn.rttUs = analysis.rttUs;
+		std::copy(receiver.pending.begin() + covered, receiver.pending.begin() + receiver.pendingCount, receiver.pending.begin());
+		receiver.pendingCount = static_cast<uint8_t>(receiver.pendingCount - covered);
+	}
+
+	// Same ACK and window again, without data, while the peer still has data in flight
+	const bool bareAck = layers.payloadLength == 0 && !layers.HasTcpFlag(PacketLayers::TcpSyn) && !layers.HasTcpFlag(PacketLayers::TcpFin);
+	if (bareAck && sender.ackSeen && ack == sender.lastAck && layers.tcpWindow == sender.lastWindow &&
+		receiver.seen && SeqBefore(ack, receiver.nextSeq))
+	{
+		analysis.flags |= TcpAnalysis::DuplicateAck;
+	}
+
+	sender.ackSeen = true;
+	sender.lastAck = ack;
+	sender.lastWindow = layers.tcpWindow;
+}
+
+TcpAnalyzer::ConnectionMap::iterator TcpAnalyzer::FindOrCreate(const PacketLayers& layers)
+{
+	const TcpConnectionKey key = TcpConnectionKey::FromPacket(layers);
+	auto it = connections.find(key);
+	if (it != connections.end()) return it;
+
+	// A full table drops its least recently seen connection, closed ones go first
+	if (connections.size() >= maxConnections)
+	{
+		Erase(connections.find(closedLru.empty() ? lru.front() : closedLru.front()));
+	}
+
+	it = connections.emplace(key, Connection{}).first;
+	it->second.lruPosition = lru.insert(lru.end(), key);
+	connectionCount.store(connections.size(), std::memory_order_relaxed);
+	return it;
+}
+
+void TcpAnalyzer::Erase(ConnectionMap::iterator it)
+{
+	(it->second.closed ? closedLru : lru).erase(it->second.lruPosition);
+	connections.erase(it);
+}
+
+void TcpAnalyzer::Expire(int64_t nowUs)
+{
+	ExpireList(lru, nowUs, idleTimeoutUs);
+	ExpireList(closedLru, nowUs, closedTimeoutUs);
+	connectionCount.store(connections.size(), std::memory_order_relaxed);
+}
+
+// The list is ordered by last activity, so the walk stops at the first connection still in use
+void TcpAnalyzer::ExpireList(std::list<TcpConnectionKey>& list, int64_t nowUs, int64_t timeoutUs)
+{
+	while (!list.empty())
+	{
+		auto it = connections.find(list.front());
+		if (nowUs - it->second.lastSeenUs < timeoutUs) break;
+		list.pop_front();
+		connections.erase(it);
+	}
+}
+
+void TcpAnalyzer::Clear()
+{
+	connections.clear();
+	lru.clear();
+	closedLru.clear();
+	lastExpiryUs = 0;
+	connectionCount.store(0, std::memory_order_relaxed);
+}
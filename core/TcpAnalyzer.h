@@ -0,0 +1,92 @@
+#pragma once
+#include "PacketInfo.h"
+#include "TcpConnectionKey.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+// TCP analysis totals, summed over the packets of a connection
+struct TcpFlowStats
+{
+	uint32_t retransmissions = 0;
+	uint32_t duplicateAcks = 0;
+	uint32_t outOfOrder = 0;
+	uint32_t zeroWindows = 0;
+	uint32_t rttSamples = 0;
+	uint64_t rttTotalUs = 0;
+	uint32_t handshakes = 0;
+	uint64_t handshakeTotalUs = 0;
+
+	void Add(const TcpAnalysis& analysis);
+	void Add(const TcpFlowStats& other);
+	double AverageRttMs() const { return rttSamples != 0 ? rttTotalUs / 1000.0 / rttSamples : 0.0; }
+	double AverageHandshakeMs() const { return handshakes != 0 ? handshakeTotalUs / 1000.0 / handshakes : 0.0; }
+};
+
+// Incremental per-connection TCP analysis on the capture thread. Each packet gets its
+// TcpAnalysis filled from the connection state before it is stored: retransmissions,
+// out-of-order segments, duplicate ACKs, zero windows and RTT samples. The connection
+// keeps running totals of those for as long as it is tracked.
+class TcpAnalyzer
+{
+public:
+	// Capture thread only, before the packet is shared. Returns the totals of the packet's
+	// connection including this packet, or nullptr when it is not tracked.
+	const TcpFlowStats* Analyze(PacketInfo& pkt);
+
+	void Clear(); // Capture thread only, or while capture is stopped
+	size_t GetConnectionCount() const { return connectionCount.load(); }
+
+private:
+	static constexpr size_t maxRttSamples = 8;
+
+	// One side of a connection, as the sender of its segments and ACKs
+	struct Direction
+	{
+		bool seen = false;
+		uint32_t nextSeq = 0; // One past the highest sequence number sent
+		int64_t lastAdvanceUs = 0; // When nextSeq last moved forward
+		bool ackSeen = false;
+		uint32_t lastAck = 0;
+		uint16_t lastWindow = 0;
+		bool finSent = false;
+
+		// Segments waiting for an ACK to give an RTT sample: (sequence end, time sent), oldest first
+		std::array<std::pair<uint32_t, int64_t>, maxRttSamples> pending{};
+		uint8_t pendingCount = 0;
+	};
+
+	struct Connection
+	{
+		Direction directions[2]; // Indexed by whether the sender is the key's B endpoint
+		int64_t synUs = 0;
+		uint8_t synDirection = 0;
+		bool synAckSeen = false;
+		bool handshakeDone = false;
+		uint32_t rttUs = 0; // Latest data RTT, decides between out-of-order and retransmission
+		int64_t lastSeenUs = 0;
+		TcpFlowStats totals;
+		bool closed = false; // Both FINs seen, the connection sits on the closed list
+		std::list<TcpConnectionKey>::iterator lruPosition;
+	};
+
+	using ConnectionMap = std::unordered_map<TcpConnectionKey, Connection, TcpConnectionKeyHash>;
+
+	ConnectionMap connections;
+	// Least recently seen connection first, so expiry and eviction only look at the front
+	std::list<TcpConnectionKey> lru;
+	std::list<TcpConnectionKey> closedLru; // Same for closed connections, which time out sooner
+	int64_t lastExpiryUs = 0;
+	std::atomic<size_t> connectionCount{ 0 };
+
+	ConnectionMap::iterator FindOrCreate(const PacketLayers& layers);
+	void Erase(ConnectionMap::iterator it);
+	void Expire(int64_t nowUs);
+	void ExpireList(std::list<TcpConnectionKey>& list, int64_t nowUs, int64_t timeoutUs);
+	static void TrackSegment(Connection& conn, Direction& sender, const PacketLayers& layers, int64_t nowUs, TcpAnalysis& analysis);
+	static void TrackAck(Connection& conn, Direction& sender, Direction& receiver, const PacketLayers& layers, int64_t nowUs, TcpAnalysis& analysis);
+};
@@ -0,0 +1,47 @@
+#pragma once
+#include "PacketLayers.h"
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+
+// Identifies a TCP connection independent of direction: both directions map to the same
+// key, with the lower endpoint stored first
+struct TcpConnectionKey
+{
+	IpAddress addrA;
+	IpAddress addrB;
+	uint16_t portA = 0;
+	uint16_t portB = 0;
+	uint16_t vlan = 0;
+
+	// True when the packet was sent from the A endpoint
+	static bool SourceIsA(const PacketLayers& layers)
+	{
+		return std::tie(layers.srcAddr, layers.srcPort) < std::tie(layers.dstAddr, layers.dstPort);
+	}
+
+	static TcpConnectionKey FromPacket(const PacketLayers& layers)
+	{
+		TcpConnectionKey key;
+		const bool srcFirst = SourceIsA(layers);
+		key.addrA = srcFirst ? layers.srcAddr : layers.dstAddr;
+		key.addrB = srcFirst ? layers.dstAddr : layers.srcAddr;
+		key.portA = srcFirst ? layers.srcPort : layers.dstPort;
+		key.portB = srcFirst ? layers.dstPort : layers.srcPort;
+		key.vlan = layers.OuterVlan();
+		return key;
+	}
+
+	uint64_t Hash() const
+	{
+		const uint64_t ports = (static_cast<uint64_t>(portA) << 32) | (static_cast<uint64_t>(portB) << 16) | vlan;
+		return addrA.Hash() ^ (addrB.Hash() * 31) ^ (ports * 0x9E3779B97F4A7C15ull);
+	}
+
+	bool operator==(const TcpConnectionKey&) const = default;
+};
+
+struct TcpConnectionKeyHash
+{
+	size_t operator()(const TcpConnectionKey& key) const { return static_cast<size_t>(key.Hash()); }
+};
@@ -0,0 +1,578 @@
+#include "TcpReassembler.h"
+#include "SpscQueue.h"
+#include "TcpConnectionKey.h"
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <list>
+#include <map>
+#include <thread>
+#include <unordered_map>
+
+namespace
+{
+	constexpr size_t queueCapacity = 16384;
+	constexpr size_t maxConnectionsPerShard = 16384;
+	constexpr size_t maxPendingPerDirection = 1u << 20; // Out-of-order bytes held before the hole is given up on
+	constexpr int64_t idleTimeoutUs = 120ll * 1000 * 1000;
+	constexpr int64_t expiryIntervalUs = 1000ll * 1000;
+
+	int64_t ToMicroseconds(std::chrono::system_clock::time_point timestamp)
+	{
+		return std::chrono::duration_cast<std::chrono::microseconds>(timestamp.time_since_epoch()).count();
+	}
+
+	// Fixed-size block for out-of-order data, chained for segments larger than one block
+	struct Block
+	{
+		static constexpr size_t capacity = 2048 - sizeof(void*);
+		Block* next = nullptr;
+		uint8_t data[capacity];
+	};
+
+	// Per-shard cache of free blocks. In-use blocks are counted against a limit shared with
+	// the other shards, and at most maxCachedBlocks free ones are kept for reuse, the rest go
+	// back to the heap. Resident memory is therefore bounded by the limit plus the caches.
+	class BlockPool
+	{
+	public:
+		static constexpr size_t maxCachedBlocks = 512; // 1 MB per shard
+
+		BlockPool(std::atomic<size_t>& inUse, const std::atomic<size_t>& limit)
+			: inUseBytes(inUse), limitBytes(limit)
+		{
+		}
+
+		Block* Acquire()
+		{
+			if (inUseBytes.load(std::memory_order_relaxed) + sizeof(Block) > limitBytes.load(std::memory_order_relaxed))
+			{
+				return nullptr;
+			}
+
+			std::unique_ptr<Block> block;
+			if (freeBlocks.empty())
+			{
+				block.reset(new Block); // Default-initialised, the data is overwritten anyway
+			}
+			else
+			{
+				block = std::move(freeBlocks.back());
+				freeBlocks.pop_back();
+			}
+
+			block->next = nullptr;
+			inUseBytes.fetch_add(sizeof(Block), std::memory_order_relaxed);
+			return block.release();
+		}
+
+		void ReleaseChain(Block* block)
+		{
+			while (block)
+			{
+				std::unique_ptr<Block> owned(block);
+				block = block->next;
+				inUseBytes.fetch_sub(sizeof(Block), std::memory_order_relaxed);
+				if (freeBlocks.size() < maxCachedBlocks)
+				{
+					freeBlocks.push_back(std::move(owned));
+				}
+			}
+		}
+
+	private:
+		std::atomic<size_t>& inUseBytes;
+		const std::atomic<size_t>& limitBytes;
+		std::vector<std::unique_ptr<Block>> freeBlocks;
+	};
+
+	struct Segment
+	{
+		Block* head = nullptr;
+		uint32_t size = 0;
+	};
+
+	struct Direction
+	{
+		bool initialized = false;
+		bool finished = false; // Everything up to the FIN was delivered
+		uint32_t baseSeq = 0; // Sequence number of stream offset 0
+		uint64_t nextOffset = 0; // Next stream offset to deliver
+		uint64_t finOffset = std::numeric_limits<uint64_t>::max();
+		std::map<uint64_t, Segment> pending; // Out-of-order data by stream offset
+		size_t pendingBytes = 0;
+
+		// Stream offset of a sequence number, unwrapped around the delivery point
+		int64_t OffsetOf(uint32_t seq) const
+		{
+			const uint32_t nextSeq = baseSeq + static_cast<uint32_t>(nextOffset);
+			return static_cast<int64_t>(nextOffset) + static_cast<int32_t>(seq - nextSeq);
+		}
+	};
+
+	struct Connection
+	{
+		uint64_t id = 0;
+		uint64_t flowId = 0;
+		int64_t lastSeenUs = 0;
+		IpAddress clientAddr;
+		IpAddress serverAddr;
+		uint16_t clientPort = 0;
+		uint16_t serverPort = 0;
+		Direction directions[2]; // 0 = client to server
+		std::list<TcpConnectionKey>::iterator lruPosition;
+	};
+}
+
+class TcpReassembler::Shard
+{
+public:
+	Shard(TcpReassembler& reassembler, size_t index, size_t shardCount)
+		: queue(queueCapacity), owner(reassembler), pool(reassembler.bufferedBytes, reassembler.memoryLimit),
+		  nextConnectionId(index + 1), connectionIdStride(shardCount)
+	{
+	}
+
+	SpscQueue<PacketRef> queue;
+	std::thread worker;
+
+	std::atomic<size_t> connectionCount{ 0 };
+	std::atomic<uint64_t> deliveredBytes{ 0 };
+	std::atomic<uint64_t> gaps{ 0 };
+	std::atomic<uint64_t> evictedConnections{ 0 };
+
+	void Run()
+	{
+		int idleRounds = 0;
+		PacketRef pkt;
+		for (;;)
+		{
+			if (queue.TryPop(pkt))
+			{
+				Process(*pkt);
+				pkt.reset();
+				idleRounds = 0;
+				continue;
+			}
+
+			// The queue is drained before exiting so no submitted segment is lost
+			if (!owner.running.load(std::memory_order_acquire) && queue.SizeApprox() == 0)
+			{
+				break;
+			}
+
+			if (++idleRounds < 64)
+			{
+				std::this_thread::yield();
+			}
+			else
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+		}
+
+		while (!connections.empty())
+		{
+			Close(connections.begin());
+		}
+	}
+
+private:
+	using ConnectionMap = std::unordered_map<TcpConnectionKey, Connection, TcpConnectionKeyHash>;
+
+	TcpReassembler& owner;
+	BlockPool pool;
+	ConnectionMap connections;
+	std::list<TcpConnectionKey> lru; // Least recently seen connection first
+	uint64_t nextConnectionId;
+	uint64_t connectionIdStride;
+	int64_t lastExpiryUs = 0;
+
+	void Emit(const Connection& conn, TcpStreamEventType type, bool fromClient, uint64_t offset, const uint8_t* data, size_t size)
+	{
+		TcpStreamEvent event;
+		event.type = type;
+		event.connectionId = conn.id;
+		event.flowId = conn.flowId;
+		event.fromClient = fromClient;
+		event.streamOffset = offset;
+		event.data = data;
+		event.size = size;
+		event.timestampUs = conn.lastSeenUs;
+		event.clientAddr = conn.clientAddr;
+		event.serverAddr = conn.serverAddr;
+		event.clientPort = conn.clientPort;
+		event.serverPort = conn.serverPort;
+
+		for (const auto& sink : owner.sinks)
+		{
+			sink(event);
+		}
+	}
+
+	void Deliver(const Connection& conn, Direction& dir, bool fromClient, const uint8_t* data, size_t size)
+	{
+		if (size == 0) return;
+		Emit(conn, TcpStreamEventType::Data, fromClient, dir.nextOffset, data, size);
+		dir.nextOffset += size;
+		deliveredBytes.fetch_add(size, std::memory_order_relaxed);
+	}
+
+	void SkipTo(const Connection& conn, Direction& dir, bool fromClient, uint64_t offset)
+	{
+		if (offset <= dir.nextOffset) return;
+		Emit(conn, TcpStreamEventType::Gap, fromClient, dir.nextOffset, nullptr, static_cast<size_t>(offset - dir.nextOffset));
+		dir.nextOffset = offset;
+		gaps.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	// Hand over buffered segments that are now contiguous with the stream
+	void Flush(const Connection& conn, Direction& dir, bool fromClient)
+	{
+		while (!dir.pending.empty())
+		{
+			auto it = dir.pending.begin();
+			const uint64_t start = it->first;
+			if (start > dir.nextOffset) break;
+
+			Segment segment = it->second;
+			dir.pending.erase(it);
+			dir.pendingBytes -= segment.size;
+
+			// Skip whatever part was already delivered by a retransmission
+			uint64_t position = start;
+			for (Block* block = segment.head; block && position < start + segment.size; block = block->next)
+			{
+				const size_t chunk = std::min<size_t>(Block::capacity, start + segment.size - position);
+				if (position + chunk > dir.nextOffset)
+				{
+					const size_t skip = static_cast<size_t>(dir.nextOffset > position ? dir.nextOffset - position : 0);
+					Deliver(conn, dir, fromClient, block->data + skip, chunk - skip);
+				}
+				position += chunk;
+			}
+			pool.ReleaseChain(segment.head);
+		}
+	}
+
+	// Give up on the first hole: report it as a gap and deliver what follows
+	void SkipFirstHole(const Connection& conn, Direction& dir, bool fromClient)
+	{
+		if (dir.pending.empty()) return;
+		SkipTo(conn, dir, fromClient, dir.pending.begin()->first);
+		Flush(conn, dir, fromClient);
+	}
+
+	bool StorePiece(Direction& dir, uint64_t offset, const uint8_t* data, size_t size)
+	{
+		Segment segment;
+		segment.size = static_cast<uint32_t>(size);
+
+		Block** link = &segment.head;
+		for (size_t copied = 0; copied < size;)
+		{
+			Block* block = pool.Acquire();
+			if (!block)
+			{
+				pool.ReleaseChain(segment.head);
+				return false;
+			}
+
+			const size_t chunk = std::min(Block::capacity, size - copied);
+			std::copy_n(data + copied, chunk, block->data);
+			copied += chunk;
+			*link = block;
+			link = &block->next;
+		}
+
+		dir.pending.emplace(offset, segment);
+		dir.pendingBytes += size;
+		return true;
+	}
+
+	// Buffer out-of-order data. Bytes already buffered win over overlapping new bytes,
+	// so a crafted overlap cannot rewrite data that arrived first.
+	bool Buffer(Direction& dir, uint64_t start, const uint8_t* data, size_t size)
+	{
+		const uint64_t end = start + size;
+		uint64_t position = start;
+
+		auto it = dir.pending.upper_bound(position);
+		if (it != dir.pending.begin())
+		{
+			const auto prev = std::prev(it);
+			position = std::max(position, prev->first + prev->second.size);
+		}
+
+		while (position < end)
+		{
+			const auto next = dir.pending.lower_bound(position);
+			const uint64_t pieceEnd = (next == dir.pending.end()) ? end : std::min(end, next->first);
+			if (pieceEnd > position && !StorePiece(dir, position, data + (position - start), static_cast<size_t>(pieceEnd - position)))
+			{
+				return false;
+			}
+			if (next == dir.pending.end() || next->first >= end) break;
+			position = next->first + next->second.size;
+		}
+		return true;
+	}
+
+	void Close(ConnectionMap::iterator it)
+	{
+		Connection& conn = it->second;
+		for (int d = 0; d < 2; ++d)
+		{
+			Direction& dir = conn.directions[d];
+			while (!dir.pending.empty())
+			{
+				SkipFirstHole(conn, dir, d == 0);
+			}
+		}
+
+		Emit(conn, TcpStreamEventType::Closed, true, 0, nullptr, 0);
+		lru.erase(conn.lruPosition);
+		connections.erase(it);
+		connectionCount.store(connections.size(), std::memory_order_relaxed);
+	}
+
+	// The LRU list is ordered by last activity, so only the idle connections at its front are visited
+	void ExpireIdle(int64_t nowUs)
+	{
+		if (nowUs - lastExpiryUs < expiryIntervalUs) return;
+		lastExpiryUs = nowUs;
+
+		while (!lru.empty())
+		{
+			auto it = connections.find(lru.front());
+			if (nowUs - it->second.lastSeenUs <= idleTimeoutUs) break;
+			Close(it);
+			evictedConnections.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	void EvictOldest()
+	{
+		if (lru.empty()) return;
+		Close(connections.find(lru.front()));
+		evictedConnections.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	ConnectionMap::iterator FindOrCreate(const PacketLayers& layers)
+	{
+		const TcpConnectionKey key = TcpConnectionKey::FromPacket(layers);
+		auto it = connections.find(key);
+		if (it != connections.end()) return it;
+
+		if (connections.size() >= maxConnectionsPerShard)
+		{
+			EvictOldest();
+		}
+
+		Connection conn;
+		conn.id = nextConnectionId;
+		nextConnectionId += connectionIdStride;
+
+		// A SYN-ACK comes from the server, anything else is assumed to come from the client
+		const bool fromServer = layers.HasTcpFlag(PacketLayers::TcpSyn) && layers.HasTcpFlag(PacketLayers::TcpAck);
+		conn.clientAddr = fromServer ? layers.dstAddr : layers.srcAddr;
+		conn.clientPort = fromServer ? layers.dstPort : layers.srcPort;
+		conn.serverAddr = fromServer ? layers.srcAddr : layers.dstAddr;
+		conn.serverPort = fromServer ? layers.srcPort : layers.dstPort;
+
+		it = connections.emplace(key, std::move(conn)).first;
+		it->second.lruPosition = lru.insert(lru.end(), key);
+		connectionCount.store(connections.size(), std::memory_order_relaxed);
+		return it;
+	}
+
+	// length is the segment length on the wire, captured how much of it is in the packet
+	void HandleData(const Connection& conn, Direction& dir, bool fromClient, int64_t start, const uint8_t* payload, size_t captured, size_t length, bool mayRetry)
+	{
+		const int64_t next = static_cast<int64_t>(dir.nextOffset);
+		if (start + static_cast<int64_t>(length) <= next) return; // Pure retransmission
+
+		if (start <= next)
+		{
+			// In order, possibly overlapping data already delivered: pass it on without copying
+			const size_t skip = static_cast<size_t>(next - start);
+			if (skip < captured)
+			{
+				Deliver(conn, dir, fromClient, payload + skip, captured - skip);
+			}
+
+			// Bytes cut off by the capture snap length can never be recovered
+			SkipTo(conn, dir, fromClient, static_cast<uint64_t>(start) + length);
+			Flush(conn, dir, fromClient);
+			return;
+		}
+
+		if (Buffer(dir, static_cast<uint64_t>(start), payload, captured))
+		{
+			// Too much held back behind one hole, stop waiting for it
+			if (dir.pendingBytes > maxPendingPerDirection)
+			{
+				SkipFirstHole(conn, dir, fromClient);
+			}
+			return;
+		}
+
+		// Out of blocks: release what this direction holds and try once more, the segment
+		// may even be in order by then
+		while (!dir.pending.empty())
+		{
+			SkipFirstHole(conn, dir, fromClient);
+		}
+		if (mayRetry)
+		{
+			HandleData(conn, dir, fromClient, start, payload, captured, length, false);
+		}
+		else
+		{
+			gaps.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	void Process(const PacketInfo& pkt)
+	{
+		const PacketLayers& layers = pkt.layers;
+		const int64_t nowUs = ToMicroseconds(pkt.timestamp);
+		ExpireIdle(nowUs);
+
+		// A reset only ends a connection already tracked, it never creates or evicts one
+		if (layers.HasTcpFlag(PacketLayers::TcpRst))
+		{
+			auto it = connections.find(TcpConnectionKey::FromPacket(layers));
+			if (it != connections.end())
+			{
+				it->second.lastSeenUs = nowUs;
+				it->second.flowId = pkt.flowId;
+				Close(it);
+			}
+			return;
+		}
+
+		auto it = FindOrCreate(layers);
+		Connection& conn = it->second;
+		conn.lastSeenUs = nowUs;
+		conn.flowId = pkt.flowId;
+		lru.splice(lru.end(), lru, conn.lruPosition);
+
+		const bool fromClient = layers.srcAddr == conn.clientAddr && layers.srcPort == conn.clientPort;
+		Direction& dir = conn.directions[fromClient ? 0 : 1];
+
+		// Data starts after the SYN, mid-stream pickups start at the first segment seen
+		const bool syn = layers.HasTcpFlag(PacketLayers::TcpSyn);
+		const uint32_t dataSeq = layers.tcpSeq + (syn ? 1 : 0);
+		if (!dir.initialized)
+		{
+			dir.initialized = true;
+			dir.baseSeq = dataSeq;
+		}
+
+		const int64_t start = dir.OffsetOf(dataSeq);
+		const size_t length = layers.payloadLength;
+		const size_t captured = pkt.data.size() > layers.payloadOffset
+			? std::min<size_t>(length, pkt.data.size() - layers.payloadOffset)
+			: 0;
+		const uint8_t* payload = pkt.data.data() + layers.payloadOffset;
+
+		if (length > 0)
+		{
+			HandleData(conn, dir, fromClient, start, payload, captured, length, true);
+		}
+
+		if (layers.HasTcpFlag(PacketLayers::TcpFin))
+		{
+			dir.finOffset = static_cast<uint64_t>(std::max<int64_t>(start, 0)) + length;
+		}
+		if (dir.nextOffset >= dir.finOffset)
+		{
+			dir.finished = true;
+		}
+
+		if (conn.directions[0].finished && conn.directions[1].finished)
+		{
+			Close(it);
+		}
+	}
+};
+
+TcpReassembler::TcpReassembler(size_t workerCount)
+{
+	if (workerCount == 0)
+	{
+		// Leave cores for capture and the GUI
+		workerCount = std::clamp<size_t>(std::thread::hardware_concurrency() / 2, 1, 8);
+	}
+
+	for (size_t i = 0; i < workerCount; ++i)
+	{
+		shards.push_back(std::make_unique<Shard>(*this, i, workerCount));
+	}
+}
+
+TcpReassembler::~TcpReassembler()
+{
+	Stop();
+}
+
+void TcpReassembler::AddSink(TcpStreamSink sink)
+{
+	sinks.push_back(std::move(sink));
+}
+
+void TcpReassembler::Start()
+{
+	if (running.exchange(true)) return;
+
+	for (auto& shard : shards)
+	{
+		shard->worker = std::thread([s = shard.get()]() { s->Run(); });
+	}
+}
+
+void TcpReassembler::Stop()
+{
+	running.store(false, std::memory_order_release);
+
+	for (auto& shard : shards)
+	{
+		if (shard->worker.joinable())
+		{
+			shard->worker.join();
+		}
+	}
+}
+
+void TcpReassembler::Submit(const PacketRef& pkt)
+{
+	const PacketLayers& layers = pkt->layers;
+	if (!running.load(std::memory_order_relaxed) || !layers.IsTcp() || layers.moreFragments) return;
+
+	// Only segments that carry data or change the connection state matter
+	constexpr uint8_t stateFlags = PacketLayers::TcpSyn | PacketLayers::TcpFin | PacketLayers::TcpRst;
+	if (layers.payloadLength == 0 && !(layers.tcpFlags & stateFlags)) return;
+
+	Shard& shard = *shards[TcpConnectionKey::FromPacket(layers).Hash() % shards.size()];
+	PacketRef copy = pkt;
+	if (!shard.queue.TryPush(std::move(copy)))
+	{
+		droppedSegments.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+TcpReassemblyStats TcpReassembler::GetStats() const
+{
+	TcpReassemblyStats stats;
+	for (const auto& shard : shards)
+	{
+		stats.connections += shard->connectionCount.load(std::memory_order_relaxed);
+		stats.deliveredBytes += shard->deliveredBytes.load(std::memory_order_relaxed);
+		stats.gaps += shard->gaps.load(std::memory_order_relaxed);
+		stats.evictedConnections += shard->evictedConnections.load(std::memory_order_relaxed);
+	}
+	stats.bufferedBytes = bufferedBytes.load(std::memory_order_relaxed);
+	stats.droppedSegments = droppedSegments.load(std::memory_order_relaxed);
+	return stats;
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include "PacketInfo.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+enum class TcpStreamEventType : uint8_t
+{
+	Data,  // In-order application bytes
+	Gap,   // Bytes that were never captured or had to be dropped, skipped over
+	Closed // Connection ended (FIN both ways, RST, idle timeout or eviction)
+};
+
+// One step of a reassembled TCP byte stream, passed to stream sinks
+struct TcpStreamEvent
+{
+	TcpStreamEventType type = TcpStreamEventType::Data;
+	uint64_t connectionId = 0; // Unique per reassembled connection
+	uint64_t flowId = 0; // Flow of the packet that produced the event
+	bool fromClient = true; // Client is the SYN sender, or the first sender seen mid-stream
+	uint64_t streamOffset = 0; // Position of the event in this direction's byte stream
+	const uint8_t* data = nullptr; // Data events only, valid for the duration of the call
+	size_t size = 0; // Data: bytes at data, Gap: bytes skipped
+	int64_t timestampUs = 0; // Capture time of the packet that produced the event
+
+	IpAddress clientAddr;
+	IpAddress serverAddr;
+	uint16_t clientPort = 0;
+	uint16_t serverPort = 0;
+};
+
+// Called on a reassembly worker thread. All events of one connection arrive on the same
+// thread in stream order, events of different connections may arrive concurrently.
+using TcpStreamSink = std::function<void(const TcpStreamEvent&)>;
+
+struct TcpReassemblyStats
+{
+	size_t connections = 0;
+	size_t bufferedBytes = 0; // Out-of-order data waiting for a hole to fill
+	uint64_t deliveredBytes = 0;
+	uint64_t gaps = 0;
+	uint64_t droppedSegments = 0; // Worker queue full
+	uint64_t evictedConnections = 0; // Idle timeout or connection limit
+};
+
+// Rebuilds TCP byte streams from captured segments.
+// Segments are sharded by connection hash onto worker threads through single-producer
+// single-consumer queues, so a connection is only ever touched by one thread and no locks
+// are needed. In-order data is handed to the sinks straight from the packet, only
+// out-of-order data is copied into pooled blocks, bounded by a global memory limit.
+// Each shard caches only a small number of free blocks, so memory taken by a burst of
+// out-of-order data is returned once it is delivered.
+class TcpReassembler
+{
+public:
+	explicit TcpReassembler(size_t workerCount = 0); // 0 = pick from the core count
+	~TcpReassembler();
+
+	// Sinks must be added before Start
+	void AddSink(TcpStreamSink sink);
+
+	void Start();
+	void Stop(); // Drains the queues and closes every open connection
+	bool IsRunning() const { return running.load(); }
+
+	// Capture thread only. Pure ACKs without payload are ignored.
+	void Submit(const PacketRef& pkt);
+
+	void SetMemoryLimit(size_t bytes) { memoryLimit = bytes; }
+	size_t GetMemoryLimit() const { return memoryLimit.load(); }
+	TcpReassemblyStats GetStats() const;
+
+private:
+	class Shard;
+
+	std::vector<std::unique_ptr<Shard>> shards;
+	std::vector<TcpStreamSink> sinks;
+	std::atomic<bool> running{ false };
+	std::atomic<size_t> memoryLimit{ 64u << 20 };
+	std::atomic<size_t> bufferedBytes{ 0 }; // Shared by all shards' block pools
+	std::atomic<uint64_t> droppedSegments{ 0 };
+};
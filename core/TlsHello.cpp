@@ -0,0 +1,222 @@
+#include "TlsHello.h"
+#include <vector>
+
+namespace
+{
+	constexpr size_t recordHeaderSize = 5;
+	constexpr size_t maxRecordLength = 16384 + 2048; // TLSCiphertext limit
+	constexpr uint16_t extensionServerName = 0;
+	constexpr uint16_t extensionAlpn = 16;
+	constexpr uint16_t extensionSupportedVersions = 43;
+
+	// Bounds-checked big-endian reader, once a read fails every later read fails too
+	class ByteReader
+	{
+	public:
+		ByteReader(const uint8_t* data, size_t size) : position(data), end(data + size) {}
+
+		bool Ok() const { return ok; }
+		size_t Remaining() const { return ok ? static_cast<size_t>(end - position) : 0; }
+
+		uint32_t Read(size_t bytes)
+		{
+			if (!Have(bytes)) return 0;
+			uint32_t value = 0;
+			for (size_t i = 0; i < bytes; ++i)
+			{
+				value = (value << 8) | *position++;
+			}
+			return value;
+		}
+
+		void Skip(size_t bytes)
+		{
+			if (Have(bytes)) position += bytes;
+		}
+
+		// Splits off the next bytes as their own reader
+		ByteReader Take(size_t bytes)
+		{
+			if (!Have(bytes)) return ByteReader(position, 0, false);
+			ByteReader sub(position, bytes);
+			position += bytes;
+			return sub;
+		}
+
+		const uint8_t* Data() const { return position; }
+
+	private:
+		const uint8_t* position;
+		const uint8_t* end;
+		bool ok = true;
+
+		ByteReader(const uint8_t* data, size_t size, bool valid) : position(data), end(data + size), ok(valid) {}
+
+		bool Have(size_t bytes)
+		{
+			if (ok && static_cast<size_t>(end - position) < bytes) ok = false;
+			return ok;
+		}
+	};
+
+	// GREASE values (RFC 8701) are 0x?A?A and never a real version
+	bool IsGrease(uint16_t value)
+	{
+		return (value & 0x0F0F) == 0x0A0A && (value >> 8) == (value & 0xFF);
+	}
+
+	void ReadServerName(ByteReader extension, TlsHelloInfo& info)
+	{
+		ByteReader list = extension.Take(extension.Read(2));
+		while (list.Ok() && list.Remaining() >= 3)
+		{
+			const uint8_t nameType = static_cast<uint8_t>(list.Read(1));
+			ByteReader name = list.Take(list.Read(2));
+			if (nameType == 0 && name.Ok())
+			{
+				info.serverName.assign(reinterpret_cast<const char*>(name.Data()), name.Remaining());
+				return;
+			}
+		}
+	}
+
+	void ReadAlpn(ByteReader extension, TlsHelloInfo& info)
+	{
+		ByteReader list = extension.Take(extension.Read(2));
+		while (list.Ok() && list.Remaining() >= 1)
+		{
+			ByteReader protocol = list.Take(list.Read(1));
+			if (!protocol.Ok()) return;
+			if (!info.alpn.empty()) info.alpn += ',';
+			info.alpn.append(reinterpret_cast<const char*>(protocol.Data()), protocol.Remaining());
+		}
+	}
+
+	void ReadSupportedVersions(ByteReader extension, TlsHelloInfo& info)
+	{
+		if (!info.IsClientHello())
+		{
+			info.version = static_cast<uint16_t>(extension.Read(2));
+			return;
+		}
+
+		ByteReader list = extension.Take(extension.Read(1));
+		uint16_t highest = 0;
+		while (list.Ok() && list.Remaining() >= 2)
+		{
+			const uint16_t version = static_cast<uint16_t>(list.Read(2));
+			if (!IsGrease(version) && version > highest) highest = version;
+		}
+		if (highest != 0) info.version = highest;
+	}
+
+	TlsParseResult ParseHelloBody(ByteReader body, TlsHelloInfo& info)
+	{
+		info.version = static_cast<uint16_t>(body.Read(2));
+		body.Skip(32); // Random
+		body.Skip(body.Read(1)); // Session ID
+
+		if (info.IsClientHello())
+		{
+			body.Skip(body.Read(2)); // Cipher suites
+			body.Skip(body.Read(1)); // Compression methods
+		}
+		else
+		{
+			info.cipherSuite = static_cast<uint16_t>(body.Read(2));
+			body.Skip(1); // Compression method
+		}
+		if (!body.Ok()) return TlsParseResult::Malformed;
+		if (body.Remaining() == 0) return TlsParseResult::Parsed; // No extensions, as in SSL 3.0
+
+		ByteReader extensions = body.Take(body.Read(2));
+		while (extensions.Ok() && extensions.Remaining() >= 4)
+		{
+			const uint16_t type = static_cast<uint16_t>(extensions.Read(2));
+			ByteReader extension = extensions.Take(extensions.Read(2));
+			if (!extension.Ok()) break;
+
+			switch (type)
+			{
+				case extensionServerName: ReadServerName(extension, info); break;
+				case extensionAlpn: ReadAlpn(extension, info); break;
+				case extensionSupportedVersions: ReadSupportedVersions(extension, info); break;
+				default: break;
+			}
+		}
+		return extensions.Ok() ? TlsParseResult::Parsed : TlsParseResult::Malformed;
+	}
+}
+
+bool TlsHello::IsRecordStart(const uint8_t* data, size_t size)
+{
+	// Content types 20-24 and a 3.x record version
+	return size >= 3 && data[0] >= 20 && data[0] <= 24 && data[1] == 3 && data[2] <= 4;
+}
+
+TlsParseResult TlsHello::Parse(const uint8_t* data, size_t size, TlsHelloInfo& info)
+{
+	// The common rejection, encrypted records and everything that is not TLS, is one compare
+	if (size == 0) return TlsParseResult::Incomplete;
+	if (data[0] != contentHandshake) return TlsParseResult::NotHello;
+	if (size < recordHeaderSize + 4) return TlsParseResult::Incomplete;
+	if (data[1] != 3) return TlsParseResult::NotHello;
+
+	const uint8_t type = data[recordHeaderSize];
+	if (type != clientHello && type != serverHello) return TlsParseResult::NotHello;
+
+	const size_t helloLength = (static_cast<size_t>(data[6]) << 16) | (static_cast<size_t>(data[7]) << 8) | data[8];
+	if (helloLength + 4 > maxHelloSize) return TlsParseResult::Malformed;
+
+	// A hello usually sits in one record, which is parsed in place. Hellos fragmented
+	// over several records are joined into a buffer first.
+	const size_t firstRecordLength = (static_cast<size_t>(data[3]) << 8) | data[4];
+	std::vector<uint8_t> joined;
+	const uint8_t* handshake = data + recordHeaderSize;
+
+	if (firstRecordLength < helloLength + 4)
+	{
+		size_t position = 0;
+		while (joined.size() < helloLength + 4)
+		{
+			if (size < position + recordHeaderSize) return TlsParseResult::Incomplete;
+			const size_t recordLength = (static_cast<size_t>(data[position + 3]) << 8) | data[position + 4];
+			if (data[position] != contentHandshake || recordLength == 0 || recordLength > maxRecordLength) return TlsParseResult::Malformed;
+			if (size < position + recordHeaderSize + recordLength) return TlsParseResult::Incomplete;
+
+			joined.insert(joined.end(), data + position + recordHeaderSize, data + position + recordHeaderSize + recordLength);
+			position += recordHeaderSize + recordLength;
+		}
+		handshake = joined.data();
+	}
+	else if (size < recordHeaderSize + helloLength + 4)
+	{
+		return TlsParseResult::Incomplete;
+	}
+
+	info = TlsHelloInfo{};
+	info.handshakeType = type;
+	return ParseHelloBody(ByteReader(handshake + 4, helloLength), info);
+}
+
+const char* TlsHello::VersionName(uint16_t version)
+{
+	switch (version)
+	{
+		case 0x0300: return "SSL 3.0";
+		case 0x0301: return "TLS 1.0";
+		case 0x0302: return "TLS 1.1";
+		case 0x0303: return "TLS 1.2";
+		case 0x0304: return "TLS 1.3";
+		default: return nullptr;
+	}
+}
+
+std::string TlsHello::FormatSummary(const TlsHelloInfo& info)
+{
+	const char* version = VersionName(info.version);
+	std::string summary = version ? version : "TLS";
+	if (!info.alpn.empty()) summary += ", " + info.alpn;
+	if (!info.serverName.empty()) summary += ", " + info.serverName;
+	return summary;
+}
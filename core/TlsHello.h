@@ -0,0 +1,44 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// What a ClientHello offers or a ServerHello selects
+struct TlsHelloInfo
+{
+	uint8_t handshakeType = 0; // TlsHello::clientHello or TlsHello::serverHello
+	uint16_t version = 0; // Highest version offered, or the negotiated one. supported_versions wins over the legacy field.
+	uint16_t cipherSuite = 0; // ServerHello only
+	std::string serverName; // SNI host name, ClientHello only
+	std::string alpn; // Comma-separated protocols offered, or the one selected
+
+	bool IsClientHello() const { return handshakeType == 1; }
+};
+
+enum class TlsParseResult : uint8_t
+{
+	NotHello, // Not a handshake record, or a handshake other than a hello
+	Incomplete, // Looks like a hello but more bytes are needed
+	Malformed,
+	Parsed
+};
+
+// Extracts SNI, ALPN and the version from ClientHello and ServerHello messages.
+// The input starts at a TLS record boundary, e.g. the first bytes of a TCP stream.
+// Anything that is not a handshake record is rejected from its first byte.
+class TlsHello
+{
+public:
+	static constexpr uint8_t contentHandshake = 22;
+	static constexpr uint8_t clientHello = 1;
+	static constexpr uint8_t serverHello = 2;
+	static constexpr size_t maxHelloSize = 32 * 1024; // Bytes buffered at most while waiting for a split hello
+
+	static TlsParseResult Parse(const uint8_t* data, size_t size, TlsHelloInfo& info);
+
+	// True when data could start a TLS record of any content type
+	static bool IsRecordStart(const uint8_t* data, size_t size);
+
+	static const char* VersionName(uint16_t version); // "TLS 1.3", or nullptr when unknown
+	static std::string FormatSummary(const TlsHelloInfo& info); // e.g. "TLS 1.3, h2, example.com"
+};
@@ -0,0 +1,127 @@
+#include "TlsTracker.h"
+#include <algorithm>
+
+namespace
+{
+	constexpr size_t maxConnections = 4096;
+}
+
+TlsTracker::TlsTracker(HelloCallback callback)
+	: onHello(std::move(callback))
+{
+}
+
+void TlsTracker::OnStreamEvent(const TcpStreamEvent& event)
+{
+	const size_t side = event.fromClient ? 0 : 1;
+
+	if (event.type == TcpStreamEventType::Closed)
+	{
+		std::scoped_lock lock(mutex);
+		connections.erase(event.connectionId);
+		return;
+	}
+
+	// Bulk data past the hello window never takes the lock
+	if (event.streamOffset >= TlsHello::maxHelloSize) return;
+
+	if (event.type == TcpStreamEventType::Gap)
+	{
+		std::scoped_lock lock(mutex);
+		auto it = connections.find(event.connectionId);
+		if (it != connections.end())
+		{
+			Direction& dir = it->second.directions[side];
+			dir.waiting = false;
+			dir.buffer = {};
+		}
+		return;
+	}
+
+	if (event.streamOffset == 0)
+	{
+		// Most streams are rejected here on their first byte
+		if (event.size == 0 || event.data[0] != TlsHello::contentHandshake) return;
+
+		TlsHelloInfo info;
+		const TlsParseResult result = TlsHello::Parse(event.data, event.size, info);
+		if (result != TlsParseResult::Parsed && result != TlsParseResult::Incomplete) return;
+
+		std::scoped_lock lock(mutex);
+		auto it = connections.find(event.connectionId);
+		if (it == connections.end() && connections.size() < maxConnections)
+		{
+			it = connections.emplace(event.connectionId, Connection{}).first;
+		}
+		Connection* conn = it != connections.end() ? &it->second : nullptr;
+
+		if (result == TlsParseResult::Parsed)
+		{
+			Deliver(conn, event, info);
+		}
+		else if (conn)
+		{
+			Direction& dir = conn->directions[side];
+			dir.buffer.assign(event.data, event.data + event.size);
+			dir.waiting = true;
+		}
+		return;
+	}
+
+	std::scoped_lock lock(mutex);
+	auto it = connections.find(event.connectionId);
+	if (it == connections.end()) return;
+
+	Direction& dir = it->second.directions[side];
+	if (!dir.waiting || dir.buffer.size() != event.streamOffset) return;
+
+	const size_t toCopy = std::min(event.size, TlsHello::maxHelloSize - dir.buffer.size());
+	dir.buffer.insert(dir.buffer.end(), event.data, event.data + toCopy);
+
+	TlsHelloInfo info;
+	const TlsParseResult result = TlsHello::Parse(dir.buffer.data(), dir.buffer.size(), info);
+	if (result == TlsParseResult::Incomplete && dir.buffer.size() < TlsHello::maxHelloSize) return;
+
+	dir.waiting = false;
+	dir.buffer = {};
+	if (result == TlsParseResult::Parsed)
+	{
+		splitHelloCount.fetch_add(1, std::memory_order_relaxed);
+		Deliver(&it->second, event, info);
+	}
+}
+
+void TlsTracker::Deliver(Connection* conn, const TcpStreamEvent& event, const TlsHelloInfo& info)
+{
+	helloCount.fetch_add(1, std::memory_order_relaxed);
+
+	if (info.IsClientHello())
+	{
+		if (conn)
+		{
+			conn->clientHello = info;
+			conn->clientFlowId = event.flowId;
+			conn->haveClientHello = true;
+		}
+		onHello(event.flowId, info);
+		return;
+	}
+
+	// The ServerHello settles version and ALPN, the name only comes from the client
+	TlsHelloInfo merged = info;
+	if (conn && conn->haveClientHello)
+	{
+		merged.serverName = conn->clientHello.serverName;
+		if (conn->clientFlowId != event.flowId)
+		{
+			onHello(conn->clientFlowId, merged);
+		}
+	}
+	onHello(event.flowId, merged);
+
+	// Both hellos seen, nothing more to learn from this connection
+	if (conn && conn->haveClientHello)
+	{
+		connections.erase(event.connectionId);
+	}
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include "TcpReassembler.h"
+#include "TlsHello.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Stream sink that finds TLS hellos at the start of each reassembled TCP stream, including
+// hellos split over several segments. Streams whose first byte is not a handshake record
+// are dropped on that byte and never buffered.
+class TlsTracker
+{
+public:
+	// Called with the flow of the packet that completed the hello. A ServerHello is reported
+	// to the flows of both directions, merged with the server name from the ClientHello.
+	using HelloCallback = std::function<void(uint64_t flowId, const TlsHelloInfo& info)>;
+
+	explicit TlsTracker(HelloCallback callback);
+
+	// Reassembly worker threads
+	void OnStreamEvent(const TcpStreamEvent& event);
+
+	uint64_t GetHelloCount() const { return helloCount.load(); }
+	uint64_t GetSplitHelloCount() const { return splitHelloCount.load(); }
+
+private:
+	struct Direction
+	{
+		std::vector<uint8_t> buffer; // Stream bytes so far while a hello is incomplete
+		bool waiting = false;
+	};
+
+	struct Connection
+	{
+		Direction directions[2]; // Client, server
+		TlsHelloInfo clientHello;
+		uint64_t clientFlowId = 0;
+		bool haveClientHello = false;
+	};
+
+	HelloCallback onHello;
+	std::mutex mutex;
+	std::unordered_map<uint64_t, Connection> connections; // By reassembler connection ID
+	std::atomic<uint64_t> helloCount{ 0 };
+	std::atomic<uint64_t> splitHelloCount{ 0 };
+
+	void Deliver(Connection* conn, const TcpStreamEvent& event, const TlsHelloInfo& info); // Requires mutex
+};
@@ -0,0 +1,118 @@
+#include "TrafficStats.h"
+
+TrafficStats::Protocol TrafficStats::ProtocolFromIpProtocol(uint8_t ipProtocol)
+{
+	switch (ipProtocol)
+	{
+		case 6: return Protocol::TCP;
+		case 17: return Protocol::UDP;
+		case 1: return Protocol::ICMP;
+		case 58: return Protocol::ICMP;
+		default: return Protocol::Other;
+	}
+}
+
+template <size_t N>
+void TrafficStats::Ring<N>::Add(int64_t unixSeconds, uint32_t bytes, size_t protocol)
+{
+	const int64_t slot = unixSeconds / widthSeconds;
+	Bucket& bucket = buckets[static_cast<size_t>(slot) % N];
+
+	// Recycle the bucket when time moved past its slot. Counters are cleared before the
+	// new slot is published so readers never attribute old counts to it.
+	if (bucket.slot.load(std::memory_order_relaxed) != slot)
+	{
+		bucket.slot.store(-1, std::memory_order_relaxed);
+		bucket.packets.store(0, std::memory_order_relaxed);
+		bucket.bytes.store(0, std::memory_order_relaxed);
+		for (auto& counter : bucket.protocolPackets)
+		{
+			counter.store(0, std::memory_order_relaxed);
+		}
+		bucket.slot.store(slot, std::memory_order_release);
+	}
+
+	bucket.packets.store(bucket.packets.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	bucket.bytes.store(bucket.bytes.load(std::memory_order_relaxed) + bytes, std::memory_order_relaxed);
+	auto& counter = bucket.protocolPackets[protocol];
+	counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+template <size_t N>
+bool TrafficStats::Ring<N>::Read(int64_t slot, Metric metric, float& value) const
+{
+	const Bucket& bucket = buckets[static_cast<size_t>(slot) % N];
+	if (bucket.slot.load(std::memory_order_acquire) != slot)
+	{
+		return false;
+	}
+
+	uint64_t count = 0;
+	switch (metric)
+	{
+		case Metric::PacketsPerSecond: count = bucket.packets.load(std::memory_order_relaxed); break;
+		case Metric::BitsPerSecond: count = bucket.bytes.load(std::memory_order_relaxed) * 8; break;
+		case Metric::TcpPacketsPerSecond: count = bucket.protocolPackets[0].load(std::memory_order_relaxed); break;
+		case Metric::UdpPacketsPerSecond: count = bucket.protocolPackets[1].load(std::memory_order_relaxed); break;
+		case Metric::IcmpPacketsPerSecond: count = bucket.protocolPackets[2].load(std::memory_order_relaxed); break;
+		case Metric::OtherPacketsPerSecond: count = bucket.protocolPackets[3].load(std::memory_order_relaxed); break;
+	}
+
+	// The writer may have recycled the bucket while we were reading
+	if (bucket.slot.load(std::memory_order_acquire) != slot)
+	{
+		return false;
+	}
+
+	value = static_cast<float>(count) / static_cast<float>(widthSeconds);
+	return true;
+}
+
+template <size_t N>
+void TrafficStats::Ring<N>::Series(Metric metric, int64_t nowSeconds, std::vector<float>& out) const
+{
+	out.assign(N, 0.0f);
+
+	const int64_t lastSlot = nowSeconds / widthSeconds;
+	for (size_t i = 0; i < N; ++i)
+	{
+		const int64_t slot = lastSlot - static_cast<int64_t>(N - 1 - i);
+		if (slot < 0) continue;
+
+		float value = 0.0f;
+		if (Read(slot, metric, value))
+		{
+			out[i] = value;
+		}
+	}
+}
+
+void TrafficStats::AddPacket(int64_t unixSeconds, uint32_t bytes, Protocol protocol)
+{
+	const size_t index = static_cast<size_t>(protocol);
+	seconds.Add(unixSeconds, bytes, index);
+	tenSeconds.Add(unixSeconds, bytes, index);
+	minutes.Add(unixSeconds, bytes, index);
+}
+
+void TrafficStats::GetSeries(Resolution resolution, Metric metric, int64_t nowSeconds, std::vector<float>& out) const
+{
+	switch (resolution)
+	{
+		case Resolution::OneSecond: seconds.Series(metric, nowSeconds, out); break;
+		case Resolution::TenSeconds: tenSeconds.Series(metric, nowSeconds, out); break;
+		case Resolution::OneMinute: minutes.Series(metric, nowSeconds, out); break;
+	}
+}
+
+float TrafficStats::GetRate(Resolution resolution, Metric metric, int64_t nowSeconds) const
+{
+	float value = 0.0f;
+	switch (resolution)
+	{
+		case Resolution::OneSecond: seconds.Read(nowSeconds - 1, metric, value); break;
+		case Resolution::TenSeconds: tenSeconds.Read(nowSeconds / 10 - 1, metric, value); break;
+		case Resolution::OneMinute: minutes.Read(nowSeconds / 60 - 1, metric, value); break;
+	}
+	return value;
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Per-second traffic counters kept in fixed-size rings at several resolutions.
+// Written by the capture thread only and read by the GUI without locks.
+class TrafficStats
+{
+public:
+	enum class Resolution
+	{
+		OneSecond,
+		TenSeconds,
+		OneMinute
+	};
+
+	enum class Protocol
+	{
+		TCP,
+		UDP,
+		ICMP,
+		Other,
+		Count
+	};
+
+	enum class Metric
+	{
+		PacketsPerSecond,
+		BitsPerSecond,
+		TcpPacketsPerSecond,
+		UdpPacketsPerSecond,
+		IcmpPacketsPerSecond,
+		OtherPacketsPerSecond
+	};
+
+	static Protocol ProtocolFromIpProtocol(uint8_t ipProtocol);
+
+	// Capture thread only: account one packet at its capture time
+	void AddPacket(int64_t unixSeconds, uint32_t bytes, Protocol protocol);
+
+	// Fill out with per-second rates, oldest first, for the buckets ending at nowSeconds
+	void GetSeries(Resolution resolution, Metric metric, int64_t nowSeconds, std::vector<float>& out) const;
+
+	// Rate over the last completed bucket of the given resolution
+	float GetRate(Resolution resolution, Metric metric, int64_t nowSeconds) const;
+
+private:
+	static constexpr size_t protocolCount = static_cast<size_t>(Protocol::Count);
+
+	struct Bucket
+	{
+		std::atomic<int64_t> slot{ -1 }; // Which time slot the counters belong to
+		std::atomic<uint64_t> packets{ 0 };
+		std::atomic<uint64_t> bytes{ 0 };
+		std::array<std::atomic<uint64_t>, protocolCount> protocolPackets{};
+	};
+
+	// Single-writer ring, counters are updated with plain load/store instead of locked RMW
+	template <size_t N>
+	struct Ring
+	{
+		explicit Ring(int64_t width) : widthSeconds(width) {}
+
+		const int64_t widthSeconds;
+		std::array<Bucket, N> buckets;
+
+		void Add(int64_t unixSeconds, uint32_t bytes, size_t protocol);
+		bool Read(int64_t slot, Metric metric, float& value) const;
+		void Series(Metric metric, int64_t nowSeconds, std::vector<float>& out) const;
+	};
+
+	Ring<300> seconds{ 1 };    // 5 minutes
+	Ring<360> tenSeconds{ 10 }; // 1 hour
+	Ring<1440> minutes{ 60 };  // 24 hours
+};
@@ -5,13 +5,21 @@
 #include "backends/imgui_impl_opengl3.h"
 #include "backends/imgui_impl_sdl2.h"
 #include "core/CaptureEngine.h"
+#include "PacketViewModel.h"
 #include "panels/CaptureControlPanel.h"
+#include "panels/TrafficChartPanel.h"
 #include "panels/PacketListPanel.h"
 #include "panels/PacketDetailPanel.h"
 #include "core/PingEngine.h"
 #include "panels/PingToolPanel.h"
 #include "core/PacketCrafterEngine.h"
 #include "panels/PacketCrafterPanel.h"
+#include "panels/DnsStatsPanel.h"
+#include "panels/HttpStatsPanel.h"
+#include "panels/DiagnosticsPanel.h"
+#include "panels/TopTalkersPanel.h"
+#include "panels/AlertsPanel.h"
+#include "panels/RulesPanel.h"
 
 
 #ifdef _WIN32
@@ -23,14 +31,22 @@
 // The difference between shared and unique ptr here is that the CaptureEngine is shared between multiple panels
 // Unique is only when one owner exists, its the recommended default, but shared is needed for shared ownership
 std::shared_ptr<CaptureEngine> captureEngine;
+std::shared_ptr<PacketViewModel> packetViewModel;
 std::shared_ptr<PingEngine> pingEngine;
 std::shared_ptr<PacketCrafterEngine> packetCrafterEngine;
 
 std::unique_ptr<CaptureControlPanel> capturePanel;
+std::unique_ptr<TrafficChartPanel> trafficChartPanel;
+std::unique_ptr<TopTalkersPanel> topTalkersPanel;
+std::unique_ptr<AlertsPanel> alertsPanel;
+std::unique_ptr<RulesPanel> rulesPanel;
 std::unique_ptr<PacketListPanel> packetListPanel;
 std::unique_ptr<PacketDetailPanel> packetDetailPanel;
 std::unique_ptr<PingToolPanel> pingToolPanel;
 std::unique_ptr<PacketCrafterPanel> packetCrafterPanel;
+std::unique_ptr<DnsStatsPanel> dnsStatsPanel;
+std::unique_ptr<HttpStatsPanel> httpStatsPanel;
+std::unique_ptr<DiagnosticsPanel> diagnosticsPanel;
 
 GuiManager::GuiManager()
 	: window(nullptr), glContext(nullptr), running(true), activeTab(AppTab::PacketInspector)
@@ -126,11 +142,18 @@ bool GuiManager::Initialize()
 
 	captureEngine = std::make_shared<CaptureEngine>();
 	capturePanel = std::make_unique<CaptureControlPanel>(captureEngine);
-	packetListPanel = std::make_unique<PacketListPanel>(captureEngine);
+	trafficChartPanel = std::make_unique<TrafficChartPanel>(captureEngine);
+	topTalkersPanel = std::make_unique<TopTalkersPanel>(captureEngine);
+	alertsPanel = std::make_unique<AlertsPanel>(captureEngine);
+	rulesPanel = std::make_unique<RulesPanel>(captureEngine);
+	// View model prepares packet list snapshots on its own thread
+	packetViewModel = std::make_shared<PacketViewModel>(captureEngine);
+	packetViewModel->Start();
+	packetListPanel = std::make_unique<PacketListPanel>(captureEngine, packetViewModel);
 	// Lambda passes the selected packet from PacketListPanel to PacketDetailPanel
-	packetDetailPanel = std::make_unique<PacketDetailPanel>([this]() -> std::optional<PacketInfo>
+	packetDetailPanel = std::make_unique<PacketDetailPanel>([this]() -> PacketRef
 		{
-			return packetListPanel ? packetListPanel->GetSelectedPacket() : std::optional<PacketInfo>{};
+			return packetListPanel ? packetListPanel->GetSelectedPacket() : nullptr;
 		});
 
 	pingEngine = std::make_shared<PingEngine>();
@@ -139,6 +162,10 @@ bool GuiManager::Initialize()
 	packetCrafterEngine = std::make_shared<PacketCrafterEngine>();
 	packetCrafterPanel = std::make_unique<PacketCrafterPanel>(packetCrafterEngine);
 
+	dnsStatsPanel = std::make_unique<DnsStatsPanel>(captureEngine);
+	httpStatsPanel = std::make_unique<HttpStatsPanel>(captureEngine);
+	diagnosticsPanel = std::make_unique<DiagnosticsPanel>(captureEngine);
+
 	return true;
 }
 
@@ -200,6 +227,9 @@ void GuiManager::NewFrame()
 		case AppTab::PacketCrafter:
 			RenderPacketCrafterTab();
 			break;
+		case AppTab::Analytics:
+			RenderAnalyticsTab();
+			break;
 	}
 
 	ImGui::End();
@@ -296,6 +326,30 @@ void GuiManager::RenderTabBar(int displayW)
 	}
 	ImGui::PopStyleColor(4);
 
+	ImGui::SameLine();
+
+	// Analytics Tab
+	if (activeTab == AppTab::Analytics)
+	{
+		ImGui::PushStyleColor(ImGuiCol_Button, activeTabColor);
+		ImGui::PushStyleColor(ImGuiCol_ButtonHovered, activeTabColor);
+		ImGui::PushStyleColor(ImGuiCol_ButtonActive, activeTabColor);
+		ImGui::PushStyleColor(ImGuiCol_Text, activeTabTextColor);
+	}
+	else
+	{
+		ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0.12f, 0.12f, 0.12f, 0.3f));
+		ImGui::PushStyleColor(ImGuiCol_ButtonHovered, inactiveHoverColor);
+		ImGui::PushStyleColor(ImGuiCol_ButtonActive, buttonActiveColor);
+		ImGui::PushStyleColor(ImGuiCol_Text, inactiveTabTextColor);
+	}
+
+	if (ImGui::Button("Analytics"))
+	{
+		activeTab = AppTab::Analytics;
+	}
+	ImGui::PopStyleColor(4);
+
 	// Exit button on the far right with normal styling
 	ImGui::SameLine(displayW - 95.0f);
 	ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2(12.0f, 8.0f));
@@ -312,6 +366,10 @@ void GuiManager::RenderTabBar(int displayW)
 void GuiManager::RenderPacketInspectorTab()
 {
 	capturePanel->Render();
+	trafficChartPanel->Render();
+	topTalkersPanel->Render();
+	alertsPanel->Render();
+	rulesPanel->Render();
 	ImGui::Separator();
 
 	ImVec2 availableRegion = ImGui::GetContentRegionAvail();
@@ -330,7 +388,7 @@ void GuiManager::RenderPacketInspectorTab()
 	// Right Panel - Flow Details (TOP) and Packet Details (BOTTOM)
 	ImGui::BeginChild("DetailsRegion", ImVec2(rightPanelWidth, availableRegion.y), true);
 	
-	if (!packetListPanel->selectedFlowKey.empty())
+	if (packetListPanel->HasSelectedFlow())
 	{
 		// Flow details in top half
 		ImGui::BeginChild("FlowDetailsRegion", ImVec2(0, availableRegion.y * 0.5f - 5), true);
@@ -342,6 +400,11 @@ void GuiManager::RenderPacketInspectorTab()
 		packetDetailPanel->Render();
 		ImGui::EndChild();
 	}
+	else if (packetListPanel->HasSelectedSearchResult())
+	{
+		// Search hits are not tied to a flow in the recent buffer, the packet gets the whole region
+		packetDetailPanel->Render();
+	}
 	else
 	{
 		ImGui::TextWrapped("Select a flow from the packet list to view its details here.");
@@ -368,6 +431,23 @@ void GuiManager::RenderPacketCrafterTab()
 	}
 }
 
+// Render Analytics tab content, statistics gathered from the live capture
+void GuiManager::RenderAnalyticsTab()
+{
+	if (dnsStatsPanel)
+	{
+		dnsStatsPanel->Render();
+	}
+	if (httpStatsPanel)
+	{
+		httpStatsPanel->Render();
+	}
+	if (diagnosticsPanel)
+	{
+		diagnosticsPanel->Render();
+	}
+}
+
 // Render ImGui draw data and swap buffers
 void GuiManager::Render()
 {
@@ -391,9 +471,21 @@ void GuiManager::Render()
 // Shutdown ImGui and SDL subsystems and clean up resources
 void GuiManager::Shutdown()
 {
-	// Clean up panels and capture engine
+	// Clean up panels and capture engine, the view model thread must stop before the engine goes away
 	packetListPanel.reset();
+	if (packetViewModel)
+	{
+		packetViewModel->Stop();
+		packetViewModel.reset();
+	}
 	capturePanel.reset();
+	trafficChartPanel.reset();
+	topTalkersPanel.reset();
+	alertsPanel.reset();
+	rulesPanel.reset();
+	dnsStatsPanel.reset();
+	httpStatsPanel.reset();
+	diagnosticsPanel.reset();
 	captureEngine.reset();
 	pingToolPanel.reset();
 	pingEngine.reset();
@@ -21,7 +21,8 @@ private:
 	{
 		PacketInspector,
 		PingTool,
-		PacketCrafter
+		PacketCrafter,
+		Analytics
 	};
 
 	SDL_Window* window;
@@ -33,6 +34,7 @@ private:
 	void RenderPacketInspectorTab();
 	void RenderPingToolTab();
 	void RenderPacketCrafterTab();
+	void RenderAnalyticsTab();
 
 
 #ifdef _WIN32
@@ -0,0 +1,260 @@
+#include "PacketViewModel.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <ctime>
+#include <optional>
+
+namespace
+{
+	std::string FormatTime(std::chrono::system_clock::time_point timestamp)
+	{
+		auto timeT = std::chrono::system_clock::to_time_t(timestamp);
+		std::tm tm;
+#ifdef _WIN32
+		localtime_s(&tm, &timeT);
+#else
+		localtime_r(&timeT, &tm);
+#endif
+		char buf[16];
+		strftime(buf, sizeof(buf), "%H:%M:%S", &tm);
+		return buf;
+	}
+
+	std::string ToLower(std::string text)
+	{
+		std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+		return text;
+	}
+
+	// Case-insensitive substring match, an empty filter matches everything
+	bool Matches(const std::string& filter, const std::string& text)
+	{
+		return filter.empty() || ToLower(text).find(filter) != std::string::npos;
+	}
+
+	// "vlan:<id>" at the start of the filter selects a single VLAN, the rest is a substring match
+	struct RowFilter
+	{
+		std::optional<uint16_t> vlanId;
+		std::string text;
+
+		bool Matches(uint16_t rowVlanId, const std::string& rowText) const
+		{
+			return (!vlanId || *vlanId == rowVlanId) && ::Matches(text, rowText);
+		}
+	};
+
+	RowFilter ParseFilter(const std::string& filter)
+	{
+		RowFilter result;
+		result.text = filter;
+
+		static const std::string prefix = "vlan:";
+		if (filter.compare(0, prefix.size(), prefix) != 0) return result;
+
+		size_t end = prefix.size();
+		uint32_t id = 0;
+		while (end < filter.size() && std::isdigit(static_cast<unsigned char>(filter[end])) && id <= 4095)
+		{
+			id = id * 10 + (filter[end++] - '0');
+		}
+		if (end == prefix.size() || id > 4095) return result;
+
+		result.vlanId = static_cast<uint16_t>(id);
+		while (end < filter.size() && filter[end] == ' ') ++end;
+		result.text = filter.substr(end);
+		return result;
+	}
+}
+
+PacketRow PacketViewModel::MakePacketRow(const PacketInfo& pkt)
+{
+	PacketRow row;
+	row.sequence = pkt.sequence;
+	row.incoming = pkt.incoming;
+	row.length = pkt.length;
+	row.vlanId = pkt.layers.OuterVlan();
+	row.time = FormatTime(pkt.timestamp);
+	row.protocol = pkt.GetTransportName();
+	row.source = pkt.layers.srcAddr.ToEndpointString(pkt.layers.srcPort);
+	row.destination = pkt.layers.dstAddr.ToEndpointString(pkt.layers.dstPort);
+	row.info = pkt.GetInfoString();
+	return row;
+}
+
+const FlowRow* PacketViewSnapshot::FindFlow(uint64_t flowId) const
+{
+	auto it = flowIndex.find(flowId);
+	if (it == flowIndex.end())
+	{
+		return nullptr;
+	}
+
+	const auto& [incoming, index] = it->second;
+	return incoming ? &incomingFlows[index] : &outgoingFlows[index];
+}
+
+PacketViewModel::PacketViewModel(std::shared_ptr<CaptureEngine> engine)
+	: captureEngine(std::move(engine)), snapshot(std::make_shared<PacketViewSnapshot>())
+{
+}
+
+PacketViewModel::~PacketViewModel()
+{
+	Stop();
+}
+
+void PacketViewModel::Start()
+{
+	if (running.exchange(true))
+	{
+		return;
+	}
+	worker = std::thread(&PacketViewModel::WorkerLoop, this);
+}
+
+void PacketViewModel::Stop()
+{
+	{
+		std::scoped_lock lock(wakeMutex);
+		running.store(false);
+	}
+	wakeCondition.notify_all();
+
+	if (worker.joinable())
+	{
+		worker.join();
+	}
+}
+
+void PacketViewModel::SetRefreshRate(int hz)
+{
+	refreshRateHz.store(std::clamp(hz, 1, 60));
+}
+
+void PacketViewModel::SetFilter(const std::string& text)
+{
+	std::scoped_lock lock(settingsMutex);
+	filter = ToLower(text);
+}
+
+void PacketViewModel::SetFlowSort(FlowSort sort)
+{
+	flowSort.store(sort);
+}
+
+std::shared_ptr<const PacketViewSnapshot> PacketViewModel::GetSnapshot() const
+{
+	std::scoped_lock lock(snapshotMutex);
+	return snapshot;
+}
+
+// Rebuild the snapshot at the configured rate until stopped
+void PacketViewModel::WorkerLoop()
+{
+	while (running.load())
+	{
+		auto next = BuildSnapshot();
+		{
+			std::scoped_lock lock(snapshotMutex);
+			snapshot = std::move(next);
+		}
+
+		std::unique_lock lock(wakeMutex);
+		const auto interval = std::chrono::milliseconds(1000 / refreshRateHz.load());
+		wakeCondition.wait_for(lock, interval, [this]() { return !running.load(); });
+	}
+}
+
+std::shared_ptr<const PacketViewSnapshot> PacketViewModel::BuildSnapshot()
+{
+	RowFilter rowFilter;
+	{
+		std::scoped_lock lock(settingsMutex);
+		rowFilter = ParseFilter(filter);
+	}
+
+	auto result = std::make_shared<PacketViewSnapshot>();
+
+	// One pass over the recent packets formats every row and buckets it by flow
+	const auto packets = captureEngine->GetRecentPackets();
+	std::unordered_map<uint64_t, std::vector<PacketRow>> flowPackets;
+	result->recentPackets.reserve(packets.size());
+
+	for (const auto& ref : packets)
+	{
+		PacketRow row = MakePacketRow(*ref);
+		if (!ref->ruleMatches.empty())
+		{
+			row.rules = captureEngine->GetRuleEngine().FormatRuleNames(ref->ruleMatches);
+		}
+		if (rowFilter.Matches(row.vlanId, row.protocol + " " + row.source + " " + row.destination + " " + row.rules))
+		{
+			result->recentPackets.push_back(row);
+		}
+		flowPackets[ref->flowId].push_back(std::move(row));
+	}
+
+	// Flows come back ordered by address and port, re-sort if requested
+	const FlowSort sort = flowSort.load();
+	auto buildFlows = [&](bool incoming, std::vector<FlowRow>& rows)
+	{
+		for (const auto& flow : captureEngine->GetFlows(incoming))
+		{
+			if (!rowFilter.Matches(flow.vlanId, flow.protocol + " " + flow.endpoint + " " + flow.serverName)) continue;
+
+			FlowRow row;
+			row.id = flow.id;
+			row.incoming = flow.incoming;
+			row.port = flow.port;
+			row.vlanId = flow.vlanId;
+			row.address = flow.address;
+			row.protocol = flow.protocol;
+			row.isTcp = flow.protocol == "TCP";
+			row.tcp = flow.tcp;
+			row.connections = flow.connections;
+			row.serverName = flow.serverName;
+			row.tls = flow.tls;
+			row.title = std::string(incoming ? "Incoming" : "Outgoing") + " Flow: " + flow.endpoint;
+			if (flow.vlanId != 0)
+			{
+				row.title += " (VLAN " + std::to_string(flow.vlanId) + ")";
+			}
+			if (flow.quicConnection != 0)
+			{
+				row.title += " (QUIC connection " + std::to_string(flow.quicConnection) + ")";
+			}
+
+			auto it = flowPackets.find(flow.id);
+			if (it != flowPackets.end())
+			{
+				row.packets = std::move(it->second);
+			}
+			row.packetCount = row.packets.size();
+			rows.push_back(std::move(row));
+		}
+
+		if (sort == FlowSort::PacketCount)
+		{
+			std::stable_sort(rows.begin(), rows.end(), [](const FlowRow& a, const FlowRow& b) { return a.packetCount > b.packetCount; });
+		}
+		else if (sort == FlowSort::Rtt)
+		{
+			std::stable_sort(rows.begin(), rows.end(), [](const FlowRow& a, const FlowRow& b) { return a.tcp.AverageRttMs() > b.tcp.AverageRttMs(); });
+		}
+		else if (sort == FlowSort::Retransmissions)
+		{
+			std::stable_sort(rows.begin(), rows.end(), [](const FlowRow& a, const FlowRow& b) { return a.tcp.retransmissions > b.tcp.retransmissions; });
+		}
+
+		for (size_t i = 0; i < rows.size(); ++i)
+		{
+			result->flowIndex[rows[i].id] = { incoming, i };
+		}
+	};
+
+	buildFlows(true, result->incomingFlows);
+	buildFlows(false, result->outgoingFlows);
+	return result;
+}
@@ -0,0 +1,108 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "core/CaptureEngine.h"
+
+// Pre-formatted packet row, ready to be drawn as-is
+struct PacketRow
+{
+	uint64_t sequence = 0;
+	bool incoming = false;
+	uint32_t length = 0;
+	uint16_t vlanId = 0;
+	std::string time;
+	std::string protocol;
+	std::string source;
+	std::string destination;
+	std::string info;
+	std::string rules; // Names of the capture rules the packet matched
+};
+
+// Pre-formatted flow row with the packets that belong to it
+struct FlowRow
+{
+	uint64_t id = 0;
+	bool incoming = false;
+	uint16_t port = 0;
+	uint16_t vlanId = 0;
+	size_t packetCount = 0;
+	bool isTcp = false;
+	TcpFlowStats tcp;
+	std::vector<TcpConnectionSummary> connections;
+	std::string address;
+	std::string serverName; // TLS SNI, empty until a hello is seen
+	std::string tls;
+	std::string protocol;
+	std::string title; // e.g. "Incoming Flow: 1.2.3.4:443"
+	std::vector<PacketRow> packets;
+};
+
+// Immutable view of the capture state, built off the UI thread
+struct PacketViewSnapshot
+{
+	std::vector<FlowRow> incomingFlows;
+	std::vector<FlowRow> outgoingFlows;
+	std::vector<PacketRow> recentPackets;
+
+	const FlowRow* FindFlow(uint64_t flowId) const;
+
+private:
+	friend class PacketViewModel;
+	std::unordered_map<uint64_t, std::pair<bool, size_t>> flowIndex; // flow ID -> (incoming, row index)
+};
+
+// Background thread that groups, filters, sorts and formats packets for the packet list.
+// The UI thread only picks up the latest snapshot, so its cost does not grow with the history.
+class PacketViewModel
+{
+public:
+	enum class FlowSort
+	{
+		Address,
+		PacketCount,
+		Rtt, // Slowest average ACK RTT first
+		Retransmissions
+	};
+
+	explicit PacketViewModel(std::shared_ptr<CaptureEngine> engine);
+	~PacketViewModel();
+
+	void Start();
+	void Stop();
+
+	// Settings are picked up on the next rebuild
+	void SetRefreshRate(int hz);
+	int GetRefreshRate() const { return refreshRateHz.load(); }
+	void SetFilter(const std::string& text);
+	void SetFlowSort(FlowSort sort);
+
+	std::shared_ptr<const PacketViewSnapshot> GetSnapshot() const;
+
+	// Row formatting shared with other packet lists, such as search results
+	static PacketRow MakePacketRow(const PacketInfo& pkt);
+
+private:
+	std::shared_ptr<CaptureEngine> captureEngine;
+
+	std::thread worker;
+	std::atomic<bool> running{ false };
+	std::mutex wakeMutex;
+	std::condition_variable wakeCondition;
+
+	std::atomic<int> refreshRateHz{ 10 };
+	std::atomic<FlowSort> flowSort{ FlowSort::Address };
+	mutable std::mutex settingsMutex;
+	std::string filter;
+
+	mutable std::mutex snapshotMutex;
+	std::shared_ptr<const PacketViewSnapshot> snapshot;
+
+	void WorkerLoop();
+	std::shared_ptr<const PacketViewSnapshot> BuildSnapshot();
+};
@@ -0,0 +1,123 @@
+#include "AlertsPanel.h"
+#include <imgui.h>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+
+namespace
+{
+	constexpr double refreshIntervalSeconds = 0.5;
+	constexpr int64_t recentAlertUs = 30'000'000; // The header is highlighted this long after an alert
+}
+
+AlertsPanel::AlertsPanel(std::shared_ptr<CaptureEngine> engine)
+	: captureEngine(std::move(engine))
+{
+}
+
+void AlertsPanel::Render()
+{
+	AttackDetector& detector = captureEngine->GetAttackDetector();
+	if (ImGui::GetTime() - lastRefresh >= refreshIntervalSeconds || lastRefresh < 0.0)
+	{
+		alerts = detector.GetRecentAlerts();
+		lastRefresh = ImGui::GetTime();
+	}
+
+	// The header turns red while an alert is recent, so it is noticed with the section closed
+	const int64_t nowUs = std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::system_clock::now().time_since_epoch()).count();
+	const int64_t lastAlertUs = detector.GetLastAlertUs();
+	const bool recent = lastAlertUs != 0 && nowUs - lastAlertUs < recentAlertUs;
+
+	char header[64];
+	std::snprintf(header, sizeof(header), "Scan and Flood Alerts (%zu)###AttackAlerts", alerts.size());
+	if (recent) ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.0f, 0.35f, 0.35f, 1.0f));
+	const bool open = ImGui::CollapsingHeader(header);
+	if (recent) ImGui::PopStyleColor();
+	if (!open)
+	{
+		return;
+	}
+
+	RenderSettings();
+	RenderAlerts();
+}
+
+void AlertsPanel::RenderSettings()
+{
+	AttackDetector& detector = captureEngine->GetAttackDetector();
+
+	for (size_t i = 0; i < AttackDetector::kindCount; ++i)
+	{
+		const auto kind = static_cast<AttackAlert::Kind>(i);
+		if (i != 0) ImGui::SameLine();
+		ImGui::Text("%s: %llu", AttackDetector::KindName(kind), static_cast<unsigned long long>(detector.GetAlertCount(kind)));
+	}
+	ImGui::SameLine();
+	if (ImGui::Button("Clear##AttackAlerts"))
+	{
+		detector.ClearAlerts();
+		alerts.clear();
+	}
+	ImGui::SameLine();
+	ImGui::TextDisabled("(?)");
+	if (ImGui::IsItemHovered())
+	{
+		ImGui::SetTooltip("Connection attempts (SYN without ACK) are counted over tumbling windows.\n"
+			"A horizontal scan is one source trying the threshold number of hosts on one port, a vertical scan one\n"
+			"source trying that many ports on one host. A SYN flood is a service getting the threshold number of SYNs\n"
+			"with fewer SYN-ACKs answered than the given share. Each key alerts at most once per window.");
+	}
+
+	// Settings are atomics in the detector, the capture thread picks them up on the next packet
+	int window = static_cast<int>(detector.GetWindowSeconds());
+	int scanTargets = static_cast<int>(detector.GetScanThreshold());
+	int floodSyns = static_cast<int>(detector.GetSynFloodThreshold());
+	int answered = static_cast<int>(detector.GetSynFloodAnsweredPercent());
+	ImGui::PushItemWidth(120.0f);
+	if (ImGui::SliderInt("Window (s)", &window, 1, 60)) detector.SetWindowSeconds(static_cast<uint32_t>(window));
+	ImGui::SameLine();
+	if (ImGui::SliderInt("Scan targets", &scanTargets, 10, 500)) detector.SetScanThreshold(static_cast<uint32_t>(scanTargets));
+	ImGui::SameLine();
+	if (ImGui::SliderInt("Flood SYNs", &floodSyns, 100, 100000, "%d", ImGuiSliderFlags_Logarithmic)) detector.SetSynFloodThreshold(static_cast<uint32_t>(floodSyns));
+	ImGui::SameLine();
+	if (ImGui::SliderInt("Answered below %", &answered, 1, 100)) detector.SetSynFloodAnsweredPercent(static_cast<uint32_t>(answered));
+	ImGui::PopItemWidth();
+}
+
+void AlertsPanel::RenderAlerts()
+{
+	if (!ImGui::BeginTable("AttackAlerts", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY, ImVec2(0, 160.0f)))
+	{
+		return;
+	}
+
+	ImGui::TableSetupScrollFreeze(0, 1);
+	ImGui::TableSetupColumn("Time", ImGuiTableColumnFlags_WidthFixed, 70.0f);
+	ImGui::TableSetupColumn("Kind", ImGuiTableColumnFlags_WidthFixed, 110.0f);
+	ImGui::TableSetupColumn("Details", ImGuiTableColumnFlags_WidthStretch);
+	ImGui::TableHeadersRow();
+
+	for (const AttackAlert& alert : alerts)
+	{
+		const std::time_t seconds = static_cast<std::time_t>(alert.timestampUs / 1000000);
+		std::tm tmBuf{};
+#ifdef _WIN32
+		localtime_s(&tmBuf, &seconds);
+#else
+		localtime_r(&seconds, &tmBuf);
+#endif
+		char time[16];
+		std::strftime(time, sizeof(time), "%H:%M:%S", &tmBuf);
+
+		ImGui::TableNextRow();
+		ImGui::TableNextColumn();
+		ImGui::TextUnformatted(time);
+		ImGui::TableNextColumn();
+		ImGui::TextUnformatted(AttackDetector::KindName(alert.kind));
+		ImGui::TableNextColumn();
+		ImGui::TextUnformatted(alert.text.c_str());
+	}
+	ImGui::EndTable();
+}
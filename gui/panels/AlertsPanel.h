@@ -0,0 +1,22 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include "core/CaptureEngine.h"
+
+class AlertsPanel
+{
+public:
+	explicit AlertsPanel(std::shared_ptr<CaptureEngine> engine);
+
+	void Render();
+
+private:
+	std::shared_ptr<CaptureEngine> captureEngine;
+
+	// Copied from the detector a few times a second rather than every frame
+	std::vector<AttackAlert> alerts;
+	double lastRefresh = -1.0;
+
+	void RenderSettings();
+	void RenderAlerts();
+};
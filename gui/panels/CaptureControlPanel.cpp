@@ -1,5 +1,8 @@
 #include "CaptureControlPanel.h"
+#include "core/PacketParser.h"
 #include <imgui.h>
+#include <algorithm>
+#include <chrono>
 
 CaptureControlPanel::CaptureControlPanel(std::shared_ptr<CaptureEngine> engine)
 	: captureEngine(std::move(engine)), selectedDevice(-1), initialized(false)
@@ -199,6 +202,13 @@ void CaptureControlPanel::Render()
 		ImGui::TextUnformatted("Statistics:");
 		ImGui::Indent();
 		ImGui::Text("Total Packets Captured: %zu", captureEngine->GetTotalPacketCount());
+
+		// Rates over the last complete second
+		const int64_t now = std::chrono::duration_cast<std::chrono::seconds>(
+			std::chrono::system_clock::now().time_since_epoch()).count();
+		const TrafficStats& stats = captureEngine->GetTrafficStats();
+		ImGui::Text("Packets/s: %.0f", stats.GetRate(TrafficStats::Resolution::OneSecond, TrafficStats::Metric::PacketsPerSecond, now));
+		ImGui::Text("Throughput: %.2f Mbit/s", stats.GetRate(TrafficStats::Resolution::OneSecond, TrafficStats::Metric::BitsPerSecond, now) / 1e6f);
 		ImGui::Unindent();
 
 		ImGui::Spacing();
@@ -252,5 +262,159 @@ void CaptureControlPanel::Render()
 	}
 
 	ImGui::EndChild();
+
+	RenderLocalNetworks();
+	RenderDissectionOptions();
 }
 
+// Prefixes used to decide whether a packet is incoming or outgoing
+void CaptureControlPanel::RenderLocalNetworks()
+{
+	if (!ImGui::CollapsingHeader("Local Networks"))
+	{
+		return;
+	}
+
+	ImGui::TextWrapped("Packets from outside these prefixes to inside them are classified as incoming. "
+		"They are filled from the interface addresses when capture starts.");
+
+	LocalNetworks networks = captureEngine->GetLocalNetworks();
+	bool changed = false;
+
+	for (const auto& prefix : networks.GetPrefixes())
+	{
+		const std::string text = LocalNetworks::FormatPrefix(prefix);
+		ImGui::PushID(text.c_str());
+		if (ImGui::Button("Remove"))
+		{
+			networks.RemovePrefix(prefix);
+			changed = true;
+		}
+		ImGui::SameLine();
+		ImGui::TextUnformatted(text.c_str());
+		ImGui::PopID();
+	}
+
+	ImGui::PushItemWidth(200.0f);
+	ImGui::InputText("##Prefix", prefixInput, IM_ARRAYSIZE(prefixInput));
+	ImGui::PopItemWidth();
+	ImGui::SameLine();
+	if (ImGui::Button("Add Prefix"))
+	{
+		prefixInputInvalid = !networks.AddPrefix(std::string(prefixInput));
+		if (!prefixInputInvalid)
+		{
+			prefixInput[0] = '\0';
+			changed = true;
+		}
+	}
+	ImGui::SameLine();
+	if (ImGui::Button("Reset to Interface"))
+	{
+		captureEngine->ResetLocalNetworks();
+	}
+
+	if (prefixInputInvalid)
+	{
+		ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.0f, 0.6f, 0.0f, 1.0f));
+		ImGui::TextUnformatted("Invalid prefix, expected e.g. 10.0.0.0/8");
+		ImGui::PopStyleColor();
+	}
+
+	if (changed)
+	{
+		captureEngine->SetLocalNetworks(networks);
+	}
+}
+
+void CaptureControlPanel::RenderDissectionOptions()
+{
+	if (!ImGui::CollapsingHeader("Dissection Options"))
+	{
+		return;
+	}
+
+	// VLAN tags and MPLS labels are always stripped, tunnels are optional
+	bool decodeTunnels = captureEngine->GetDecodeTunnels();
+	if (ImGui::Checkbox("Decode GRE / VXLAN tunnels", &decodeTunnels))
+	{
+		captureEngine->SetDecodeTunnels(decodeTunnels);
+	}
+	ImGui::SameLine();
+	ImGui::TextDisabled("(?)");
+	if (ImGui::IsItemHovered())
+	{
+		ImGui::SetTooltip("If enabled, tunnelled packets are shown and grouped by their inner addresses.");
+	}
+
+	bool reassembleIp = captureEngine->GetReassembleIp();
+	if (ImGui::Checkbox("Reassemble IPv4 fragments", &reassembleIp))
+	{
+		captureEngine->SetReassembleIp(reassembleIp);
+	}
+	ImGui::SameLine();
+	ImGui::TextDisabled("(?)");
+	if (ImGui::IsItemHovered())
+	{
+		ImGui::SetTooltip("The fragment completing a datagram is shown as the whole datagram, with ports.\n"
+			"Datagrams with conflicting overlapping fragments are discarded.");
+	}
+	const IpDefragmenterStats defragStats = captureEngine->GetDefragmenterStats();
+	ImGui::Text("Fragments: %llu seen, %llu datagrams rebuilt, %zu pending (%.1f KB), %llu timed out, %llu overlaps, %llu dropped",
+		static_cast<unsigned long long>(defragStats.fragments), static_cast<unsigned long long>(defragStats.reassembled),
+		defragStats.pendingDatagrams, defragStats.bufferedBytes / 1024.0, static_cast<unsigned long long>(defragStats.timeouts),
+		static_cast<unsigned long long>(defragStats.overlaps), static_cast<unsigned long long>(defragStats.dropped));
+
+	bool reassembleTcp = captureEngine->GetReassembleTcp();
+	if (ImGui::Checkbox("Reassemble TCP streams", &reassembleTcp))
+	{
+		captureEngine->SetReassembleTcp(reassembleTcp);
+	}
+	const TcpReassemblyStats stats = captureEngine->GetTcpReassembler().GetStats();
+	ImGui::Text("Streams: %zu open, %.1f KB buffered, %llu gaps, %llu segments dropped", stats.connections,
+		stats.bufferedBytes / 1024.0, static_cast<unsigned long long>(stats.gaps), static_cast<unsigned long long>(stats.droppedSegments));
+	const TlsTracker& tlsTracker = captureEngine->GetTlsTracker();
+	ImGui::Text("TLS hellos: %llu, %llu spanning several segments", static_cast<unsigned long long>(tlsTracker.GetHelloCount()),
+		static_cast<unsigned long long>(tlsTracker.GetSplitHelloCount()));
+	ImGui::SameLine();
+	ImGui::TextDisabled("(?)");
+	if (ImGui::IsItemHovered())
+	{
+		ImGui::SetTooltip("Server names and ALPN are read from the reassembled streams and shown in the flow tables.\n"
+			"They are only extracted while TCP stream reassembly is on.");
+	}
+
+	const QuicTracker& quicTracker = captureEngine->GetQuicTracker();
+	ImGui::Text("QUIC: %llu connections, %zu connection IDs tracked", static_cast<unsigned long long>(quicTracker.GetConnectionCount()),
+		quicTracker.GetConnectionIdCount());
+	ImGui::SameLine();
+	ImGui::TextDisabled("(?)");
+	if (ImGui::IsItemHovered())
+	{
+		ImGui::SetTooltip("QUIC packets on UDP 443 and 8443 are grouped into flows by connection ID, so a connection\n"
+			"stays one flow across NAT rebinding. IDs are learnt from long headers. Packet payloads,\n"
+			"including the server name in the Initial packet, are not decrypted.");
+	}
+
+	// Applies to packets captured from now on
+	int storedBytes = static_cast<int>(captureEngine->GetStoredBytesLimit());
+	ImGui::PushItemWidth(120.0f);
+	if (ImGui::InputInt("Stored bytes per packet", &storedBytes, 64, 512))
+	{
+		captureEngine->SetStoredBytesLimit(static_cast<uint32_t>(std::max(storedBytes, 0)));
+	}
+	ImGui::PopItemWidth();
+	ImGui::SameLine();
+	ImGui::TextDisabled("(?)");
+	if (ImGui::IsItemHovered())
+	{
+		ImGui::SetTooltip("Bytes kept from each frame for the hex dump and the detail view. Larger values use more memory.");
+	}
+
+	ImGui::TextUnformatted("Registered dissectors:");
+	const auto& dissectors = PacketParser::GetDissectors().GetDissectors();
+	for (size_t i = 1; i < dissectors.size(); ++i)
+	{
+		ImGui::BulletText("%s", dissectors[i].name);
+	}
+}
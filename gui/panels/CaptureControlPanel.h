@@ -17,4 +17,9 @@ private:
 	int selectedDevice;
 	std::vector<std::string> devices;
 	bool initialized;
+	char prefixInput[64] = "";
+	bool prefixInputInvalid = false;
+
+	void RenderLocalNetworks();
+	void RenderDissectionOptions();
 };
\ No newline at end of file
@@ -0,0 +1,133 @@
+#include "DiagnosticsPanel.h"
+#include <imgui.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+
+namespace
+{
+	constexpr double refreshIntervalSeconds = 0.5;
+}
+
+DiagnosticsPanel::DiagnosticsPanel(std::shared_ptr<CaptureEngine> engine)
+	: captureEngine(std::move(engine))
+{
+}
+
+void DiagnosticsPanel::Render()
+{
+	if (!ImGui::CollapsingHeader("ARP and ICMP", ImGuiTreeNodeFlags_DefaultOpen))
+	{
+		return;
+	}
+
+	NetworkDiagnostics& diagnostics = captureEngine->GetNetworkDiagnostics();
+	if (ImGui::GetTime() - lastRefresh >= refreshIntervalSeconds || lastRefresh < 0.0)
+	{
+		events = diagnostics.GetRecentEvents();
+		lastRefresh = ImGui::GetTime();
+	}
+
+	ImGui::Text("ARP table: %zu addresses", diagnostics.GetArpTableSize());
+	ImGui::SameLine();
+	ImGui::TextDisabled("(?)");
+	if (ImGui::IsItemHovered())
+	{
+		ImGui::SetTooltip("Counted as packets are captured, rates are per second over the last minute.\n"
+			"A conflict is an address answered for by a different MAC than the last one seen for it within 10 minutes.\n"
+			"An event is raised for each second in which ARP traffic or unreachables reach their threshold.");
+	}
+
+	// Thresholds are read by the capture thread when a second completes
+	int arpThreshold = static_cast<int>(diagnostics.GetArpStormThreshold());
+	int unreachableThreshold = static_cast<int>(diagnostics.GetUnreachableFloodThreshold());
+	ImGui::PushItemWidth(160.0f);
+	if (ImGui::SliderInt("ARP storm pkt/s", &arpThreshold, 10, 5000, "%d", ImGuiSliderFlags_Logarithmic))
+	{
+		diagnostics.SetArpStormThreshold(static_cast<uint32_t>(arpThreshold));
+	}
+	ImGui::SameLine();
+	if (ImGui::SliderInt("Unreachable flood pkt/s", &unreachableThreshold, 10, 5000, "%d", ImGuiSliderFlags_Logarithmic))
+	{
+		diagnostics.SetUnreachableFloodThreshold(static_cast<uint32_t>(unreachableThreshold));
+	}
+	ImGui::PopItemWidth();
+
+	const int64_t now = std::chrono::duration_cast<std::chrono::seconds>(
+		std::chrono::system_clock::now().time_since_epoch()).count();
+	RenderCounters(now);
+	RenderEvents();
+}
+
+void DiagnosticsPanel::RenderCounters(int64_t now)
+{
+	const NetworkDiagnostics& diagnostics = captureEngine->GetNetworkDiagnostics();
+	if (!ImGui::BeginTable("DiagnosticsCounters", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+	{
+		return;
+	}
+
+	ImGui::TableSetupColumn("Counter", ImGuiTableColumnFlags_WidthFixed, 120.0f);
+	ImGui::TableSetupColumn("Total", ImGuiTableColumnFlags_WidthFixed, 80.0f);
+	ImGui::TableSetupColumn("Per second", ImGuiTableColumnFlags_WidthFixed, 80.0f);
+	ImGui::TableSetupColumn("Peak", ImGuiTableColumnFlags_WidthFixed, 60.0f);
+	ImGui::TableSetupColumn("Last minute", ImGuiTableColumnFlags_WidthStretch);
+	ImGui::TableHeadersRow();
+
+	for (size_t i = 0; i < NetworkDiagnostics::counterCount; ++i)
+	{
+		const auto counter = static_cast<NetworkDiagnostics::Counter>(i);
+		diagnostics.GetSeries(counter, now, series);
+		const float peak = *std::max_element(series.begin(), series.end());
+
+		ImGui::TableNextRow();
+		ImGui::TableNextColumn();
+		ImGui::TextUnformatted(NetworkDiagnostics::CounterName(counter));
+		ImGui::TableNextColumn();
+		ImGui::Text("%llu", static_cast<unsigned long long>(diagnostics.GetTotal(counter)));
+		ImGui::TableNextColumn();
+		ImGui::Text("%.0f", diagnostics.GetRate(counter, now));
+		ImGui::TableNextColumn();
+		ImGui::Text("%.0f", diagnostics.GetPeakRate(counter));
+		ImGui::TableNextColumn();
+		ImGui::PushID(static_cast<int>(i));
+		ImGui::PlotLines("##Series", series.data(), static_cast<int>(series.size()), 0, nullptr, 0.0f, std::max(peak * 1.1f, 1.0f), ImVec2(-1.0f, 18.0f));
+		ImGui::PopID();
+	}
+	ImGui::EndTable();
+}
+
+void DiagnosticsPanel::RenderEvents()
+{
+	ImGui::Text("Events (%zu)", events.size());
+	if (!ImGui::BeginTable("DiagnosticsEvents", 2, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY, ImVec2(0, 150.0f)))
+	{
+		return;
+	}
+
+	ImGui::TableSetupScrollFreeze(0, 1);
+	ImGui::TableSetupColumn("Time", ImGuiTableColumnFlags_WidthFixed, 70.0f);
+	ImGui::TableSetupColumn("Event", ImGuiTableColumnFlags_WidthStretch);
+	ImGui::TableHeadersRow();
+
+	for (const NetworkDiagnostics::Event& event : events)
+	{
+		const std::time_t seconds = static_cast<std::time_t>(event.timestampUs / 1000000);
+		std::tm tmBuf{};
+#ifdef _WIN32
+		localtime_s(&tmBuf, &seconds);
+#else
+		localtime_r(&seconds, &tmBuf);
+#endif
+		char time[16];
+		std::strftime(time, sizeof(time), "%H:%M:%S", &tmBuf);
+
+		ImGui::TableNextRow();
+		ImGui::TableNextColumn();
+		ImGui::TextUnformatted(time);
+		ImGui::TableNextColumn();
+		ImGui::TextUnformatted(event.text.c_str());
+	}
+	ImGui::EndTable();
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include "core/CaptureEngine.h"
+
+class DiagnosticsPanel
+{
+public:
+	explicit DiagnosticsPanel(std::shared_ptr<CaptureEngine> engine);
+
+	void Render();
+
+private:
+	std::shared_ptr<CaptureEngine> captureEngine;
+	std::vector<float> series;
+
+	// Copied a few times a second rather than every frame
+	std::vector<NetworkDiagnostics::Event> events;
+	double lastRefresh = -1.0;
+
+	void RenderCounters(int64_t now);
+	void RenderEvents();
+};
@@ -0,0 +1,162 @@
+#include "DnsStatsPanel.h"
+#include <imgui.h>
+#include <algorithm>
+
+namespace
+{
+	constexpr double refreshIntervalSeconds = 0.5;
+
+	// Columns shared by the server and name tables, after the key column
+	void SetupCounterColumns()
+	{
+		ImGui::TableSetupColumn("Queries", ImGuiTableColumnFlags_WidthFixed, 70.0f);
+		ImGui::TableSetupColumn("Answered", ImGuiTableColumnFlags_WidthFixed, 70.0f);
+		ImGui::TableSetupColumn("NXDOMAIN", ImGuiTableColumnFlags_WidthFixed, 75.0f);
+		ImGui::TableSetupColumn("SERVFAIL", ImGuiTableColumnFlags_WidthFixed, 70.0f);
+		ImGui::TableSetupColumn("Avg (ms)", ImGuiTableColumnFlags_WidthFixed, 70.0f);
+		ImGui::TableSetupColumn("p95 (ms)", ImGuiTableColumnFlags_WidthFixed, 70.0f);
+		ImGui::TableSetupColumn("Max (ms)", ImGuiTableColumnFlags_WidthFixed, 70.0f);
+	}
+
+	void RenderCounterColumns(const DnsCounters& counters)
+	{
+		ImGui::TableNextColumn();
+		ImGui::Text("%llu", static_cast<unsigned long long>(counters.queries));
+		ImGui::TableNextColumn();
+		ImGui::Text("%llu", static_cast<unsigned long long>(counters.responses));
+		ImGui::TableNextColumn();
+		ImGui::Text("%llu", static_cast<unsigned long long>(counters.nxdomain));
+		ImGui::TableNextColumn();
+		ImGui::Text("%llu", static_cast<unsigned long long>(counters.servfail));
+
+		const LatencyHistogram& latency = counters.latency;
+		ImGui::TableNextColumn();
+		if (latency.samples != 0) ImGui::Text("%.2f", latency.AverageMs());
+		ImGui::TableNextColumn();
+		if (latency.samples != 0) ImGui::Text("%.2f", latency.PercentileMs(0.95));
+		ImGui::TableNextColumn();
+		if (latency.samples != 0) ImGui::Text("%.2f", latency.maxUs / 1000.0);
+	}
+}
+
+DnsStatsPanel::DnsStatsPanel(std::shared_ptr<CaptureEngine> engine)
+	: captureEngine(std::move(engine))
+{
+}
+
+void DnsStatsPanel::Render()
+{
+	if (!ImGui::CollapsingHeader("DNS", ImGuiTreeNodeFlags_DefaultOpen))
+	{
+		return;
+	}
+
+	if (ImGui::GetTime() - lastRefresh >= refreshIntervalSeconds || lastRefresh < 0.0)
+	{
+		Refresh();
+	}
+
+	ImGui::Text("Queries: %llu, answered: %llu, timed out: %llu, waiting: %zu", static_cast<unsigned long long>(totals.queries),
+		static_cast<unsigned long long>(totals.responses), static_cast<unsigned long long>(totals.timeouts), pendingQueries);
+	ImGui::Text("NXDOMAIN: %llu, SERVFAIL: %llu, latency avg %.2f ms, p95 %.2f ms", static_cast<unsigned long long>(totals.nxdomain),
+		static_cast<unsigned long long>(totals.servfail), totals.latency.AverageMs(), totals.latency.PercentileMs(0.95));
+	ImGui::SameLine();
+	if (ImGui::Button("Reset##Dns"))
+	{
+		captureEngine->GetDnsTracker().Clear();
+		Refresh();
+	}
+	ImGui::SameLine();
+	ImGui::TextDisabled("(?)");
+	if (ImGui::IsItemHovered())
+	{
+		ImGui::SetTooltip("Queries are matched to responses by transaction ID and addresses and ports.\n"
+			"A query without a response within 5 seconds counts as timed out.");
+	}
+
+	RenderServers();
+	RenderNames();
+}
+
+void DnsStatsPanel::Refresh()
+{
+	const DnsTracker& tracker = captureEngine->GetDnsTracker();
+	servers = tracker.GetServerStats();
+	names = tracker.GetNameStats();
+	totals = tracker.GetTotals();
+	pendingQueries = tracker.GetPendingCount();
+	lastRefresh = ImGui::GetTime();
+
+	std::sort(servers.begin(), servers.end(), [](const DnsServerStats& a, const DnsServerStats& b)
+	{
+		return a.counters.queries > b.counters.queries;
+	});
+
+	auto key = [this](const DnsNameStats& stats) -> double
+	{
+		switch (nameSort)
+		{
+			case 1: return stats.counters.latency.AverageMs();
+			case 2: return static_cast<double>(stats.counters.nxdomain + stats.counters.servfail);
+			default: return static_cast<double>(stats.counters.queries);
+		}
+	};
+	std::sort(names.begin(), names.end(), [&key](const DnsNameStats& a, const DnsNameStats& b) { return key(a) > key(b); });
+}
+
+void DnsStatsPanel::RenderServers()
+{
+	ImGui::SeparatorText("Servers");
+	if (ImGui::BeginTable("DnsServers", 9, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY, ImVec2(0, 200.0f)))
+	{
+		ImGui::TableSetupScrollFreeze(0, 1);
+		ImGui::TableSetupColumn("Server", ImGuiTableColumnFlags_WidthStretch);
+		SetupCounterColumns();
+		ImGui::TableSetupColumn("Timeouts", ImGuiTableColumnFlags_WidthFixed, 70.0f);
+		ImGui::TableHeadersRow();
+
+		for (const DnsServerStats& server : servers)
+		{
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn();
+			ImGui::TextUnformatted(server.server.ToString().c_str());
+			RenderCounterColumns(server.counters);
+			ImGui::TableNextColumn();
+			ImGui::Text("%llu", static_cast<unsigned long long>(server.counters.timeouts));
+		}
+		ImGui::EndTable();
+	}
+}
+
+void DnsStatsPanel::RenderNames()
+{
+	ImGui::SeparatorText("Names");
+
+	static const char* sortNames[] = { "Queries", "Average latency", "Failures" };
+	ImGui::PushItemWidth(160.0f);
+	if (ImGui::Combo("Sort by##DnsNames", &nameSort, sortNames, IM_ARRAYSIZE(sortNames)))
+	{
+		Refresh();
+	}
+	ImGui::SameLine();
+	ImGui::SliderInt("Rows##DnsNames", &nameLimit, 10, 500);
+	ImGui::PopItemWidth();
+
+	if (ImGui::BeginTable("DnsNames", 8, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY, ImVec2(0, 300.0f)))
+	{
+		ImGui::TableSetupScrollFreeze(0, 1);
+		ImGui::TableSetupColumn("Name", ImGuiTableColumnFlags_WidthStretch);
+		SetupCounterColumns();
+		ImGui::TableHeadersRow();
+
+		const size_t rows = std::min(names.size(), static_cast<size_t>(std::max(nameLimit, 0)));
+		for (size_t i = 0; i < rows; ++i)
+		{
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn();
+			ImGui::TextUnformatted(names[i].name.c_str());
+			RenderCounterColumns(names[i].counters);
+		}
+		ImGui::EndTable();
+	}
+}
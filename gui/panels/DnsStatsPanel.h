@@ -0,0 +1,28 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include "core/CaptureEngine.h"
+
+class DnsStatsPanel
+{
+public:
+	explicit DnsStatsPanel(std::shared_ptr<CaptureEngine> engine);
+
+	void Render();
+
+private:
+	std::shared_ptr<CaptureEngine> captureEngine;
+
+	// Copied from the tracker a few times a second rather than every frame
+	std::vector<DnsServerStats> servers;
+	std::vector<DnsNameStats> names;
+	DnsCounters totals;
+	size_t pendingQueries = 0;
+	double lastRefresh = -1.0;
+	int nameSort = 0; // 0 = queries, 1 = average latency, 2 = failures
+	int nameLimit = 50;
+
+	void Refresh();
+	void RenderServers();
+	void RenderNames();
+};
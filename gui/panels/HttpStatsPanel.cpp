@@ -0,0 +1,132 @@
+#include "HttpStatsPanel.h"
+#include <imgui.h>
+#include <algorithm>
+
+namespace
+{
+	constexpr double refreshIntervalSeconds = 0.5;
+}
+
+HttpStatsPanel::HttpStatsPanel(std::shared_ptr<CaptureEngine> engine)
+	: captureEngine(std::move(engine))
+{
+}
+
+void HttpStatsPanel::Render()
+{
+	if (!ImGui::CollapsingHeader("HTTP", ImGuiTreeNodeFlags_DefaultOpen))
+	{
+		return;
+	}
+
+	if (ImGui::GetTime() - lastRefresh >= refreshIntervalSeconds || lastRefresh < 0.0)
+	{
+		Refresh();
+	}
+
+	ImGui::Text("Requests: %llu, responses: %llu, unmatched responses: %llu, open connections: %zu",
+		static_cast<unsigned long long>(totals.requests), static_cast<unsigned long long>(totals.responses),
+		static_cast<unsigned long long>(unmatchedResponses), connections);
+	ImGui::Text("Time to first byte avg %.2f ms, p95 %.2f ms; total time avg %.2f ms, p95 %.2f ms",
+		totals.firstByte.AverageMs(), totals.firstByte.PercentileMs(0.95), totals.total.AverageMs(), totals.total.PercentileMs(0.95));
+	ImGui::SameLine();
+	if (ImGui::Button("Reset##Http"))
+	{
+		captureEngine->GetHttpTracker().Clear();
+		Refresh();
+	}
+	ImGui::SameLine();
+	ImGui::TextDisabled("(?)");
+	if (ImGui::IsItemHovered())
+	{
+		ImGui::SetTooltip("Plain HTTP/1.x on any port, read from the reassembled TCP streams, so TCP reassembly must be on.\n"
+			"Each response is paired with the oldest unanswered request on its connection. Times run from the\n"
+			"first byte of the request to the first and last byte of the response. Query strings are dropped from paths.");
+	}
+
+	RenderEndpoints();
+}
+
+void HttpStatsPanel::Refresh()
+{
+	HttpTracker& tracker = captureEngine->GetHttpTracker();
+	endpoints = tracker.GetEndpointStats();
+	totals = tracker.GetTotals();
+	connections = tracker.GetConnectionCount();
+	unmatchedResponses = tracker.GetUnmatchedResponses();
+	lastRefresh = ImGui::GetTime();
+
+	auto key = [this](const HttpEndpointStats& stats) -> double
+	{
+		switch (endpointSort)
+		{
+			case 1: return stats.counters.firstByte.AverageMs();
+			case 2: return stats.counters.total.AverageMs();
+			case 3: return static_cast<double>(stats.counters.Errors());
+			default: return static_cast<double>(stats.counters.requests);
+		}
+	};
+	std::sort(endpoints.begin(), endpoints.end(), [&key](const HttpEndpointStats& a, const HttpEndpointStats& b) { return key(a) > key(b); });
+}
+
+void HttpStatsPanel::RenderEndpoints()
+{
+	static const char* sortNames[] = { "Requests", "Time to first byte", "Total time", "Errors" };
+	ImGui::PushItemWidth(160.0f);
+	if (ImGui::Combo("Sort by##HttpEndpoints", &endpointSort, sortNames, IM_ARRAYSIZE(sortNames)))
+	{
+		Refresh();
+	}
+	ImGui::SameLine();
+	ImGui::SliderInt("Rows##HttpEndpoints", &endpointLimit, 10, 500);
+	ImGui::PopItemWidth();
+
+	if (ImGui::BeginTable("HttpEndpoints", 12, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY, ImVec2(0, 300.0f)))
+	{
+		ImGui::TableSetupScrollFreeze(0, 1);
+		ImGui::TableSetupColumn("Host", ImGuiTableColumnFlags_WidthStretch);
+		ImGui::TableSetupColumn("Path", ImGuiTableColumnFlags_WidthStretch);
+		ImGui::TableSetupColumn("Requests", ImGuiTableColumnFlags_WidthFixed, 70.0f);
+		ImGui::TableSetupColumn("Responses", ImGuiTableColumnFlags_WidthFixed, 75.0f);
+		ImGui::TableSetupColumn("2xx", ImGuiTableColumnFlags_WidthFixed, 50.0f);
+		ImGui::TableSetupColumn("3xx", ImGuiTableColumnFlags_WidthFixed, 50.0f);
+		ImGui::TableSetupColumn("4xx", ImGuiTableColumnFlags_WidthFixed, 50.0f);
+		ImGui::TableSetupColumn("5xx", ImGuiTableColumnFlags_WidthFixed, 50.0f);
+		ImGui::TableSetupColumn("TTFB (ms)", ImGuiTableColumnFlags_WidthFixed, 75.0f);
+		ImGui::TableSetupColumn("TTFB p95", ImGuiTableColumnFlags_WidthFixed, 70.0f);
+		ImGui::TableSetupColumn("Total (ms)", ImGuiTableColumnFlags_WidthFixed, 75.0f);
+		ImGui::TableSetupColumn("Total p95", ImGuiTableColumnFlags_WidthFixed, 70.0f);
+		ImGui::TableHeadersRow();
+
+		const size_t rows = std::min(endpoints.size(), static_cast<size_t>(std::max(endpointLimit, 0)));
+		for (size_t i = 0; i < rows; ++i)
+		{
+			const HttpEndpointStats& endpoint = endpoints[i];
+			const HttpCounters& counters = endpoint.counters;
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn();
+			ImGui::TextUnformatted(endpoint.host.c_str());
+			ImGui::TableNextColumn();
+			ImGui::TextUnformatted(endpoint.path.c_str());
+			ImGui::TableNextColumn();
+			ImGui::Text("%llu", static_cast<unsigned long long>(counters.requests));
+			ImGui::TableNextColumn();
+			ImGui::Text("%llu", static_cast<unsigned long long>(counters.responses));
+			for (size_t statusClass = 1; statusClass < counters.statusClasses.size(); ++statusClass)
+			{
+				ImGui::TableNextColumn();
+				ImGui::Text("%llu", static_cast<unsigned long long>(counters.statusClasses[statusClass]));
+			}
+
+			ImGui::TableNextColumn();
+			if (counters.responses != 0) ImGui::Text("%.2f", counters.firstByte.AverageMs());
+			ImGui::TableNextColumn();
+			if (counters.responses != 0) ImGui::Text("%.2f", counters.firstByte.PercentileMs(0.95));
+			ImGui::TableNextColumn();
+			if (counters.responses != 0) ImGui::Text("%.2f", counters.total.AverageMs());
+			ImGui::TableNextColumn();
+			if (counters.responses != 0) ImGui::Text("%.2f", counters.total.PercentileMs(0.95));
+		}
+		ImGui::EndTable();
+	}
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include "core/CaptureEngine.h"
+
+class HttpStatsPanel
+{
+public:
+	explicit HttpStatsPanel(std::shared_ptr<CaptureEngine> engine);
+
+	void Render();
+
+private:
+	std::shared_ptr<CaptureEngine> captureEngine;
+
+	// Copied from the tracker a few times a second rather than every frame
+	std::vector<HttpEndpointStats> endpoints;
+	HttpCounters totals;
+	size_t connections = 0;
+	uint64_t unmatchedResponses = 0;
+	double lastRefresh = -1.0;
+	int endpointSort = 0; // 0 = requests, 1 = time to first byte, 2 = total time, 3 = errors
+	int endpointLimit = 50;
+
+	void Refresh();
+	void RenderEndpoints();
+};
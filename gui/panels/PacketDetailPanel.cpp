@@ -1,9 +1,44 @@
 #include "PacketDetailPanel.h"
 #include <imgui.h>
-#include <sstream>
-#include <iomanip>
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstring>
 
-PacketDetailPanel::PacketDetailPanel(std::function<std::optional<PacketInfo>()> selectedGetter)
+namespace
+{
+	// Two hex characters per byte value, so encoding is a single table lookup
+	constexpr std::array<char, 512> MakeHexTable()
+	{
+		constexpr char digits[] = "0123456789abcdef";
+		std::array<char, 512> table{};
+		for (size_t i = 0; i < 256; ++i)
+		{
+			table[i * 2] = digits[i >> 4];
+			table[i * 2 + 1] = digits[i & 0x0F];
+		}
+		return table;
+	}
+
+	constexpr std::array<char, 512> hexTable = MakeHexTable();
+
+	// Column layout of a formatted line: "00000000: " + "xx " per byte + " " + ASCII
+	constexpr size_t offsetColumns = 10;
+
+	ImVec4 LayerColor(int layer, float alpha)
+	{
+		switch (layer)
+		{
+			case 1: return ImVec4(0.30f, 0.55f, 0.95f, alpha); // Ethernet
+			case 2: return ImVec4(0.30f, 0.85f, 0.40f, alpha); // Network
+			case 3: return ImVec4(0.95f, 0.70f, 0.25f, alpha); // Transport
+			case 4: return ImVec4(0.75f, 0.40f, 0.90f, alpha); // Payload
+			default: return ImVec4(0.0f, 0.0f, 0.0f, 0.0f);
+		}
+	}
+}
+
+PacketDetailPanel::PacketDetailPanel(std::function<PacketRef()> selectedGetter)
 	: getSelectedPacket(std::move(selectedGetter))
 {
 }
@@ -12,14 +47,15 @@ void PacketDetailPanel::Render()
 {
 	ImGui::SeparatorText("Packet Details");
 
-	auto opt = getSelectedPacket();
-	if (!opt.has_value())
+	// Shared reference into the capture history, no copy is made
+	const PacketRef selected = getSelectedPacket();
+	if (!selected)
 	{
 		ImGui::TextUnformatted("Select a packet (n the list or flow) to view details.");
 		return;
 	}
 
-	const PacketInfo& pkt = *opt;
+	const PacketInfo& pkt = *selected;
 
 	ImGui::BeginChild("PacketDetailChild", ImVec2(0, 300), true, ImGuiWindowFlags_HorizontalScrollbar);
 
@@ -29,33 +65,29 @@ void PacketDetailPanel::Render()
 	ImGui::Separator();
 	ImGui::Spacing();
 
-	// Collapsible structured layers
-	if (ImGui::CollapsingHeader("Ethernet Layer", ImGuiTreeNodeFlags_DefaultOpen))
-	{
-		ImGui::BulletText("Source MAC: %s", pkt.etherSrc.c_str());
-		ImGui::BulletText("Destination MAC: %s", pkt.etherDst.c_str());
-		ImGui::BulletText("EtherType: %s", pkt.etherTypeStr.c_str());
-	}
-
-	if (ImGui::CollapsingHeader("IPv4 Layer", ImGuiTreeNodeFlags_DefaultOpen))
+	// Collapsible field tree, hovering a layer or field highlights its bytes in the hex dump
+	hoveredOffset = 0;
+	hoveredLength = 0;
+	for (size_t i = 0; i < pkt.extraFields.size(); ++i)
 	{
-		ImGui::BulletText("Source IP: %s", pkt.srcIP.c_str());
-		ImGui::BulletText("Destination IP: %s", pkt.dstIP.c_str());
-		ImGui::BulletText("TTL: %u", pkt.ttl);
-		ImGui::BulletText("Protocol: %s", pkt.transportProtocol.c_str());
-	}
-
-	if (ImGui::CollapsingHeader("Transport Layer", ImGuiTreeNodeFlags_DefaultOpen))
-	{
-		ImGui::BulletText("Transport Protocol: %s", pkt.transportProtocol.c_str());
-		ImGui::BulletText("Source Port: %u", pkt.srcPort);
-		ImGui::BulletText("Destination Port: %u", pkt.dstPort);
-		ImGui::BulletText("Direction: %s", pkt.incoming ? "Incoming" : "Outgoing");
+		const PacketField& layer = pkt.extraFields[i];
+		ImGui::PushID(static_cast<int>(i));
+		const std::string label = layer.value.empty() ? layer.name : layer.name + ": " + layer.value;
+		const bool open = ImGui::CollapsingHeader(label.c_str(), ImGuiTreeNodeFlags_DefaultOpen);
+		TrackHover(layer);
+		if (open)
+		{
+			for (const PacketField& field : layer.children)
+			{
+				RenderField(field);
+			}
+		}
+		ImGui::PopID();
 	}
 
 	if (ImGui::CollapsingHeader("Raw Data (Hex / ASCII Dump)", ImGuiTreeNodeFlags_DefaultOpen))
 	{
-		RenderHexDump(pkt);
+		RenderHexDump(selected);
 	}
 
 	ImGui::EndChild();
@@ -68,8 +100,8 @@ void PacketDetailPanel::RenderHeaderInfo(const PacketInfo& pkt)
 	ImGui::Spacing();
 
 	ImGui::TextUnformatted("Addresses:");
-	ImGui::BulletText("Source: %s:%u", pkt.srcIP.c_str(), pkt.srcPort);
-	ImGui::BulletText("Destination: %s:%u", pkt.dstIP.c_str(), pkt.dstPort);
+	ImGui::BulletText("Source: %s:%u", pkt.GetSrcAddressString().c_str(), pkt.layers.srcPort);
+	ImGui::BulletText("Destination: %s:%u", pkt.GetDstAddressString().c_str(), pkt.layers.dstPort);
 
 	ImGui::Spacing();
 	ImGui::TextUnformatted("Notes:");
@@ -77,54 +109,169 @@ void PacketDetailPanel::RenderHeaderInfo(const PacketInfo& pkt)
 	ImGui::Spacing();
 }
 
-void PacketDetailPanel::RenderHexDump(const PacketInfo& pkt, size_t bytesPerLine)
+void PacketDetailPanel::RenderField(const PacketField& field)
+{
+	const std::string label = field.name + ": " + field.value;
+	ImGui::PushID(&field);
+	if (field.children.empty())
+	{
+		ImGui::TreeNodeEx(label.c_str(), ImGuiTreeNodeFlags_Leaf | ImGuiTreeNodeFlags_NoTreePushOnOpen | ImGuiTreeNodeFlags_Bullet);
+		TrackHover(field);
+	}
+	else
+	{
+		const bool open = ImGui::TreeNodeEx(label.c_str());
+		TrackHover(field);
+		if (open)
+		{
+			for (const PacketField& child : field.children)
+			{
+				RenderField(child);
+			}
+			ImGui::TreePop();
+		}
+	}
+	ImGui::PopID();
+}
+
+void PacketDetailPanel::TrackHover(const PacketField& field)
+{
+	if (ImGui::IsItemHovered())
+	{
+		hoveredOffset = field.offset;
+		hoveredLength = field.length;
+	}
+}
+
+// Format the whole packet into fixed-width lines, only done when the selection changes
+void PacketDetailPanel::BuildHexDump(const PacketInfo& pkt, size_t bytesPerLine)
 {
 	const auto& buf = pkt.data;
-	size_t size = buf.size();
+	const size_t size = buf.size();
+	const size_t lineCount = (size + bytesPerLine - 1) / bytesPerLine;
+
+	hexCache.bytesPerLine = bytesPerLine;
+	hexCache.lineWidth = offsetColumns + bytesPerLine * 3 + 1 + bytesPerLine;
+	hexCache.text.assign(lineCount * hexCache.lineWidth, ' ');
+
+	for (size_t line = 0; line < lineCount; ++line)
+	{
+		char* out = hexCache.text.data() + line * hexCache.lineWidth;
+		const size_t offset = line * bytesPerLine;
+
+		// Offset column
+		char offsetBuf[16];
+		std::snprintf(offsetBuf, sizeof(offsetBuf), "%08zx: ", offset);
+		std::memcpy(out, offsetBuf, offsetColumns);
+
+		char* hex = out + offsetColumns;
+		char* ascii = hex + bytesPerLine * 3 + 1;
+		const size_t count = std::min(bytesPerLine, size - offset);
+		for (size_t j = 0; j < count; ++j)
+		{
+			const uint8_t byte = buf[offset + j];
+			hex[j * 3] = hexTable[byte * 2];
+			hex[j * 3 + 1] = hexTable[byte * 2 + 1];
+			ascii[j] = std::isprint(byte) ? static_cast<char>(byte) : '.';
+		}
+	}
+
+	// Tag each byte with the layer it belongs to
+	hexCache.byteLayers.assign(size, Layer::None);
+	const size_t bounds[] = { 0, pkt.layers.networkOffset, pkt.layers.transportOffset, pkt.layers.payloadOffset, size };
+	const Layer layers[] = { Layer::Ethernet, Layer::Network, Layer::Transport, Layer::Payload };
+	for (size_t i = 0; i < 4; ++i)
+	{
+		const size_t start = bounds[i];
+		if (i > 0 && start == 0) continue; // Layer not parsed
+
+		// A layer ends where the next parsed one starts
+		size_t end = size;
+		for (size_t k = i + 1; k < 5; ++k)
+		{
+			if (bounds[k] != 0)
+			{
+				end = std::min(bounds[k], size);
+				break;
+			}
+		}
+		for (size_t b = start; b < end; ++b)
+		{
+			hexCache.byteLayers[b] = layers[i];
+		}
+	}
+}
+
+void PacketDetailPanel::RenderHexDump(const PacketRef& selected, size_t bytesPerLine)
+{
+	const PacketInfo& pkt = *selected;
+	if (hexCache.packet != selected || hexCache.bytesPerLine != bytesPerLine)
+	{
+		hexCache.packet = selected;
+		BuildHexDump(pkt, bytesPerLine);
+	}
+
+	const size_t size = pkt.data.size();
 
 	// Show up to the captured snippet
 	ImGui::Text("Hex / ASCII Dump (first %zu bytes):", size);
 
+	// Legend for the layer colours
+	const char* legend[] = { "Ethernet", "Network", "Transport", "Payload" };
+	for (int i = 0; i < 4; ++i)
+	{
+		ImGui::SameLine();
+		ImGui::TextColored(LayerColor(i + 1, 1.0f), "%s", legend[i]);
+	}
+
 	ImGui::BeginChild("HexDumpChild", ImVec2(0, 0), false, ImGuiWindowFlags_HorizontalScrollbar);
 
 	ImGui::PushStyleVar(ImGuiStyleVar_ItemSpacing, ImVec2(4, 2));
-	const int addrWidth = 8;
-
 	ImGui::PushFont(ImGui::GetFont());
-	for (size_t i = 0; i < size; i += bytesPerLine)
-	{
-		// Offset
-		char offsetBuf[64];
-		std::snprintf(offsetBuf, sizeof(offsetBuf), "%08zx: ", i);
-		ImGui::TextUnformatted(offsetBuf);
-		ImGui::SameLine();
 
-		// Hex bytes
-		std::ostringstream hex;
-		std::ostringstream ascii;
-		for (size_t j = 0; j < bytesPerLine; ++j)
+	// The default font is monospaced, so a column maps directly to a pixel offset
+	const float charWidth = ImGui::CalcTextSize("0").x;
+	const float lineHeight = ImGui::GetTextLineHeight();
+	ImDrawList* drawList = ImGui::GetWindowDrawList();
+
+	const int lineCount = static_cast<int>(hexCache.text.size() / hexCache.lineWidth);
+	ImGuiListClipper clipper;
+	clipper.Begin(lineCount);
+	while (clipper.Step())
+	{
+		for (int line = clipper.DisplayStart; line < clipper.DisplayEnd; ++line)
 		{
-			size_t idx = i + j;
-			if (idx < size)
-			{
-				uint8_t byte = buf[idx];
-				hex << std::hex << std::setw(2) << std::setfill('0') << (int)byte << " ";
-				ascii << (isprint(byte) ? (char)byte : '.');
-			}
-			else
+			const size_t offset = static_cast<size_t>(line) * bytesPerLine;
+			const size_t count = std::min(bytesPerLine, hexCache.byteLayers.size() - offset);
+			const ImVec2 origin = ImGui::GetCursorScreenPos();
+
+			// Highlight each byte with its layer colour, stronger for the hovered field
+			for (size_t j = 0; j < count; ++j)
 			{
-				hex << "   "; // Padding for missing bytes
-				ascii << " "; 
+				const size_t position = offset + j;
+				const Layer layer = hexCache.byteLayers[position];
+				const bool hovered = position >= hoveredOffset && position < hoveredOffset + hoveredLength;
+				if (layer == Layer::None && !hovered) continue;
+
+				const ImU32 color = (layer == Layer::None)
+					? ImGui::GetColorU32(ImVec4(0.8f, 0.8f, 0.8f, 0.4f))
+					: ImGui::GetColorU32(LayerColor(static_cast<int>(layer), hovered ? 0.55f : 0.18f));
+
+				const float hexX = origin.x + (offsetColumns + j * 3) * charWidth;
+				drawList->AddRectFilled(ImVec2(hexX, origin.y), ImVec2(hexX + 2 * charWidth, origin.y + lineHeight), color);
+
+				const float asciiX = origin.x + (offsetColumns + bytesPerLine * 3 + 1 + j) * charWidth;
+				drawList->AddRectFilled(ImVec2(asciiX, origin.y), ImVec2(asciiX + charWidth, origin.y + lineHeight), color);
 			}
-		}
 
-		ImGui::TextUnformatted(hex.str().c_str());
-		ImGui::SameLine();
-		ImGui::TextUnformatted(ascii.str().c_str());
+			const char* text = hexCache.text.data() + static_cast<size_t>(line) * hexCache.lineWidth;
+			ImGui::TextUnformatted(text, text + hexCache.lineWidth);
+		}
 	}
+	clipper.End();
 
 	ImGui::PopFont();
 	ImGui::PopStyleVar();
 
 	ImGui::EndChild();
-}
\ No newline at end of file
+}
@@ -1,6 +1,7 @@
 #pragma once
 #include <functional>
-#include <optional>
+#include <string>
+#include <vector>
 #include "core/PacketInfo.h"
 
 
@@ -8,13 +9,39 @@
 class PacketDetailPanel
 {
 public:
-	explicit PacketDetailPanel(std::function<std::optional<PacketInfo>()> selectedGetter);
+	explicit PacketDetailPanel(std::function<PacketRef()> selectedGetter);
 
 	void Render();
 
 private:
-	std::function<std::optional<PacketInfo>()> getSelectedPacket;
+	// Parsed layers, used to colour their bytes in the hex dump
+	enum class Layer
+	{
+		None,
+		Ethernet,
+		Network,
+		Transport,
+		Payload
+	};
+
+	// Hex/ASCII lines formatted once per selected packet
+	struct HexDumpCache
+	{
+		PacketRef packet; // Held so its address cannot be reused, dump file hits all have sequence 0
+		size_t bytesPerLine = 0;
+		size_t lineWidth = 0; // Every line has the same width, so line N starts at N * lineWidth
+		std::vector<char> text;
+		std::vector<Layer> byteLayers;
+	};
+
+	std::function<PacketRef()> getSelectedPacket;
+	HexDumpCache hexCache;
+	size_t hoveredOffset = 0; // Byte range of the hovered field
+	size_t hoveredLength = 0;
 
 	void RenderHeaderInfo(const PacketInfo& pkt);
-	void RenderHexDump(const PacketInfo& pkt, size_t bytesPerLine = 16);
-};
\ No newline at end of file
+	void RenderField(const PacketField& field);
+	void TrackHover(const PacketField& field);
+	void RenderHexDump(const PacketRef& selected, size_t bytesPerLine = 16);
+	void BuildHexDump(const PacketInfo& pkt, size_t bytesPerLine);
+};
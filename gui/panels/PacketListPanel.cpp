@@ -1,25 +1,80 @@
 #include "PacketListPanel.h"
+#include "core/PacketParser.h"
+#include <algorithm>
+#include <cstdio>
 #include <imgui.h>
+#include <string_view>
 
-PacketListPanel::PacketListPanel(std::shared_ptr<CaptureEngine> engine)
-	: captureEngine(std::move(engine))
+namespace
 {
+	// Info column, led by the names of the capture rules the packet matched
+	void RenderInfo(const PacketRow& pkt)
+	{
+		if (!pkt.rules.empty())
+		{
+			ImGui::TextColored(ImVec4(1.0f, 0.7f, 0.2f, 1.0f), "[%s]", pkt.rules.c_str());
+			ImGui::SameLine();
+		}
+		ImGui::TextUnformatted(pkt.info.c_str());
+	}
+}
+
+PacketListPanel::PacketListPanel(std::shared_ptr<CaptureEngine> engine, std::shared_ptr<PacketViewModel> model)
+	: captureEngine(std::move(engine)), viewModel(std::move(model))
+{
+	refreshRate = viewModel->GetRefreshRate();
 }
 
 void PacketListPanel::Render()
 {
+	// All data comes pre-built from the view model thread, the UI only draws it
+	snapshot = viewModel->GetSnapshot();
+
 	ImGui::SeparatorText("Captured Packets");
 
 	// Toggle between grouped and all packets view
 	ImGui::Checkbox("Group by Flow", &showGroupedView);
 	ImGui::SameLine();
+	static const char* sortNames[] = { "Address", "Packet Count", "RTT", "Retransmissions" };
+	ImGui::PushItemWidth(140.0f);
+	if (ImGui::Combo("Sort Flows", &flowSortIndex, sortNames, IM_ARRAYSIZE(sortNames)))
+	{
+		viewModel->SetFlowSort(static_cast<PacketViewModel::FlowSort>(flowSortIndex));
+	}
+	ImGui::PopItemWidth();
+	ImGui::SameLine();
 	if (ImGui::Button("Clear Selection"))
 	{
-		selectedFlowKey.clear();
-		selectedPacket.reset();
+		selectedFlowId = 0;
+		selectedPacketSeq.reset();
+		ClearSearchSelection();
 	}
 
-	if (showGroupedView)
+	ImGui::PushItemWidth(200.0f);
+	if (ImGui::InputText("Filter", filterText, IM_ARRAYSIZE(filterText)))
+	{
+		viewModel->SetFilter(filterText);
+	}
+	ImGui::SameLine();
+	ImGui::TextDisabled("(?)");
+	if (ImGui::IsItemHovered())
+	{
+		ImGui::SetTooltip("Substring match, also on the names of matched capture rules.\nStart with vlan:<id> to show a single VLAN.");
+	}
+	ImGui::SameLine();
+	if (ImGui::SliderInt("Refresh (Hz)", &refreshRate, 1, 60))
+	{
+		viewModel->SetRefreshRate(refreshRate);
+	}
+	ImGui::PopItemWidth();
+
+	RenderSearchControls();
+
+	if (showSearchResults)
+	{
+		RenderSearchResults();
+	}
+	else if (showGroupedView)
 	{
 		RenderGroupedView();
 	}
@@ -31,212 +86,236 @@ void PacketListPanel::Render()
 
 void PacketListPanel::RenderGroupedView()
 {
-	// Get grouped packets
-	auto incomingGroups = captureEngine->GetGroupedPackets(true);
-	auto outgoingGroups = captureEngine->GetGroupedPackets(false);
-
 	ImVec2 availableRegion = ImGui::GetContentRegionAvail();
 
 	// Incoming Flows - Top Half
-	ImGui::Text("Incoming Flows (%zu)", incomingGroups.size());
+	ImGui::Text("Incoming Flows (%zu)", snapshot->incomingFlows.size());
 	ImGui::Separator();
 
 	ImGui::BeginChild("IncomingFlows", ImVec2(0, availableRegion.y * 0.5f - 10), true);
-
-	if (ImGui::BeginTable("IncomingFlowsTable", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY))
-	{
-		ImGui::TableSetupScrollFreeze(0, 1);
-		ImGui::TableSetupColumn("Source Address", ImGuiTableColumnFlags_WidthStretch);
-		ImGui::TableSetupColumn("Source Port", ImGuiTableColumnFlags_WidthFixed, 80.0f);
-		ImGui::TableSetupColumn("Packet Count", ImGuiTableColumnFlags_WidthFixed, 100.0f);
-		ImGui::TableSetupColumn("Protocol", ImGuiTableColumnFlags_WidthFixed, 80.0f);
-		ImGui::TableHeadersRow();
-
-		int rowIndex = 0;
-		for (const auto& [key, packets] : incomingGroups)
-		{
-			const auto& [srcAddr, srcPort] = key;
-
-			ImGui::PushID(rowIndex);
-			ImGui::TableNextRow();
-			ImGui::TableSetColumnIndex(0);
-
-			// Create unique ID for this flow with IN: prefix
-			std::string flowKey = "IN:" + srcAddr + ":" + std::to_string(srcPort);
-
-			// Make row selectable
-			if (ImGui::Selectable(srcAddr.c_str(), selectedFlowKey == flowKey, ImGuiSelectableFlags_SpanAllColumns))
-			{
-				selectedFlowKey = flowKey;
-				selectedPacket.reset(); // Clear selected packet when changing flow
-			}
-
-			ImGui::TableSetColumnIndex(1);
-			ImGui::Text("%u", srcPort);
-
-			ImGui::TableSetColumnIndex(2);
-			ImGui::Text("%zu", packets.size());
-
-			ImGui::TableSetColumnIndex(3);
-			if (!packets.empty())
-			{
-				ImGui::TextUnformatted(packets[0].transportProtocol.c_str());
-			}
-
-			ImGui::PopID();
-			rowIndex++;
-		}
-
-		ImGui::EndTable();
-	}
+	RenderFlowTable("IncomingFlowsTable", "Source Address", "Source Port", snapshot->incomingFlows);
 	ImGui::EndChild();
 
 	// Outgoing Flows - Bottom Half
 	ImGui::Spacing();
-	ImGui::Text("Outgoing Flows (%zu)", outgoingGroups.size());
+	ImGui::Text("Outgoing Flows (%zu)", snapshot->outgoingFlows.size());
 	ImGui::Separator();
 
 	ImGui::BeginChild("OutgoingFlows", ImVec2(0, 0), true);
+	RenderFlowTable("OutgoingFlowsTable", "Destination", "Dest Port", snapshot->outgoingFlows);
+	ImGui::EndChild();
+}
 
-	if (ImGui::BeginTable("OutgoingFlowsTable", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY))
+void PacketListPanel::RenderFlowTable(const char* tableId, const char* addressLabel, const char* portLabel, const std::vector<FlowRow>& flows)
+{
+	if (ImGui::BeginTable(tableId, 13, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY))
 	{
 		ImGui::TableSetupScrollFreeze(0, 1);
-		ImGui::TableSetupColumn("Destination", ImGuiTableColumnFlags_WidthStretch);
-		ImGui::TableSetupColumn("Dest Port", ImGuiTableColumnFlags_WidthFixed, 80.0f);
+		ImGui::TableSetupColumn(addressLabel, ImGuiTableColumnFlags_WidthStretch);
+		ImGui::TableSetupColumn(portLabel, ImGuiTableColumnFlags_WidthFixed, 80.0f);
 		ImGui::TableSetupColumn("Packet Count", ImGuiTableColumnFlags_WidthFixed, 100.0f);
 		ImGui::TableSetupColumn("Protocol", ImGuiTableColumnFlags_WidthFixed, 80.0f);
+		ImGui::TableSetupColumn("VLAN", ImGuiTableColumnFlags_WidthFixed, 50.0f);
+		// TCP analysis totals over the flow's connections
+		ImGui::TableSetupColumn("Retrans", ImGuiTableColumnFlags_WidthFixed, 60.0f);
+		ImGui::TableSetupColumn("Dup ACK", ImGuiTableColumnFlags_WidthFixed, 60.0f);
+		ImGui::TableSetupColumn("Out of Order", ImGuiTableColumnFlags_WidthFixed, 80.0f);
+		ImGui::TableSetupColumn("Zero Win", ImGuiTableColumnFlags_WidthFixed, 60.0f);
+		ImGui::TableSetupColumn("RTT (ms)", ImGuiTableColumnFlags_WidthFixed, 70.0f);
+		ImGui::TableSetupColumn("Handshake (ms)", ImGuiTableColumnFlags_WidthFixed, 100.0f);
+		ImGui::TableSetupColumn("Server Name", ImGuiTableColumnFlags_WidthStretch);
+		ImGui::TableSetupColumn("TLS", ImGuiTableColumnFlags_WidthFixed, 100.0f);
 		ImGui::TableHeadersRow();
 
-		int rowIndex = 0;
-		for (const auto& [key, packets] : outgoingGroups)
+		// Only the visible rows are submitted
+		ImGuiListClipper clipper;
+		clipper.Begin(static_cast<int>(flows.size()));
+		while (clipper.Step())
 		{
-			const auto& [dstAddr, dstPort] = key;
+			for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i)
+			{
+				const FlowRow& flow = flows[i];
 
-			ImGui::PushID(rowIndex);
-			ImGui::TableNextRow();
-			ImGui::TableSetColumnIndex(0);
+				// Flow IDs are unique, so they double as ImGui IDs
+				ImGui::PushID(static_cast<int>(flow.id));
+				ImGui::TableNextRow();
+				ImGui::TableSetColumnIndex(0);
 
-			// Create unique ID for this flow with OUT: prefix
-			std::string flowKey = "OUT:" + dstAddr + ":" + std::to_string(dstPort);
+				// Make row selectable
+				if (ImGui::Selectable(flow.address.c_str(), selectedFlowId == flow.id, ImGuiSelectableFlags_SpanAllColumns))
+				{
+					selectedFlowId = flow.id;
+					selectedPacketSeq.reset(); // Clear selected packet when changing flow
+					ClearSearchSelection();
+				}
 
-			// Make row selectable
-			if (ImGui::Selectable(dstAddr.c_str(), selectedFlowKey == flowKey, ImGuiSelectableFlags_SpanAllColumns))
-			{
-				selectedFlowKey = flowKey;
-				selectedPacket.reset(); // Clear selected packet when changing flow
-			}
+				ImGui::TableSetColumnIndex(1);
+				ImGui::Text("%u", flow.port);
 
-			ImGui::TableSetColumnIndex(1);
-			ImGui::Text("%u", dstPort);
+				ImGui::TableSetColumnIndex(2);
+				ImGui::Text("%zu", flow.packetCount);
 
-			ImGui::TableSetColumnIndex(2);
-			ImGui::Text("%zu", packets.size());
+				ImGui::TableSetColumnIndex(3);
+				ImGui::TextUnformatted(flow.protocol.c_str());
 
-			ImGui::TableSetColumnIndex(3);
-			if (!packets.empty())
-			{
-				ImGui::TextUnformatted(packets[0].transportProtocol.c_str());
-			}
+				ImGui::TableSetColumnIndex(4);
+				if (flow.vlanId != 0)
+				{
+					ImGui::Text("%u", flow.vlanId);
+				}
 
-			ImGui::PopID();
-			rowIndex++;
+				if (flow.isTcp)
+				{
+					const TcpFlowStats& tcp = flow.tcp;
+					ImGui::TableSetColumnIndex(5);
+					ImGui::Text("%u", tcp.retransmissions);
+					ImGui::TableSetColumnIndex(6);
+					ImGui::Text("%u", tcp.duplicateAcks);
+					ImGui::TableSetColumnIndex(7);
+					ImGui::Text("%u", tcp.outOfOrder);
+					ImGui::TableSetColumnIndex(8);
+					ImGui::Text("%u", tcp.zeroWindows);
+					ImGui::TableSetColumnIndex(9);
+					if (tcp.rttSamples != 0)
+					{
+						ImGui::Text("%.2f", tcp.AverageRttMs());
+					}
+					ImGui::TableSetColumnIndex(10);
+					if (tcp.handshakes != 0)
+					{
+						ImGui::Text("%.2f", tcp.AverageHandshakeMs());
+					}
+					ImGui::TableSetColumnIndex(11);
+					ImGui::TextUnformatted(flow.serverName.c_str());
+					ImGui::TableSetColumnIndex(12);
+					ImGui::TextUnformatted(flow.tls.c_str());
+				}
+
+				ImGui::PopID();
+			}
 		}
 
 		ImGui::EndTable();
 	}
-	ImGui::EndChild();
 }
 
 void PacketListPanel::RenderDetailView()
 {
-	// Determine if incoming or outgoing flow
-	bool isIncoming = selectedFlowKey.substr(0, 3) == "IN:";
-	std::string displayKey = selectedFlowKey.substr(selectedFlowKey.find(':') + 1);
-
-	ImGui::SeparatorText((std::string(isIncoming ? "Incoming" : "Outgoing") + " Flow: " + displayKey).c_str());
-
-	auto groups = captureEngine->GetGroupedPackets(isIncoming);
-
-	// Find the selected flow
-	for (const auto& [key, packets] : groups)
+	const FlowRow* flow = snapshot ? snapshot->FindFlow(selectedFlowId) : nullptr;
+	if (!flow)
 	{
-		const auto& [addr, port] = key;
-		std::string flowKey = (isIncoming ? "IN:" : "OUT:") + addr + ":" + std::to_string(port);
-
-		if (flowKey != selectedFlowKey) continue;
-
-		ImVec2 availableRegion = ImGui::GetContentRegionAvail();
+		ImGui::SeparatorText("Flow Details");
+		ImGui::TextWrapped("The selected flow is no longer in the recent packets buffer or is hidden by the filter.");
+		return;
+	}
 
-		// Flow details table - takes available space
-		ImGui::BeginChild("FlowDetailsChild", ImVec2(0, 0), false);
+	ImGui::SeparatorText(flow->title.c_str());
 
-		if (ImGui::BeginTable("FlowDetailsTable", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY))
+	// Per-connection TCP totals, parallel connections to the same endpoint are listed apart
+	if (!flow->connections.empty() && ImGui::CollapsingHeader("TCP Connections"))
+	{
+		const float height = std::min(8, static_cast<int>(flow->connections.size()) + 1) * ImGui::GetFrameHeightWithSpacing();
+		if (ImGui::BeginTable("FlowConnectionsTable", 6, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY, ImVec2(0, height)))
 		{
-			ImGui::TableSetupScrollFreeze(0, 1); // Header row always visible
-			ImGui::TableSetupColumn("Time", ImGuiTableColumnFlags_WidthFixed, 100.0f);
-			ImGui::TableSetupColumn("Protocol", ImGuiTableColumnFlags_WidthFixed, 80.0f);
-			ImGui::TableSetupColumn("Source", ImGuiTableColumnFlags_WidthStretch);
-			ImGui::TableSetupColumn("Destination", ImGuiTableColumnFlags_WidthStretch);
-			ImGui::TableSetupColumn("Length", ImGuiTableColumnFlags_WidthFixed, 60.0f);
+			ImGui::TableSetupScrollFreeze(0, 1);
+			ImGui::TableSetupColumn("Local Endpoint", ImGuiTableColumnFlags_WidthStretch);
+			ImGui::TableSetupColumn("Retrans", ImGuiTableColumnFlags_WidthFixed, 60.0f);
+			ImGui::TableSetupColumn("Dup ACK", ImGuiTableColumnFlags_WidthFixed, 60.0f);
+			ImGui::TableSetupColumn("Out of Order", ImGuiTableColumnFlags_WidthFixed, 80.0f);
+			ImGui::TableSetupColumn("Zero Win", ImGuiTableColumnFlags_WidthFixed, 60.0f);
+			ImGui::TableSetupColumn("RTT (ms)", ImGuiTableColumnFlags_WidthFixed, 70.0f);
 			ImGui::TableHeadersRow();
 
-			int rowIndex = 0;
-			for (const auto& pkt : packets)
+			for (const TcpConnectionSummary& conn : flow->connections)
 			{
+				const TcpFlowStats& tcp = conn.stats;
 				ImGui::TableNextRow();
+				ImGui::TableSetColumnIndex(0);
+				ImGui::TextUnformatted(conn.localEndpoint.c_str());
+				ImGui::TableSetColumnIndex(1);
+				ImGui::Text("%u", tcp.retransmissions);
+				ImGui::TableSetColumnIndex(2);
+				ImGui::Text("%u", tcp.duplicateAcks);
+				ImGui::TableSetColumnIndex(3);
+				ImGui::Text("%u", tcp.outOfOrder);
+				ImGui::TableSetColumnIndex(4);
+				ImGui::Text("%u", tcp.zeroWindows);
+				ImGui::TableSetColumnIndex(5);
+				if (tcp.rttSamples != 0)
+				{
+					ImGui::Text("%.2f", tcp.AverageRttMs());
+				}
+			}
+			ImGui::EndTable();
+		}
+	}
 
-				ImGui::PushID(rowIndex);
+	// Flow details table - takes available space
+	ImGui::BeginChild("FlowDetailsChild", ImVec2(0, 0), false);
+
+	if (ImGui::BeginTable("FlowDetailsTable", 6, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY))
+	{
+		ImGui::TableSetupScrollFreeze(0, 1); // Header row always visible
+		ImGui::TableSetupColumn("Time", ImGuiTableColumnFlags_WidthFixed, 100.0f);
+		ImGui::TableSetupColumn("Protocol", ImGuiTableColumnFlags_WidthFixed, 80.0f);
+		ImGui::TableSetupColumn("Source", ImGuiTableColumnFlags_WidthStretch);
+		ImGui::TableSetupColumn("Destination", ImGuiTableColumnFlags_WidthStretch);
+		ImGui::TableSetupColumn("Length", ImGuiTableColumnFlags_WidthFixed, 60.0f);
+		ImGui::TableSetupColumn("Info", ImGuiTableColumnFlags_WidthStretch);
+		ImGui::TableHeadersRow();
 
-				// Format timestamp
-				auto timeT = std::chrono::system_clock::to_time_t(pkt.timestamp);
-				std::tm tm;
+		ImGuiListClipper clipper;
+		clipper.Begin(static_cast<int>(flow->packets.size()));
+		while (clipper.Step())
+		{
+			for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i)
+			{
+				const PacketRow& pkt = flow->packets[i];
+				ImGui::TableNextRow();
 
-#ifdef _WIN32
-				localtime_s(&tm, &timeT);
-#else
-				localtime_r(&timeT, &tm);
-#endif
-				char buf[16];
-				strftime(buf, sizeof(buf), "%H:%M:%S", &tm);
+				ImGui::PushID(i);
 
 				// Column 0: Time (selectable)
 				ImGui::TableSetColumnIndex(0);
-				bool clicked = ImGui::Selectable(buf, selectedPacket.has_value() && selectedPacket->timestamp == pkt.timestamp, ImGuiSelectableFlags_SpanAllColumns);
+				bool clicked = ImGui::Selectable(pkt.time.c_str(), selectedPacketSeq == pkt.sequence, ImGuiSelectableFlags_SpanAllColumns);
 				if (clicked)
 				{
-					selectedPacket = pkt;
+					selectedPacketSeq = pkt.sequence;
+					ClearSearchSelection();
 				}
 
 				// Column 1: Protocol
 				ImGui::TableSetColumnIndex(1);
-				ImGui::TextUnformatted(pkt.transportProtocol.c_str());
+				ImGui::TextUnformatted(pkt.protocol.c_str());
 
 				// Column 2: Source
 				ImGui::TableSetColumnIndex(2);
-				ImGui::Text("%s:%u", pkt.srcIP.c_str(), pkt.srcPort);
+				ImGui::TextUnformatted(pkt.source.c_str());
 
 				// Column 3: Destination
 				ImGui::TableSetColumnIndex(3);
-				ImGui::Text("%s:%u", pkt.dstIP.c_str(), pkt.dstPort);
+				ImGui::TextUnformatted(pkt.destination.c_str());
 
 				// Column 4: Length
 				ImGui::TableSetColumnIndex(4);
 				ImGui::Text("%u", pkt.length);
 
+				// Column 5: Info
+				ImGui::TableSetColumnIndex(5);
+				RenderInfo(pkt);
+
 				ImGui::PopID();
-				rowIndex++;
 			}
-
-			ImGui::EndTable();
 		}
-		ImGui::EndChild();
-		break;
+
+		ImGui::EndTable();
 	}
+	ImGui::EndChild();
 }
 
 void PacketListPanel::RenderAllPacketsView()
 {
-	const auto packets = captureEngine->GetRecentPackets();
+	const auto& packets = snapshot->recentPackets;
 
 	if (packets.empty())
 	{
@@ -244,7 +323,7 @@ void PacketListPanel::RenderAllPacketsView()
 		return;
 	}
 
-	if (ImGui::BeginTable("PacketsTable", 6, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY, ImVec2(0, 400)))
+	if (ImGui::BeginTable("PacketsTable", 7, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY, ImVec2(0, 400)))
 	{
 		ImGui::TableSetupScrollFreeze(0, 1); // Header row always visible
 		ImGui::TableSetupColumn("Time", ImGuiTableColumnFlags_WidthFixed, 100.0f);
@@ -253,49 +332,294 @@ void PacketListPanel::RenderAllPacketsView()
 		ImGui::TableSetupColumn("Source", ImGuiTableColumnFlags_WidthStretch);
 		ImGui::TableSetupColumn("Destination", ImGuiTableColumnFlags_WidthStretch);
 		ImGui::TableSetupColumn("Length", ImGuiTableColumnFlags_WidthFixed, 60.0f);
+		ImGui::TableSetupColumn("Info", ImGuiTableColumnFlags_WidthStretch);
 		ImGui::TableHeadersRow();
 
-		for (const auto& pkt : packets)
+		ImGuiListClipper clipper;
+		clipper.Begin(static_cast<int>(packets.size()));
+		while (clipper.Step())
 		{
-			ImGui::TableNextRow();
+			for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i)
+			{
+				const PacketRow& pkt = packets[i];
+				ImGui::TableNextRow();
 
-			// Format timestamp
-			auto timeT = std::chrono::system_clock::to_time_t(pkt.timestamp);
-			std::tm tm;
-#ifdef _WIN32
-			localtime_s(&tm, &timeT);
-#else
-			localtime_r(&timeT, &tm);
-#endif
-			std::ostringstream timeStr;
-			timeStr << std::put_time(&tm, "%H:%M:%S");
+				ImGui::TableSetColumnIndex(0);
+				ImGui::TextUnformatted(pkt.time.c_str());
 
-			ImGui::TableSetColumnIndex(0);
-			ImGui::TextUnformatted(timeStr.str().c_str());
+				ImGui::TableSetColumnIndex(1);
+				ImGui::TextColored(pkt.incoming ? ImVec4(0.2f, 0.8f, 0.2f, 1.0f) : ImVec4(0.8f, 0.2f, 0.2f, 1.0f),
+										pkt.incoming ? "IN" : "OUT");
 
-			ImGui::TableSetColumnIndex(1);
-			ImGui::TextColored(pkt.incoming ? ImVec4(0.2f, 0.8f, 0.2f, 1.0f) : ImVec4(0.8f, 0.2f, 0.2f, 1.0f),
-									pkt.incoming ? "IN" : "OUT");
+				ImGui::TableSetColumnIndex(2);
+				ImGui::TextUnformatted(pkt.protocol.c_str());
 
-			ImGui::TableSetColumnIndex(2);
-			ImGui::TextUnformatted(pkt.transportProtocol.c_str());
+				ImGui::TableSetColumnIndex(3);
+				ImGui::TextUnformatted(pkt.source.c_str());
 
-			ImGui::TableSetColumnIndex(3);
-			ImGui::Text("%s:%u", pkt.srcIP.c_str(), pkt.srcPort);
+				ImGui::TableSetColumnIndex(4);
+				ImGui::TextUnformatted(pkt.destination.c_str());
+
+				ImGui::TableSetColumnIndex(5);
+				ImGui::Text("%u", pkt.length);
+
+				ImGui::TableSetColumnIndex(6);
+				RenderInfo(pkt);
+			}
+		}
+
+		ImGui::EndTable();
+	}
+}
+
+// Returns the currently selected packet with its field tree, or nullptr if none is selected or it left the history
+PacketRef PacketListPanel::GetSelectedPacket() const
+{
+	if (selectedSearchPacket)
+	{
+		return selectedSearchPacket;
+	}
+	if (!selectedPacketSeq.has_value())
+	{
+		return nullptr;
+	}
+	return captureEngine->GetDissectedPacket(*selectedPacketSeq);
+}
+
+void PacketListPanel::RenderSearchControls()
+{
+	// Read the state before the hits, so a finished search has handed over all of them
+	const bool running = payloadSearch->IsRunning();
+	std::vector<SearchHit> newHits;
+	payloadSearch->GetHits(searchRows.size(), newHits);
+	for (SearchHit& hit : newHits)
+	{
+		PacketRow row = PacketViewModel::MakePacketRow(*hit.packet);
+		if (!hit.packet->ruleMatches.empty())
+		{
+			row.rules = captureEngine->GetRuleEngine().FormatRuleNames(hit.packet->ruleMatches);
+		}
+		searchRows.push_back({ std::move(hit), std::move(row) });
+	}
+	if (!running && !searchSorted)
+	{
+		std::stable_sort(searchRows.begin(), searchRows.end(), [](const SearchRow& a, const SearchRow& b)
+		{
+			return a.hit.packet->timestamp < b.hit.packet->timestamp;
+		});
+		searchSorted = true;
+	}
+
+	if (!ImGui::CollapsingHeader("Payload Search"))
+	{
+		return;
+	}
+
+	const float lineHeight = ImGui::GetTextLineHeight();
+	ImGui::InputTextMultiline("##SearchPatterns", searchPatterns, IM_ARRAYSIZE(searchPatterns), ImVec2(-30.0f, lineHeight * 4));
+	ImGui::SameLine();
+	ImGui::TextDisabled("(?)");
+	if (ImGui::IsItemHovered())
+	{
+		ImGui::SetTooltip("One pattern per line, all of them are searched for in a single pass.\n"
+			"Text matches as typed, hex:de ad be ef matches raw bytes.");
+	}
+
+	ImGui::Checkbox("Ignore Case", &searchIgnoreCase);
+	ImGui::SameLine();
+	ImGui::TextDisabled("(?)");
+	if (ImGui::IsItemHovered())
+	{
+		ImGui::SetTooltip("Text patterns only, hex patterns always match exactly.");
+	}
+	ImGui::SameLine();
+	ImGui::Checkbox("Payload Only", &searchPayloadOnly);
+	ImGui::SameLine();
+	ImGui::TextDisabled("(?)");
+	if (ImGui::IsItemHovered())
+	{
+		ImGui::SetTooltip("Skip the headers and search from the transport payload on.\nPackets without one are left out.");
+	}
+
+	ImGui::RadioButton("Capture History", &searchSource, 0);
+	ImGui::SameLine();
+	ImGui::RadioButton("Dump File", &searchSource, 1);
+	if (searchSource == 1)
+	{
+		ImGui::SameLine();
+		ImGui::PushItemWidth(200.0f);
+		ImGui::InputText("##SearchFile", searchFile, IM_ARRAYSIZE(searchFile));
+		ImGui::PopItemWidth();
+	}
+
+	if (running)
+	{
+		if (ImGui::Button("Cancel Search"))
+		{
+			payloadSearch->Cancel();
+		}
+	}
+	else if (ImGui::Button("Search"))
+	{
+		StartSearch();
+	}
+	if (!searchPatternNames.empty())
+	{
+		ImGui::SameLine();
+		ImGui::Checkbox("Show Results", &showSearchResults);
+	}
+
+	if (!searchError.empty())
+	{
+		ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%s", searchError.c_str());
+	}
+	else if (!searchPatternNames.empty())
+	{
+		const size_t scanned = payloadSearch->GetScannedPackets();
+		const size_t total = payloadSearch->GetTotalPackets();
+		char overlay[128];
+		std::snprintf(overlay, sizeof(overlay), "%zu / %zu packets, %.1f MB, %zu matches%s", scanned, total,
+			payloadSearch->GetScannedBytes() / 1e6, searchRows.size(), payloadSearch->IsTruncated() ? " (limit reached)" : "");
+		ImGui::ProgressBar(total != 0 ? static_cast<float>(scanned) / static_cast<float>(total) : (running ? 0.0f : 1.0f), ImVec2(-1.0f, 0.0f), overlay);
+	}
+}
 
-			ImGui::TableSetColumnIndex(4);
-			ImGui::Text("%s:%u", pkt.dstIP.c_str(), pkt.dstPort);
+void PacketListPanel::StartSearch()
+{
+	searchError.clear();
+
+	// One pattern per line, blank lines are skipped
+	PatternMatcher matcher;
+	std::vector<std::string> names;
+	std::string_view text(searchPatterns);
+	size_t lineNumber = 0;
+	while (!text.empty())
+	{
+		const size_t end = std::min(text.find('\n'), text.size());
+		std::string_view line = text.substr(0, end);
+		text.remove_prefix(std::min(end + 1, text.size()));
+		++lineNumber;
+		if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+		if (line.empty()) continue;
+
+		std::vector<uint8_t> bytes;
+		std::string error;
+		if (!PatternMatcher::ParsePattern(line, bytes, error))
+		{
+			searchError = "Line " + std::to_string(lineNumber) + ": " + error;
+			return;
+		}
+		matcher.Add(std::move(bytes), searchIgnoreCase && !PatternMatcher::IsHexPattern(line));
+		names.emplace_back(line);
+	}
+	if (names.empty())
+	{
+		searchError = "Enter at least one pattern";
+		return;
+	}
+	matcher.Compile();
 
-			ImGui::TableSetColumnIndex(5);
-			ImGui::Text("%u", pkt.length);
+	PayloadSearchOptions options;
+	options.payloadOnly = searchPayloadOnly;
+	if (searchSource == 0)
+	{
+		payloadSearch->Start(std::move(matcher), captureEngine->GetAllCapturedPackets(), options);
+	}
+	else if (!payloadSearch->StartFile(std::move(matcher), searchFile, captureEngine->GetLocalNetworks(), options, searchError))
+	{
+		return;
+	}
+
+	searchPatternNames = std::move(names);
+	searchRows.clear();
+	searchSorted = false;
+	showSearchResults = true;
+	ClearSearchSelection();
+}
+
+void PacketListPanel::RenderSearchResults()
+{
+	if (searchRows.empty())
+	{
+		ImGui::TextUnformatted(payloadSearch->IsRunning() ? "Searching..." : "No matches.");
+		return;
+	}
+
+	if (ImGui::BeginTable("SearchResultsTable", 8, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY))
+	{
+		ImGui::TableSetupScrollFreeze(0, 1);
+		ImGui::TableSetupColumn("Time", ImGuiTableColumnFlags_WidthFixed, 100.0f);
+		ImGui::TableSetupColumn("Protocol", ImGuiTableColumnFlags_WidthFixed, 80.0f);
+		ImGui::TableSetupColumn("Source", ImGuiTableColumnFlags_WidthStretch);
+		ImGui::TableSetupColumn("Destination", ImGuiTableColumnFlags_WidthStretch);
+		ImGui::TableSetupColumn("Length", ImGuiTableColumnFlags_WidthFixed, 60.0f);
+		ImGui::TableSetupColumn("Pattern", ImGuiTableColumnFlags_WidthFixed, 120.0f);
+		ImGui::TableSetupColumn("Offset", ImGuiTableColumnFlags_WidthFixed, 60.0f);
+		ImGui::TableSetupColumn("Info", ImGuiTableColumnFlags_WidthStretch);
+		ImGui::TableHeadersRow();
+
+		ImGuiListClipper clipper;
+		clipper.Begin(static_cast<int>(searchRows.size()));
+		while (clipper.Step())
+		{
+			for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i)
+			{
+				const SearchRow& result = searchRows[i];
+				const PacketRow& pkt = result.row;
+				ImGui::TableNextRow();
+				ImGui::PushID(i);
+
+				ImGui::TableSetColumnIndex(0);
+				if (ImGui::Selectable(pkt.time.c_str(), selectedSearchHit == result.hit.packet.get(), ImGuiSelectableFlags_SpanAllColumns))
+				{
+					// Packets still in the history share its dissection, the rest are dissected here
+					const PacketInfo& packet = *result.hit.packet;
+					PacketRef dissected = packet.sequence != 0 ? captureEngine->GetDissectedPacket(packet.sequence) : nullptr;
+					if (!dissected)
+					{
+						auto copy = std::make_shared<PacketInfo>(packet);
+						ParserOptions options;
+						options.decodeTunnels = captureEngine->GetDecodeTunnels();
+						PacketParser::DissectFields(*copy, options);
+						dissected = std::move(copy);
+					}
+					selectedFlowId = 0;
+					selectedPacketSeq.reset();
+					selectedSearchHit = &packet;
+					selectedSearchPacket = std::move(dissected);
+				}
+
+				ImGui::TableSetColumnIndex(1);
+				ImGui::TextUnformatted(pkt.protocol.c_str());
+
+				ImGui::TableSetColumnIndex(2);
+				ImGui::TextUnformatted(pkt.source.c_str());
+
+				ImGui::TableSetColumnIndex(3);
+				ImGui::TextUnformatted(pkt.destination.c_str());
+
+				ImGui::TableSetColumnIndex(4);
+				ImGui::Text("%u", pkt.length);
+
+				ImGui::TableSetColumnIndex(5);
+				ImGui::TextUnformatted(searchPatternNames[result.hit.pattern].c_str());
+
+				ImGui::TableSetColumnIndex(6);
+				ImGui::Text("%zu", result.hit.offset);
+
+				ImGui::TableSetColumnIndex(7);
+				RenderInfo(pkt);
+
+				ImGui::PopID();
+			}
 		}
 
 		ImGui::EndTable();
 	}
 }
 
-// Returns the currently selected packet, if any
-std::optional<PacketInfo> PacketListPanel::GetSelectedPacket() const
+void PacketListPanel::ClearSearchSelection()
 {
-	return selectedPacket;
-}
\ No newline at end of file
+	selectedSearchHit = nullptr;
+	selectedSearchPacket.reset();
+}
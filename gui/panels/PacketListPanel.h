@@ -1,23 +1,58 @@
 #pragma once
 #include <memory>
 #include "core/CaptureEngine.h"
+#include "core/PayloadSearch.h"
+#include "gui/PacketViewModel.h"
 #include <optional>
+#include <string>
+#include <vector>
 
 class PacketListPanel
 {
 public:
-	explicit PacketListPanel(std::shared_ptr<CaptureEngine> engine);
+	PacketListPanel(std::shared_ptr<CaptureEngine> engine, std::shared_ptr<PacketViewModel> model);
 	void Render();
 	void RenderDetailView();
-	std::optional<PacketInfo> GetSelectedPacket() const;
+	PacketRef GetSelectedPacket() const;
+	bool HasSelectedFlow() const { return selectedFlowId != 0; }
+	bool HasSelectedSearchResult() const { return selectedSearchPacket != nullptr; }
 
-
-	std::string selectedFlowKey;
 private:
 	bool showGroupedView = true;
+	int flowSortIndex = 0; // PacketViewModel::FlowSort
+	int refreshRate = 10;
+	char filterText[128] = "";
 	std::shared_ptr<CaptureEngine> captureEngine;
-	std::optional<PacketInfo> selectedPacket;
+	std::shared_ptr<PacketViewModel> viewModel;
+	std::shared_ptr<const PacketViewSnapshot> snapshot; // Latest snapshot, taken once per frame
+	uint64_t selectedFlowId = 0; // 0 = no flow selected
+	std::optional<uint64_t> selectedPacketSeq; // Sequence number into the capture history
+
+	// Payload search, its results replace the packet list while they are shown
+	struct SearchRow
+	{
+		SearchHit hit;
+		PacketRow row;
+	};
+	std::unique_ptr<PayloadSearch> payloadSearch = std::make_unique<PayloadSearch>();
+	char searchPatterns[1024] = "";
+	char searchFile[256] = "capture_dump.pcap";
+	int searchSource = 0; // 0 = capture history, 1 = dump file
+	bool searchIgnoreCase = true;
+	bool searchPayloadOnly = false;
+	bool showSearchResults = false;
+	bool searchSorted = true; // Rows arrive by segment and are put in time order once the search ends
+	std::string searchError;
+	std::vector<std::string> searchPatternNames; // Pattern text by index
+	std::vector<SearchRow> searchRows; // Formatted as the hits arrive
+	const PacketInfo* selectedSearchHit = nullptr;
+	PacketRef selectedSearchPacket; // Dissected copy of the selected hit
 
 	void RenderGroupedView();
+	void RenderFlowTable(const char* tableId, const char* addressLabel, const char* portLabel, const std::vector<FlowRow>& flows);
 	void RenderAllPacketsView();
-};
\ No newline at end of file
+	void RenderSearchControls();
+	void RenderSearchResults();
+	void StartSearch();
+	void ClearSearchSelection();
+};
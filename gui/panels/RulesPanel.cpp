@@ -0,0 +1,192 @@
+#include "RulesPanel.h"
+#include <imgui.h>
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace
+{
+	constexpr double refreshIntervalSeconds = 0.5;
+	constexpr const char* rulesPath = "capture_rules.txt"; // In the working directory, like the default dump file
+}
+
+RulesPanel::RulesPanel(std::shared_ptr<CaptureEngine> engine)
+	: captureEngine(std::move(engine))
+{
+	LoadRules();
+}
+
+// Puts the saved rules in the editor and applies them, a file that no longer parses is left for fixing
+void RulesPanel::LoadRules()
+{
+	if (!std::filesystem::exists(rulesPath))
+	{
+		status = "No saved rules";
+		statusIsError = false;
+		return;
+	}
+
+	std::ifstream file(rulesPath);
+	std::ostringstream text;
+	text << file.rdbuf();
+	std::snprintf(rulesText, sizeof(rulesText), "%s", text.str().c_str());
+
+	std::string error;
+	if (captureEngine->GetRuleEngine().SetRules(rulesText, error))
+	{
+		status = "Loaded " + std::string(rulesPath);
+		statusIsError = false;
+	}
+	else
+	{
+		status = error;
+		statusIsError = true;
+	}
+	lastRefresh = -1.0;
+}
+
+void RulesPanel::ApplyRules()
+{
+	std::string error;
+	if (!captureEngine->GetRuleEngine().SetRules(rulesText, error))
+	{
+		status = error;
+		statusIsError = true;
+		return;
+	}
+
+	std::ofstream file(rulesPath, std::ios::trunc);
+	file << rulesText;
+	status = file ? "Applied and saved to " + std::string(rulesPath) : "Applied, but " + std::string(rulesPath) + " could not be written";
+	statusIsError = !file;
+	lastRefresh = -1.0;
+}
+
+void RulesPanel::Render()
+{
+	RuleEngine& rules = captureEngine->GetRuleEngine();
+	if (ImGui::GetTime() - lastRefresh >= refreshIntervalSeconds || lastRefresh < 0.0)
+	{
+		stats = rules.GetStats();
+		lastRefresh = ImGui::GetTime();
+	}
+
+	uint64_t matches = 0;
+	for (const RuleStats& rule : stats)
+	{
+		matches += rule.matches;
+	}
+
+	char header[96];
+	std::snprintf(header, sizeof(header), "Capture Rules (%zu rules, %llu matches)###CaptureRules", stats.size(), static_cast<unsigned long long>(matches));
+	if (!ImGui::CollapsingHeader(header))
+	{
+		return;
+	}
+
+	RenderEditor();
+	RenderStats();
+}
+
+void RulesPanel::RenderEditor()
+{
+	const float lineHeight = ImGui::GetTextLineHeight();
+	ImGui::InputTextMultiline("##RulesText", rulesText, IM_ARRAYSIZE(rulesText), ImVec2(-30.0f, lineHeight * 6), ImGuiInputTextFlags_AllowTabInput);
+	ImGui::SameLine();
+	ImGui::TextDisabled("(?)");
+	if (ImGui::IsItemHovered())
+	{
+		ImGui::SetTooltip("One rule per line as name: conditions, joined with 'and'. Lines starting with # are comments.\n"
+			"  tcp, udp, icmp, arp, ip, ip6\n"
+			"  [src|dst] host 10.0.0.1, [src|dst] net 10.0.0.0/8\n"
+			"  [src|dst] port 22, [src|dst] portrange 6000-6100\n"
+			"  vlan 100, tcpflags SA (all of F S R P A U E C set)\n"
+			"  content \"GET /admin\" [nocase], content hex:\"de ad be ef\"\n"
+			"Any condition but content can be negated with 'not'. All contents of a rule must be in the payload.\n"
+			"Example: admin-login: tcp and dst port 80 and not src net 10.0.0.0/8 and content \"POST /admin\" nocase");
+	}
+
+	if (ImGui::Button("Apply"))
+	{
+		ApplyRules();
+	}
+	ImGui::SameLine();
+	if (ImGui::Button("Revert"))
+	{
+		LoadRules();
+	}
+	ImGui::SameLine();
+	if (ImGui::Button("Reset Counts"))
+	{
+		captureEngine->GetRuleEngine().ResetCounts();
+		lastRefresh = -1.0;
+	}
+	ImGui::SameLine();
+	ImGui::Text("%llu packets checked", static_cast<unsigned long long>(captureEngine->GetRuleEngine().GetEvaluatedPackets()));
+
+	if (!status.empty())
+	{
+		if (statusIsError)
+		{
+			ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%s", status.c_str());
+		}
+		else
+		{
+			ImGui::TextDisabled("%s", status.c_str());
+		}
+	}
+}
+
+void RulesPanel::RenderStats()
+{
+	if (stats.empty())
+	{
+		return;
+	}
+
+	if (!ImGui::BeginTable("CaptureRulesTable", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY, ImVec2(0, 160.0f)))
+	{
+		return;
+	}
+
+	ImGui::TableSetupScrollFreeze(0, 1);
+	ImGui::TableSetupColumn("Rule", ImGuiTableColumnFlags_WidthFixed, 140.0f);
+	ImGui::TableSetupColumn("Matches", ImGuiTableColumnFlags_WidthFixed, 80.0f);
+	ImGui::TableSetupColumn("Last Match", ImGuiTableColumnFlags_WidthFixed, 80.0f);
+	ImGui::TableSetupColumn("Conditions", ImGuiTableColumnFlags_WidthStretch);
+	ImGui::TableHeadersRow();
+
+	ImGuiListClipper clipper;
+	clipper.Begin(static_cast<int>(stats.size()));
+	while (clipper.Step())
+	{
+		for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i)
+		{
+			const RuleStats& rule = stats[i];
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn();
+			ImGui::TextUnformatted(rule.name.c_str());
+			ImGui::TableNextColumn();
+			ImGui::Text("%llu", static_cast<unsigned long long>(rule.matches));
+			ImGui::TableNextColumn();
+			if (rule.lastMatchUs != 0)
+			{
+				const std::time_t seconds = static_cast<std::time_t>(rule.lastMatchUs / 1000000);
+				std::tm tmBuf{};
+#ifdef _WIN32
+				localtime_s(&tmBuf, &seconds);
+#else
+				localtime_r(&seconds, &tmBuf);
+#endif
+				char time[16];
+				std::strftime(time, sizeof(time), "%H:%M:%S", &tmBuf);
+				ImGui::TextUnformatted(time);
+			}
+			ImGui::TableNextColumn();
+			ImGui::TextUnformatted(rule.expression.c_str());
+		}
+	}
+	ImGui::EndTable();
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+#include "core/CaptureEngine.h"
+
+class RulesPanel
+{
+public:
+	explicit RulesPanel(std::shared_ptr<CaptureEngine> engine);
+
+	void Render();
+
+private:
+	std::shared_ptr<CaptureEngine> captureEngine;
+
+	char rulesText[65536] = ""; // Editor contents, applied and saved on request
+	std::string status;
+	bool statusIsError = false;
+
+	// Copied from the engine a few times a second rather than every frame
+	std::vector<RuleStats> stats;
+	double lastRefresh = -1.0;
+
+	void LoadRules();
+	void ApplyRules();
+	void RenderEditor();
+	void RenderStats();
+};
@@ -0,0 +1,111 @@
+#include "TopTalkersPanel.h"
+#include <imgui.h>
+#include <chrono>
+#include <cstdio>
+
+namespace
+{
+	constexpr double refreshIntervalSeconds = 0.5;
+
+	void FormatBytes(char* buf, size_t size, uint64_t bytes)
+	{
+		if (bytes >= 1000000000ull) std::snprintf(buf, size, "%.2f GB", bytes / 1e9);
+		else if (bytes >= 1000000ull) std::snprintf(buf, size, "%.2f MB", bytes / 1e6);
+		else if (bytes >= 1000ull) std::snprintf(buf, size, "%.1f kB", bytes / 1e3);
+		else std::snprintf(buf, size, "%llu B", static_cast<unsigned long long>(bytes));
+	}
+}
+
+TopTalkersPanel::TopTalkersPanel(std::shared_ptr<CaptureEngine> engine)
+	: captureEngine(std::move(engine))
+{
+}
+
+void TopTalkersPanel::Render()
+{
+	if (!ImGui::CollapsingHeader("Top Talkers"))
+	{
+		return;
+	}
+
+	bool changed = false;
+	static const char* keyNames[] = { "Source address", "Destination port", "Flow" };
+	ImGui::PushItemWidth(160.0f);
+	if (ImGui::Combo("By##TopTalkers", &keyClass, keyNames, IM_ARRAYSIZE(keyNames))) changed = true;
+	ImGui::SameLine();
+	if (ImGui::RadioButton("Last 10 s", &window, 0)) changed = true;
+	ImGui::SameLine();
+	if (ImGui::RadioButton("Last minute", &window, 1)) changed = true;
+	ImGui::SameLine();
+	if (ImGui::SliderInt("Rows##TopTalkers", &rowLimit, 5, static_cast<int>(HeavyHitters::capacity))) changed = true;
+	ImGui::PopItemWidth();
+	ImGui::SameLine();
+	if (ImGui::Button("Reset##TopTalkers"))
+	{
+		captureEngine->GetHeavyHitters().Clear();
+		changed = true;
+	}
+	ImGui::SameLine();
+	ImGui::TextDisabled("(?)");
+	if (ImGui::IsItemHovered())
+	{
+		ImGui::SetTooltip("Heaviest keys by bytes, counted in constant memory with Space-Saving summaries backed by\n"
+			"Count-Min sketches, one per 5 second pane. Byte counts are estimates that never fall short of the\n"
+			"true value, the error column bounds how far over they may be. Packets are counted only while a key is tracked.");
+	}
+
+	if (changed || lastRefresh < 0.0 || ImGui::GetTime() - lastRefresh >= refreshIntervalSeconds)
+	{
+		Refresh();
+	}
+
+	char total[32];
+	FormatBytes(total, sizeof(total), windowBytes);
+	ImGui::Text("%s in window", total);
+
+	if (ImGui::BeginTable("TopTalkers", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY, ImVec2(0, 220.0f)))
+	{
+		ImGui::TableSetupScrollFreeze(0, 1);
+		ImGui::TableSetupColumn(keyNames[keyClass], ImGuiTableColumnFlags_WidthStretch);
+		ImGui::TableSetupColumn("Bytes", ImGuiTableColumnFlags_WidthFixed, 80.0f);
+		ImGui::TableSetupColumn("Share", ImGuiTableColumnFlags_WidthFixed, 60.0f);
+		ImGui::TableSetupColumn("Error", ImGuiTableColumnFlags_WidthFixed, 80.0f);
+		ImGui::TableSetupColumn("Packets", ImGuiTableColumnFlags_WidthFixed, 70.0f);
+		ImGui::TableHeadersRow();
+
+		const auto keyClassValue = static_cast<HeavyHitters::KeyClass>(keyClass);
+		for (const HeavyHitter& talker : talkers)
+		{
+			char buf[32];
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn();
+			ImGui::TextUnformatted(HeavyHitters::FormatKey(keyClassValue, talker.key).c_str());
+			ImGui::TableNextColumn();
+			FormatBytes(buf, sizeof(buf), talker.bytes);
+			ImGui::TextUnformatted(buf);
+			ImGui::TableNextColumn();
+			ImGui::Text("%.1f%%", windowBytes != 0 ? 100.0 * static_cast<double>(talker.bytes) / static_cast<double>(windowBytes) : 0.0);
+			ImGui::TableNextColumn();
+			if (talker.error != 0)
+			{
+				FormatBytes(buf, sizeof(buf), talker.error);
+				ImGui::Text("< %s", buf);
+			}
+			ImGui::TableNextColumn();
+			ImGui::Text("%llu", static_cast<unsigned long long>(talker.packets));
+		}
+		ImGui::EndTable();
+	}
+}
+
+void TopTalkersPanel::Refresh()
+{
+	const int64_t now = std::chrono::duration_cast<std::chrono::seconds>(
+		std::chrono::system_clock::now().time_since_epoch()).count();
+	const HeavyHitters& heavyHitters = captureEngine->GetHeavyHitters();
+	const auto windowValue = static_cast<HeavyHitters::Window>(window);
+
+	talkers = heavyHitters.GetTop(static_cast<HeavyHitters::KeyClass>(keyClass), windowValue, now, static_cast<size_t>(rowLimit));
+	windowBytes = heavyHitters.GetWindowBytes(windowValue, now);
+	lastRefresh = ImGui::GetTime();
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include "core/CaptureEngine.h"
+
+class TopTalkersPanel
+{
+public:
+	explicit TopTalkersPanel(std::shared_ptr<CaptureEngine> engine);
+
+	void Render();
+
+private:
+	std::shared_ptr<CaptureEngine> captureEngine;
+
+	// Merged from the sketches a few times a second rather than every frame
+	std::vector<HeavyHitter> talkers;
+	uint64_t windowBytes = 0;
+	double lastRefresh = -1.0;
+	int keyClass = 0; // HeavyHitters::KeyClass
+	int window = 1; // HeavyHitters::Window
+	int rowLimit = 20;
+
+	void Refresh();
+};
@@ -0,0 +1,117 @@
+#include "TrafficChartPanel.h"
+#include <imgui.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+TrafficChartPanel::TrafficChartPanel(std::shared_ptr<CaptureEngine> engine)
+	: captureEngine(std::move(engine))
+{
+}
+
+void TrafficChartPanel::Render()
+{
+	if (!ImGui::CollapsingHeader("Traffic Charts"))
+	{
+		return;
+	}
+
+	// Resolution selection, each one is a separate ring so switching costs nothing
+	ImGui::TextUnformatted("Resolution:");
+	ImGui::SameLine();
+	ImGui::RadioButton("1s (5 min)", &resolution, 0);
+	ImGui::SameLine();
+	ImGui::RadioButton("10s (1 hour)", &resolution, 1);
+	ImGui::SameLine();
+	ImGui::RadioButton("1m (24 hours)", &resolution, 2);
+
+	const int64_t now = std::chrono::duration_cast<std::chrono::seconds>(
+		std::chrono::system_clock::now().time_since_epoch()).count();
+
+	const float availableWidth = ImGui::GetContentRegionAvail().x;
+	const float columnWidth = availableWidth * 0.5f - ImGui::GetStyle().ItemSpacing.x;
+
+	// Totals on the left, protocol breakdown on the right
+	ImGui::BeginChild("TrafficTotals", ImVec2(columnWidth, 190.0f), true);
+	RenderSeries("Packets/s", TrafficStats::Metric::PacketsPerSecond, now, 70.0f);
+	RenderSeries("Bits/s", TrafficStats::Metric::BitsPerSecond, now, 70.0f);
+	ImGui::EndChild();
+
+	ImGui::SameLine();
+
+	ImGui::BeginChild("TrafficProtocols", ImVec2(0, 190.0f), true);
+	RenderSeries("TCP pkt/s", TrafficStats::Metric::TcpPacketsPerSecond, now, 30.0f);
+	RenderSeries("UDP pkt/s", TrafficStats::Metric::UdpPacketsPerSecond, now, 30.0f);
+	RenderSeries("ICMP pkt/s", TrafficStats::Metric::IcmpPacketsPerSecond, now, 30.0f);
+	RenderSeries("Other pkt/s", TrafficStats::Metric::OtherPacketsPerSecond, now, 30.0f);
+	ImGui::EndChild();
+
+	RenderDistinct(now);
+}
+
+void TrafficChartPanel::RenderDistinct(int64_t now)
+{
+	const DistinctCounters& counters = captureEngine->GetDistinctCounters();
+	if (lastDistinctRefresh < 0.0 || ImGui::GetTime() - lastDistinctRefresh >= 0.5)
+	{
+		for (size_t i = 0; i < DistinctCounters::keyClassCount; ++i)
+		{
+			const auto keyClass = static_cast<DistinctCounters::KeyClass>(i);
+			counters.GetSeries(keyClass, now, distinctSeries[i]);
+			distinctLastMinute[i] = counters.GetDistinct(keyClass, now, 60);
+		}
+		lastDistinctRefresh = ImGui::GetTime();
+	}
+
+	ImGui::TextUnformatted("Distinct per second (last minute)");
+	ImGui::SameLine();
+	ImGui::TextDisabled("(?)");
+	if (ImGui::IsItemHovered())
+	{
+		ImGui::SetTooltip("Estimated with one HyperLogLog sketch per second and key class, within about 3%%.\n"
+			"The figure in brackets merges the last minute of sketches, so keys seen in several seconds count once.\n"
+			"A jump in sources with flat flows per source points at a DDoS, a jump in address and port pairs at a scan.");
+	}
+
+	ImGui::BeginChild("DistinctCounts", ImVec2(0, 175.0f), true);
+	for (size_t i = 0; i < DistinctCounters::keyClassCount; ++i)
+	{
+		const std::vector<float>& values = distinctSeries[i];
+		const float peak = values.empty() ? 0.0f : *std::max_element(values.begin(), values.end());
+		const float latest = values.size() >= 2 ? values[values.size() - 2] : 0.0f; // Last complete second
+
+		char overlay[64];
+		std::snprintf(overlay, sizeof(overlay), "%.0f/s (peak %.0f, minute %.0f)", latest, peak, distinctLastMinute[i]);
+
+		const char* label = DistinctCounters::KeyClassName(static_cast<DistinctCounters::KeyClass>(i));
+		ImGui::PushID(label);
+		ImGui::PlotLines("##Distinct", values.data(), static_cast<int>(values.size()), 0, overlay, 0.0f, std::max(peak * 1.1f, 1.0f), ImVec2(-160.0f, 26.0f));
+		ImGui::SameLine();
+		ImGui::TextUnformatted(label);
+		ImGui::PopID();
+	}
+	ImGui::EndChild();
+}
+
+void TrafficChartPanel::RenderSeries(const char* label, TrafficStats::Metric metric, int64_t now, float height)
+{
+	const TrafficStats& stats = captureEngine->GetTrafficStats();
+	stats.GetSeries(static_cast<TrafficStats::Resolution>(resolution), metric, now, series);
+
+	const float peak = series.empty() ? 0.0f : *std::max_element(series.begin(), series.end());
+	const float latest = series.size() >= 2 ? series[series.size() - 2] : 0.0f; // Last complete bucket
+
+	char overlay[64];
+	if (metric == TrafficStats::Metric::BitsPerSecond)
+	{
+		std::snprintf(overlay, sizeof(overlay), "%.2f Mbit/s (peak %.2f)", latest / 1e6f, peak / 1e6f);
+	}
+	else
+	{
+		std::snprintf(overlay, sizeof(overlay), "%.1f (peak %.1f)", latest, peak);
+	}
+
+	ImGui::PushID(label);
+	ImGui::PlotLines(label, series.data(), static_cast<int>(series.size()), 0, overlay, 0.0f, std::max(peak * 1.1f, 1.0f), ImVec2(-80.0f, height));
+	ImGui::PopID();
+}
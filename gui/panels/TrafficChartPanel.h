@@ -0,0 +1,27 @@
+#pragma once
+#include <array>
+#include <memory>
+#include <vector>
+#include "core/CaptureEngine.h"
+
+
+class TrafficChartPanel
+{
+public:
+	explicit TrafficChartPanel(std::shared_ptr<CaptureEngine> engine);
+
+	void Render();
+
+private:
+	std::shared_ptr<CaptureEngine> captureEngine;
+	int resolution = 0; // Index into TrafficStats::Resolution
+	std::vector<float> series; // Reused between frames to avoid reallocating
+
+	// Distinct counts merge sketches, so they are refreshed a few times a second rather than every frame
+	std::array<std::vector<float>, DistinctCounters::keyClassCount> distinctSeries;
+	std::array<double, DistinctCounters::keyClassCount> distinctLastMinute{};
+	double lastDistinctRefresh = -1.0;
+
+	void RenderSeries(const char* label, TrafficStats::Metric metric, int64_t now, float height);
+	void RenderDistinct(int64_t now);
+};